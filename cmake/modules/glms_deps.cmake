@@ -59,7 +59,9 @@ function (glms_deps TARGET_NAME)
 
 
 
-  set(GLMS_DEPS m gimg_static memo_static arena_static hashy_static text_static mif_static spath_static fjson_static cglm curl dl)
+  find_package(Threads REQUIRED)
+
+  set(GLMS_DEPS m Threads::Threads gimg_static memo_static arena_static hashy_static text_static mif_static spath_static fjson_static cglm curl dl)
 
   target_link_libraries(${TARGET_NAME} ${GLMS_DEPS})
 endfunction()
@@ -10,11 +10,13 @@
 #include <glms/iterator.h>
 #include <glms/list.h>
 #include <glms/macros.h>
+#include <glms/native.h>
 #include <glms/string_view.h>
 #include <glms/token.h>
 #include <glms/type.h>
 #include <hashy/hashy.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <mif/linear/vector2/all.h>
 #include <mif/linear/vector3/all.h>
 #include <mif/linear/vector4/all.h>
@@ -29,6 +31,8 @@ struct GLMS_BUFFER_GLMSAST;
 struct GLMS_GLMSAST_LIST_STRUCT;
 
 struct GLMS_AST_STRUCT;
+struct GLMS_SHAPE_STRUCT;
+struct GLMS_STRUCT_LAYOUT_STRUCT;
 
 #define JAST struct GLMS_AST_STRUCT
 
@@ -175,6 +179,14 @@ typedef struct GLMS_AST_STRUCT {
       JAST* ptr;
     } stackptr;
 
+    struct {
+      void* data;
+      int64_t length;
+      int64_t stride;
+      GLMSASTType element_type;
+      bool writable;
+    } typed_array;
+
     bool boolean;
 
     Vector2 v2;
@@ -187,11 +199,14 @@ typedef struct GLMS_AST_STRUCT {
   } as;
 
   GLMSASTType type;
-  HashyMap props;
+  struct GLMS_SHAPE_STRUCT* shape;
+  JAST** slots;
+  int64_t slots_capacity;
   struct GLMS_GLMSAST_LIST_STRUCT* children;
   struct GLMS_GLMSAST_LIST_STRUCT* flags;
   GLMSASTOperatorOverload op_overloads[GLMS_AST_OPERATOR_OVERLOAD_CAP];
   GLMSFPTR fptr;
+  GLMSNativeFunc native;
   JSON* json;
   void* ptr;
   char* string_rep;
@@ -205,6 +220,9 @@ typedef struct GLMS_AST_STRUCT {
   JAST* value_type;
   JAST* result;
   float* floats;
+  struct GLMS_SHAPE_STRUCT* cached_shape;
+  int64_t cached_slot;
+  struct GLMS_STRUCT_LAYOUT_STRUCT* struct_layout;
   ArenaRef ref;
   bool keep;
   bool is_tmp;
@@ -217,6 +235,12 @@ typedef struct GLMS_AST_STRUCT {
 GLMS_DEFINE_BUFFER(GLMSAST);
 GLMS_DEFINE_LIST(GLMSAST);
 
+typedef struct {
+  int64_t index;
+  const char* key;
+  GLMSAST* value;
+} GLMSASTPropIterator;
+
 GLMSAST* glms_ast_push(GLMSAST* parent, GLMSAST* child);
 GLMSAST* glms_ast_push_flag(GLMSAST* parent, GLMSAST* flag);
 
@@ -256,6 +280,14 @@ int glms_ast_get_type(GLMSAST ast, GLMSAST* out);
 
 GLMSAST* glms_ast_copy(GLMSAST src, struct GLMS_ENV_STRUCT* env);
 
+bool glms_ast_is_shared(GLMSAST* ast);
+
+// Drops the reference `ast` holds on its children, freeing the list
+// along with the last one.
+void glms_ast_release_children(GLMSAST* ast);
+
+int glms_ast_make_unique(GLMSAST* ast, struct GLMS_ENV_STRUCT* env);
+
 void glms_ast_destructor(GLMSAST* ast);
 
 bool glms_ast_is_vector(GLMSAST* ast);
@@ -264,6 +296,12 @@ void glms_ast_keep(GLMSAST* ast);
 
 GLMSAST* glms_ast_get_property(GLMSAST* ast, const char* key);
 
+bool glms_ast_has_props(GLMSAST* ast);
+
+int64_t glms_ast_count_props(GLMSAST* ast);
+
+bool glms_ast_iterate_props(GLMSAST* ast, GLMSASTPropIterator* it);
+
 GLMSAST* glms_ast_register_function(struct GLMS_ENV_STRUCT* env, GLMSAST* ast,
                                     const char* name, GLMSFPTR fptr);
 
@@ -303,7 +341,8 @@ GLMSAST* glms_ast_register_func_overload(struct GLMS_ENV_STRUCT* env,
                                          GLMSAST* ast, const char* name,
                                          GLMSFPTR func);
 
-GLMSFPTR glms_ast_get_func_overload(GLMSAST ast, const char* name);
+GLMSFPTR glms_ast_get_func_overload(GLMSAST ast, const char* name,
+                                    struct GLMS_ENV_STRUCT* env);
 
 float glms_ast_number(GLMSAST ast);
 
@@ -319,6 +358,13 @@ char* glms_ast_generate_docstring(GLMSAST ast, const char* name,
 
 int glms_ast_get_atoms(GLMSAST ast, GLMSASTBuffer* out);
 
+size_t glms_ast_type_get_size(GLMSASTType type);
+
+// reads or writes a plain value stored in host memory.
+int glms_ast_read_memory(GLMSASTType type, const void* mem, GLMSAST* out);
+
+int glms_ast_write_memory(GLMSASTType type, void* mem, GLMSAST value);
+
 GLMSAST* glms_ast_from_json(struct GLMS_ENV_STRUCT* env, JSON* v);
 
 #define GLMSAST_VALUE(ast) (ast->as.number.value)
@@ -20,6 +20,7 @@
   TOK(GLMS_AST_TYPE_NUMBER)                                                    \
   TOK(GLMS_AST_TYPE_BOOL)                                                      \
   TOK(GLMS_AST_TYPE_ARRAY)                                                     \
+  TOK(GLMS_AST_TYPE_TYPED_ARRAY)                                               \
   TOK(GLMS_AST_TYPE_VEC2)                                                      \
   TOK(GLMS_AST_TYPE_VEC3)                                                      \
   TOK(GLMS_AST_TYPE_VEC4)                                                      \
@@ -0,0 +1,99 @@
+#ifndef GLMS_ASYNC_H
+#define GLMS_ASYNC_H
+#include <glms/env.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Background threads servicing the futures of every env.
+#define GLMS_ASYNC_THREADS 4
+
+struct GLMS_FUTURE_STRUCT;
+
+// Runs on a background thread and must not touch any env,
+// only the fields of `future`. Returns 0 on failure.
+typedef int (*GLMSFutureWork)(struct GLMS_FUTURE_STRUCT *future);
+
+// Runs on the env's thread once the work is done, and makes the
+// value handed to `then` callbacks and `await`.
+typedef GLMSAST *(*GLMSFutureResolve)(GLMSEnv *env,
+                                      struct GLMS_FUTURE_STRUCT *future);
+
+typedef enum { GLMS_FUTURE_PENDING, GLMS_FUTURE_RESOLVED } GLMSFutureState;
+
+// Owned by the env that made it. A future is freed once it has settled
+// and nothing refers to it; one with a script value lives until
+// glms_env_clear, as the value may still be read.
+typedef struct GLMS_FUTURE_STRUCT {
+  GLMSEnv *env;
+  GLMSFutureWork work;
+  GLMSFutureResolve resolve;
+  // only read and written on the env's thread.
+  GLMSFutureState state;
+  // set under the env's lock once `work` has returned.
+  bool done;
+  bool running;
+  bool ok;
+
+  // input and output of `work`.
+  char *path;
+  char *data;
+  int64_t length;
+  // like the response code of a request.
+  int64_t status;
+  void *user_ptr;
+
+  // a future made by glms_future_all is done once all of its parts are.
+  struct GLMS_FUTURE_STRUCT **parts;
+  int64_t parts_length;
+
+  GLMSAST *value;
+  GLMSAST *callbacks;
+  int64_t callbacks_length;
+
+  // waits and glms_future_all futures that still read it.
+  int64_t refs;
+  // set by glms_future_new_ast.
+  bool held;
+
+  // the env's pending futures, then its settled futures that are held.
+  struct GLMS_FUTURE_STRUCT *next;
+  struct GLMS_FUTURE_STRUCT *prev;
+  // in the background queue, then in the env's list of done futures.
+  struct GLMS_FUTURE_STRUCT *next_queued;
+} GLMSFuture;
+
+// The future is only handed to a background thread by glms_future_start,
+// so its fields can be filled in first. Unless it is given a script value
+// or awaited, it is freed by the poll that settles it.
+GLMSFuture *glms_future_new(GLMSEnv *env, GLMSFutureWork work,
+                            GLMSFutureResolve resolve);
+
+void glms_future_start(GLMSFuture *future);
+
+// For futures without `work`, whose work is driven by something else
+// (like an event loop on its own thread): glms_future_begin marks the
+// future as running, and glms_future_finish hands it back to its env.
+void glms_future_begin(GLMSFuture *future);
+
+void glms_future_finish(GLMSFuture *future, bool ok);
+
+GLMSFuture *glms_future_all(GLMSEnv *env, GLMSFuture **parts, int64_t length);
+
+// `func` is called with the value once the future is resolved,
+// right away if it already is.
+int glms_future_then(GLMSFuture *future, GLMSAST func);
+
+// Blocks until the future is done, then resolves every finished
+// future of its env. Returns the future's value.
+GLMSAST *glms_future_await(GLMSFuture *future);
+
+// Resolves the futures of `env` that are done and runs their callbacks.
+// Returns how many futures are still waiting.
+int64_t glms_async_poll(GLMSEnv *env);
+
+// How many futures `env` still keeps, pending or held by a script value.
+int64_t glms_async_count(GLMSEnv *env);
+
+// Waits for the background work of `env` and frees its futures.
+void glms_async_clear(GLMSEnv *env);
+#endif
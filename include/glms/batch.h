@@ -0,0 +1,32 @@
+#ifndef GLMS_BATCH_H
+#define GLMS_BATCH_H
+#include <glms/env.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// What running one script of a batch did.
+typedef struct {
+  const char *path;
+  // false if the script could not be read, or raised an error while
+  // it ran, see the `errors` field of GLMSEnv. Warnings alone, like a
+  // file that failed to open, do not fail it.
+  bool ok;
+  int64_t usec;
+} GLMSBatchResult;
+
+// Runs every script in `paths` in its own env, on up to `jobs` threads
+// (<= 0 means one per core). Builtin modules are registered once up front,
+// and imported modules are parsed once for the whole batch, each script
+// running its own instance of them.
+// `results` must have room for `length` entries, which are filled in order.
+// Returns how many scripts failed to run.
+int64_t glms_batch_run(const char **paths, int64_t length, int64_t jobs,
+                       GLMSConfig cfg, GLMSBatchResult *results);
+
+// Reads one script path per line, skipping empty lines and lines starting
+// with `#`. The paths must be freed with glms_batch_free_list.
+int glms_batch_read_list(const char *list_path, char ***paths,
+                         int64_t *length);
+
+void glms_batch_free_list(char **paths, int64_t length);
+#endif
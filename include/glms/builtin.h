@@ -4,61 +4,73 @@
 #include <glms/type.h>
 
 #include "glms/ast.h"
+#include "glms/native.h"
 
 void glms_builtin_init(GLMSEnv *env);
 
-int glms_fptr_dot(GLMSEval *eval, GLMSAST *ast, GLMSASTBuffer *args,
-                  GLMSStack *stack, GLMSAST *out);
+// Returns the process-wide env holding every builtin. It is built once,
+// on first use from any thread, and envs look builtins up in it through
+// their parent chain.
+GLMSEnv *glms_builtin_get_prototype();
 
-int glms_fptr_distance(GLMSEval *eval, GLMSAST *ast, GLMSASTBuffer *args,
-                       GLMSStack *stack, GLMSAST *out);
+// Unlike glms_builtin_get_prototype, never builds the prototype.
+bool glms_builtin_is_prototype(GLMSEnv *env);
 
-int glms_fptr_cross(GLMSEval *eval, GLMSAST *ast, GLMSASTBuffer *args,
-                    GLMSStack *stack, GLMSAST *out);
-
-int glms_fptr_normalize(GLMSEval *eval, GLMSAST *ast, GLMSASTBuffer *args,
-                        GLMSStack *stack, GLMSAST *out);
+// Registers the lazily loaded builtin module providing `name`
+// into the prototype. Returns 1 if a module was registered.
+int glms_builtin_load_module(const char *name);
 
-int glms_fptr_length(GLMSEval *eval, GLMSAST *ast, GLMSASTBuffer *args,
-                     GLMSStack *stack, GLMSAST *out);
+// Held by lookups reaching the prototype while builtin modules are still
+// pending, so they never read its maps while a module is registered into
+// them. Returns whether the lock was taken, pass it to
+// glms_builtin_unlock_lookup.
+bool glms_builtin_lock_lookup();
 
-int glms_fptr_cos(GLMSEval *eval, GLMSAST *ast, GLMSASTBuffer *args,
-                  GLMSStack *stack, GLMSAST *out);
+void glms_builtin_unlock_lookup(bool locked);
 
-int glms_fptr_sin(GLMSEval *eval, GLMSAST *ast, GLMSASTBuffer *args,
-                  GLMSStack *stack, GLMSAST *out);
+// Registers every lazily loaded builtin module, for example before
+// exporting docs, or before envs start running on several threads,
+// so their lookups never wait on glms_builtin_lock_lookup.
+void glms_builtin_load_modules();
 
-int glms_fptr_tan(GLMSEval *eval, GLMSAST *ast, GLMSASTBuffer *args,
-                  GLMSStack *stack, GLMSAST *out);
+int glms_fptr_length(GLMSEval *eval, GLMSAST *ast, GLMSASTBuffer *args,
+                     GLMSStack *stack, GLMSAST *out);
 
 int glms_fptr_atan(GLMSEval *eval, GLMSAST *ast, GLMSASTBuffer *args,
                    GLMSStack *stack, GLMSAST *out);
 
-int glms_fptr_fract(GLMSEval *eval, GLMSAST *ast, GLMSASTBuffer *args,
+int glms_fptr_trace(GLMSEval *eval, GLMSAST *ast, GLMSASTBuffer *args,
                     GLMSStack *stack, GLMSAST *out);
 
-int glms_fptr_abs(GLMSEval *eval, GLMSAST *ast, GLMSASTBuffer *args,
-                  GLMSStack *stack, GLMSAST *out);
+int glms_fptr_random(GLMSEval *eval, GLMSAST *ast, GLMSASTBuffer *args,
+                     GLMSStack *stack, GLMSAST *out);
 
-int glms_fptr_pow(GLMSEval *eval, GLMSAST *ast, GLMSASTBuffer *args,
-                  GLMSStack *stack, GLMSAST *out);
+GLMSNativeValue glms_native_dot(const GLMSNativeValue *args);
 
-int glms_fptr_log(GLMSEval *eval, GLMSAST *ast, GLMSASTBuffer *args,
-                  GLMSStack *stack, GLMSAST *out);
+GLMSNativeValue glms_native_distance(const GLMSNativeValue *args);
 
-int glms_fptr_log10(GLMSEval *eval, GLMSAST *ast, GLMSASTBuffer *args,
-                    GLMSStack *stack, GLMSAST *out);
+GLMSNativeValue glms_native_cross(const GLMSNativeValue *args);
 
-int glms_fptr_lerp(GLMSEval *eval, GLMSAST *ast, GLMSASTBuffer *args,
-                   GLMSStack *stack, GLMSAST *out);
+GLMSNativeValue glms_native_normalize(const GLMSNativeValue *args);
 
-int glms_fptr_clamp(GLMSEval *eval, GLMSAST *ast, GLMSASTBuffer *args,
-                    GLMSStack *stack, GLMSAST *out);
+GLMSNativeValue glms_native_cos(const GLMSNativeValue *args);
 
-int glms_fptr_trace(GLMSEval *eval, GLMSAST *ast, GLMSASTBuffer *args,
-                    GLMSStack *stack, GLMSAST *out);
+GLMSNativeValue glms_native_sin(const GLMSNativeValue *args);
 
-int glms_fptr_random(GLMSEval *eval, GLMSAST *ast, GLMSASTBuffer *args,
-                     GLMSStack *stack, GLMSAST *out);
+GLMSNativeValue glms_native_tan(const GLMSNativeValue *args);
+
+GLMSNativeValue glms_native_fract(const GLMSNativeValue *args);
+
+GLMSNativeValue glms_native_abs(const GLMSNativeValue *args);
+
+GLMSNativeValue glms_native_pow(const GLMSNativeValue *args);
+
+GLMSNativeValue glms_native_log(const GLMSNativeValue *args);
+
+GLMSNativeValue glms_native_log10(const GLMSNativeValue *args);
+
+GLMSNativeValue glms_native_lerp(const GLMSNativeValue *args);
+
+GLMSNativeValue glms_native_clamp(const GLMSNativeValue *args);
 
 #endif
@@ -0,0 +1,36 @@
+#ifndef GLMS_CHANNEL_H
+#define GLMS_CHANNEL_H
+#include <glms/env.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// A bounded queue of values, shared by envs on different threads.
+// Any number of threads can send and receive, without locks.
+typedef struct GLMS_CHANNEL_STRUCT GLMSChannel;
+
+// The channel starts with one reference, see glms_channel_release.
+GLMSChannel *glms_channel_new(int64_t capacity);
+
+GLMSChannel *glms_channel_retain(GLMSChannel *channel);
+
+// Frees the channel, and the values still in it, with its last reference.
+void glms_channel_release(GLMSChannel *channel);
+
+// Blocks while the channel is full. Numbers, booleans, vectors, matrices
+// and typed arrays are sent as they are (a typed array still points to the
+// same host memory). Strings, arrays and objects are copied out of their
+// env once, and handed over to the receiving env without another copy.
+// Returns 0 if the channel is closed or the value can not be sent.
+int glms_channel_send(GLMSChannel *channel, GLMSAST value);
+
+// Blocks while the channel is empty. The value is made in `env`,
+// 0 once the channel is closed and every value sent before has been received.
+GLMSAST *glms_channel_recv(GLMSChannel *channel, GLMSEnv *env);
+
+// Wakes up every thread waiting to send or receive.
+void glms_channel_close(GLMSChannel *channel);
+
+bool glms_channel_is_closed(GLMSChannel *channel);
+
+int64_t glms_channel_get_capacity(GLMSChannel *channel);
+#endif
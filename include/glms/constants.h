@@ -2,7 +2,10 @@
 #define GLMS_CONSTANTS_H
 
 #define GLMS_MEMO_AST_PAGE_CAPACITY 30000
+#define GLMS_MEMO_AST_PAGE_CAPACITY_MIN 1024
 #define GLMS_ARENA_AST_CAPACITY (GLMS_MEMO_AST_PAGE_CAPACITY * 2)
+// roughly how many characters of source produce one AST node.
+#define GLMS_MEMO_AST_CHARS_PER_NODE 4
 #define GLMS_GC_SWEEP_THRESHOLD 64
 #define GLMS_GC_SWEEP_ITER (GLMS_GC_SWEEP_THRESHOLD / 2)
 
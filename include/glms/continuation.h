@@ -0,0 +1,44 @@
+#ifndef GLMS_CONTINUATION_H
+#define GLMS_CONTINUATION_H
+#include <glms/ast.h>
+#include <stdint.h>
+
+#define GLMS_CONTINUATION_STACK_SIZE (8 * 1024 * 1024)
+
+// how many stacks of freed continuations are kept for new ones.
+#define GLMS_CONTINUATION_STACK_POOL 4
+
+// how often (in evaluated nodes) the deadline is compared to the clock.
+#define GLMS_CONTINUATION_CLOCK_INTERVAL 256
+
+struct GLMS_ENV_STRUCT;
+
+// How much a script may run before it is suspended.
+// `nodes` counts evaluated nodes, `usec` is wall-clock time.
+// Zero means no limit.
+typedef struct {
+  int64_t nodes;
+  int64_t usec;
+} GLMSBudget;
+
+typedef enum {
+  GLMS_EXEC_ERROR,
+  GLMS_EXEC_DONE,
+  GLMS_EXEC_SUSPENDED
+} GLMSExecStatus;
+
+// A script running on its own stack, so it can be suspended anywhere
+// in the evaluator and resumed later. Owned by the env's eval.
+typedef struct GLMS_CONTINUATION_STRUCT GLMSContinuation;
+
+GLMSContinuation *glms_continuation_new(struct GLMS_ENV_STRUCT *env,
+                                        GLMSAST *func, GLMSASTBuffer args);
+
+GLMSExecStatus glms_continuation_run(GLMSContinuation *c, GLMSBudget budget,
+                                     GLMSAST *out);
+
+// called by the evaluator for every node while a continuation runs.
+void glms_continuation_tick(GLMSContinuation *c);
+
+void glms_continuation_free(GLMSContinuation *c);
+#endif
@@ -15,6 +15,9 @@
 #include <limits.h>
 
 #include <glms/type.h>
+#include <glms/layout.h>
+#include <glms/continuation.h>
+#include <glms/reload.h>
 
 
 #define GLMS_ENV_POSITION_INFO_STRING_CAP PATH_MAX
@@ -24,11 +27,17 @@ typedef struct {
   bool use_heap_strings;
   Memo* memo_ast;
   GLMSEmitConfig emit;
+  // used by the *_budget functions when they are given an empty budget.
+  GLMSBudget budget;
+  // threads reading and parsing imports ahead of evaluation,
+  // off at 0 and 1, < 0 means one per core.
+  int64_t import_threads;
 } GLMSConfig;
 
 typedef struct GLMS_ENV_STRUCT {
   Memo memo_ast;
   Arena arena_ast;
+  int64_t page_capacity;
   GLMSConfig config;
   bool initialized;
   const char *source;
@@ -41,6 +50,8 @@ typedef struct GLMS_ENV_STRUCT {
 
   HashyMap globals;
   HashyMap types;
+  HashyMap handles;
+  HashyMap layouts;
 
   GLMSAST *undefined;
   GLMSAST *stackptr;
@@ -57,16 +68,110 @@ typedef struct GLMS_ENV_STRUCT {
 
   bool has_builtins;
 
+  // globals and types not found in this env are looked up here,
+  // see glms_env_fork.
+  struct GLMS_ENV_STRUCT *parent;
+
+  // set by glms_env_freeze.
+  bool frozen;
+
+  // set on the workers of glms_parallel_run, which can read every value
+  // in scope but only write their own (and host memory).
+  bool isolated;
+
+  // set on an importer's instance of a module, see glms_module_instantiate.
+  bool imported;
+
+  // set on the scope of a function handle, whose values are released by
+  // the handle's next call, see glms_env_call_handle.
+  bool scoped;
+
+  // what the last load or reload ran, see glms_env_reload.
+  GLMSReload reload;
+
+  // futures waiting for background work, see glms_env_poll.
+  struct GLMS_ASYNC_STRUCT *async;
+
+  // channels held by values of this env, released by glms_env_clear.
+  struct GLMS_CHANNEL_STRUCT **channels;
+  int64_t channels_length;
+
+  // warnings raised while glms_env_exec last ran, and how many of them
+  // were errors (like undefined names or values that could not be
+  // written). 0 errors if the script ran cleanly.
+  int64_t warnings;
+  int64_t errors;
+
   char position_info[GLMS_ENV_POSITION_INFO_STRING_CAP];
 } GLMSEnv;
 
 typedef void (*GLMSExtensionEntryFunc)(GLMSEnv *env);
 
+// A script function resolved once, with a frame that is reused
+// between calls and reset to its parameters after each one. The frame
+// sees the globals that existed when the handle was created. What a
+// call allocates (copies of its arguments, temporaries and the result)
+// lives in the handle's scope, which the next call releases. Lists and
+// objects a call stores in values outside of it are copied into the env
+// owning those values. `pure` marks functions that only depend on their
+// arguments, and lets glms_env_call_batch split its rows across threads.
+typedef struct GLMS_FUNCTION_HANDLE_STRUCT {
+  GLMSEnv *env;
+  GLMSAST *func;
+  GLMSStack frame;
+  GLMSEnv scope;
+  GLMSAST **params;
+  const char **param_names;
+  int64_t params_length;
+  bool pure;
+} GLMSFunctionHandle;
+
+// A frozen, initialized env that new envs can be forked from.
+// Functions are shared with every fork, other top-level values
+// are copied into the fork so it can never write to the snapshot.
+typedef struct GLMS_ENV_SNAPSHOT_STRUCT {
+  GLMSEnv *env;
+  GLMSStack shared;
+  GLMSStack values;
+} GLMSEnvSnapshot;
+
 int glms_env_init(GLMSEnv *env, const char *source, const char *entry_path,
                   GLMSConfig cfg);
 
 int glms_env_clear(GLMSEnv *env);
 
+// `env` must outlive the snapshot and its forks,
+// and should not be executed again once snapshotted.
+GLMSEnvSnapshot *glms_env_snapshot(GLMSEnv *env);
+
+// Constructs every registered type up front, so envs sharing this one
+// through `parent` never construct (and allocate into) it themselves.
+void glms_env_construct_types(GLMSEnv *env);
+
+// Constructs types and types every global and top-level value up front,
+// then marks the env as frozen: from then on evaluating code of this env
+// only reads its nodes, so several envs can do so on different threads.
+void glms_env_freeze(GLMSEnv *env);
+
+// Evaluates an already parsed `root` in `env`, without copying it.
+// Code parsed by a snapshotted (frozen) env can be run by many of its
+// forks at once, each on its own thread.
+GLMSAST *glms_env_exec_root(GLMSEnv *env, GLMSAST *root);
+
+void glms_env_snapshot_free(GLMSEnvSnapshot *snapshot);
+
+// Resolves the futures whose background work is done, like `file.readAsync`,
+// and runs their `then` callbacks on the calling thread.
+// Returns how many futures are still waiting.
+int64_t glms_env_poll(GLMSEnv *env);
+
+int glms_env_fork(GLMSEnvSnapshot *snapshot, GLMSEnv *env, const char *source,
+                  const char *entry_path);
+
+int64_t glms_env_get_page_capacity(const char *source);
+
+Memo *glms_env_get_memo(GLMSEnv *env);
+
 GLMSAST* glms_env_parse(GLMSEnv* env, const char *source,
 			GLMSConfig cfg);
 
@@ -87,14 +192,54 @@ GLMSAST *glms_env_exec(GLMSEnv *env);
 
 GLMSAST *glms_env_exec_source(GLMSEnv *env, const char *source);
 
+// Like glms_env_exec, but suspends the script once `budget` runs out.
+// A suspended script is continued with glms_env_resume, and until it is
+// done the glms_env_call_* functions refuse to run on the env.
+GLMSExecStatus glms_env_exec_budget(GLMSEnv *env, GLMSBudget budget);
+
+GLMSExecStatus glms_env_call_function_budget(GLMSEnv *env, const char *name,
+                                             GLMSASTBuffer args,
+                                             GLMSBudget budget, GLMSAST *out);
+
+GLMSExecStatus glms_env_resume(GLMSEnv *env, GLMSBudget budget, GLMSAST *out);
+
+bool glms_env_is_suspended(GLMSEnv *env);
+
 int glms_env_reset(GLMSEnv *env);
 
+// Re-parses and re-runs only the top-level statements of `source` that
+// are not in what the env has already run. Changed functions get their
+// new body in place, global values are left alone.
+int glms_env_reload(GLMSEnv *env, const char *source);
+
+// Reloads `entry_path` if it changed on disk since it was last
+// (re)loaded. Returns 1 if it was reloaded.
+int glms_env_reload_if_changed(GLMSEnv *env);
+
 int glms_env_call_function(GLMSEnv *env, const char *name, GLMSASTBuffer args,
                            GLMSAST *out);
 
+GLMSFunctionHandle *glms_env_get_function(GLMSEnv *env, const char *name);
+
+int glms_env_call_handle(GLMSFunctionHandle *handle, GLMSASTBuffer args,
+                         GLMSAST *out);
+
+// Calls the handle once for every row of `args_matrix`, writing the
+// results in order, which stay valid until the handle's next call. Rows
+// of a `pure` handle are run on one thread per core, where the function
+// can read but not write the env's values.
+int glms_env_call_batch(GLMSEnv *env, GLMSFunctionHandle *handle,
+                        GLMSASTBuffer *args_matrix, int64_t n,
+                        GLMSAST *out_results);
+
 GLMSAST *glms_env_register_function(GLMSEnv *env, const char *name,
                                     GLMSFPTR fptr);
 
+// Registers a native with a fixed signature, see glms/native.h.
+GLMSAST *glms_env_register_native(GLMSEnv *env, const char *name,
+                                  GLMSFunctionSignature signature,
+                                  GLMSNativeFunc native);
+
 int glms_env_register_function_signature(GLMSEnv *env, GLMSAST *ast,
                                          const char *name,
                                          GLMSFunctionSignature signature);
@@ -102,6 +247,20 @@ int glms_env_register_function_signature(GLMSEnv *env, GLMSAST *ast,
 GLMSAST *glms_env_register_struct(GLMSEnv *env, const char *name,
                                   GLMSAST **fields, int fields_length);
 
+// Exposes the fields of a host C struct to scripts. Reads and writes
+// on instances created with glms_env_new_ast_bound go straight to `ptr`.
+GLMSAST *glms_env_register_struct_layout(GLMSEnv *env, const char *name,
+                                         GLMSStructField *fields,
+                                         int64_t fields_length);
+
+GLMSAST *glms_env_new_ast_bound(GLMSEnv *env, const char *name, void *ptr);
+
+// Wraps `length` elements of host memory as an array. `stride` is the
+// distance in bytes between elements, 0 means tightly packed.
+GLMSAST *glms_env_new_ast_typed_array(GLMSEnv *env, GLMSASTType element_type,
+                                      void *data, int64_t length,
+                                      int64_t stride, bool writable);
+
 GLMSAST *glms_env_register_any(GLMSEnv *env, const char *name, GLMSAST *ast);
 
 GLMSAST *glms_env_register_type(GLMSEnv *env, const char *name, GLMSAST *ast,
@@ -112,6 +271,8 @@ GLMSAST *glms_env_register_type(GLMSEnv *env, const char *name, GLMSAST *ast,
 
 GLMSAST *glms_env_lookup_function(GLMSEnv *env, const char *name);
 
+GLMSAST *glms_env_lookup_global(GLMSEnv *env, const char *name);
+
 GLMSAST *glms_env_lookup(GLMSEnv *env, const char *name);
 
 GLMSAST *glms_env_lookup_type(GLMSEnv *env, const char *name);
@@ -6,12 +6,23 @@
 #include <hashy/hashy.h>
 
 struct GLMS_ENV_STRUCT;
+struct GLMS_MODULE_STRUCT;
+struct GLMS_CONTINUATION_STRUCT;
 
 #define GLMS_EVAL_VISITED_PATHS_MAP_CAPACITY 64
 
 typedef struct GLMS_EVAL_STRUCT {
   struct GLMS_ENV_STRUCT *env;
   HashyMap visited_paths;
+  HashyMap modules;
+  // set while a budgeted execution runs, see glms_env_exec_budget.
+  struct GLMS_CONTINUATION_STRUCT *continuation;
+  struct GLMS_CONTINUATION_STRUCT *suspended;
+  // the module instance whose function is running, names in code parsed
+  // by the module resolve in it.
+  struct GLMS_ENV_STRUCT *module;
+  // state of `random()`, kept per eval so envs can run on different threads.
+  unsigned int seed;
   bool initialized;
 } GLMSEval;
 
@@ -38,4 +49,15 @@ void glms_eval_push_args(GLMSEval *eval, GLMSStack *stack, GLMSAST *func,
 GLMSAST glms_eval_import(GLMSEval *eval, GLMSAST ast, GLMSStack *stack);
 
 GLMSAST glms_eval_include(GLMSEval *eval, GLMSAST ast, GLMSStack *stack);
+
+GLMSAST glms_eval_string(GLMSEval *eval, GLMSAST ast, GLMSStack *stack);
+
+// False (with a warning) if `ast` may not be written by this eval,
+// see the `isolated` field of GLMSEnv.
+bool glms_eval_can_write(GLMSEval *eval, GLMSAST *ast);
+
+// A copy of `value` to be stored in `target`. Made in the env owning
+// `target` when this eval runs in a function handle's scope, whose
+// values would not outlive the call.
+GLMSAST *glms_eval_copy_for(GLMSEval *eval, GLMSAST *target, GLMSAST value);
 #endif
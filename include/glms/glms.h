@@ -1,4 +1,10 @@
 #ifndef GLMS_H
 #define GLMS_H
+#include <glms/async.h>
+#include <glms/batch.h>
+#include <glms/channel.h>
 #include <glms/env.h>
+#include <glms/module.h>
+#include <glms/parallel.h>
+#include <glms/pool.h>
 #endif
@@ -0,0 +1,37 @@
+#ifndef GLMS_LAYOUT_H
+#define GLMS_LAYOUT_H
+#include <glms/ast.h>
+#include <glms/shape.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Describes one field of a host C struct, for example:
+// (GLMSStructField){ "position", GLMS_AST_TYPE_VEC3, offsetof(GameObject, position) }
+typedef struct {
+  const char* name;
+  GLMSASTType type;
+  size_t offset;
+} GLMSStructField;
+
+// Field i of a layout lives in slot i of `shape`, so access sites
+// can cache layout fields the same way they cache object properties.
+typedef struct GLMS_STRUCT_LAYOUT_STRUCT {
+  GLMSShape* shape;
+  GLMSStructField* fields;
+  int64_t fields_length;
+} GLMSStructLayout;
+
+GLMSStructLayout* glms_struct_layout_new(GLMSStructField* fields,
+                                         int64_t fields_length);
+
+void glms_struct_layout_free(GLMSStructLayout* layout);
+
+int64_t glms_struct_layout_lookup(GLMSStructLayout* layout, GLMSAST* site,
+                                  const char* key);
+
+int glms_struct_layout_read(GLMSStructLayout* layout, int64_t slot, void* ptr,
+                            GLMSAST* out);
+
+int glms_struct_layout_write(GLMSStructLayout* layout, int64_t slot, void* ptr,
+                             GLMSAST value);
+#endif
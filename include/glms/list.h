@@ -8,6 +8,7 @@
   typedef struct GLMS_##T##_LIST_STRUCT {                 \
     T **items;                                            \
     int64_t length;                                       \
+    int64_t refs;                                         \
     bool initialized;                                     \
   } T##List;                                              \
   int glms_##T##_list_init(T##List *list);                \
@@ -32,19 +32,46 @@
 #define GLMS_CLI_WHITE "\x1B[37m"
 #define GLMS_CLI_RESET "\x1B[0m"
 
+// how many warnings were raised on this thread, and how many of them
+// were errors (the script did something it cannot, like using an
+// undefined name). See the `warnings` and `errors` fields of GLMSEnv.
+extern __thread long glms_warnings_raised;
+extern __thread long glms_errors_raised;
+
 #define GLMS_WARNING(...)                                                    \
   {                                                                          \
+    glms_warnings_raised++;                                                  \
     printf(GLMS_CLI_RED "(GLMS)(Warning)(%s): \n" GLMS_CLI_RESET, __func__); \
     fprintf(__VA_ARGS__);                                                    \
   }
 #define GLMS_WARNING_RETURN(ret, ...)                                        \
   {                                                                          \
+    glms_warnings_raised++;                                                  \
     printf("\n****\n");                                                      \
     printf(GLMS_CLI_RED "(GLMS)(Warning)(%s): \n" GLMS_CLI_RESET, __func__); \
     fprintf(__VA_ARGS__);                                                    \
     printf("\n****\n");                                                      \
     return ret;                                                              \
   }
+#define GLMS_ERROR(...)                                                      \
+  {                                                                          \
+    glms_errors_raised++;                                                    \
+    GLMS_WARNING(__VA_ARGS__)                                                \
+  }
+#define GLMS_ERROR_RETURN(ret, ...)                                          \
+  {                                                                          \
+    glms_errors_raised++;                                                    \
+    GLMS_WARNING_RETURN(ret, __VA_ARGS__)                                    \
+  }
+
+// shared lists and modules may be retained and released from several threads.
+#define GLMS_REFS_GET(refs) __atomic_load_n(&(refs), __ATOMIC_ACQUIRE)
+#define GLMS_REFS_INC(refs) __atomic_add_fetch(&(refs), 1, __ATOMIC_ACQ_REL)
+#define GLMS_REFS_DEC(refs) __atomic_sub_fetch(&(refs), 1, __ATOMIC_ACQ_REL)
+// drops one reference, true for the holder of the last one. `refs` counts
+// the other holders, so the last one is the one that still sees 0.
+#define GLMS_REFS_RELEASE(refs) \
+  (__atomic_fetch_sub(&(refs), 1, __ATOMIC_ACQ_REL) <= 0)
 
 #define GLMS_GENERATE_ENUM(ENUM) ENUM,
 #define GLMS_GENERATE_STRING(STRING) #STRING,
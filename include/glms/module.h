@@ -0,0 +1,59 @@
+#ifndef GLMS_MODULE_H
+#define GLMS_MODULE_H
+#include <glms/env.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+#define GLMS_MODULE_REGISTRY_CAPACITY 64
+
+// A parsed import, shared by every env that imports the same file.
+// Modules are looked up by canonical path and reloaded when the file on
+// disk changes. `env` only holds the parsed code (and what an extension
+// registered), and is frozen once loaded. Every importer executes the
+// module in an instance of its own, see glms_module_instantiate.
+typedef struct GLMS_MODULE_STRUCT {
+  char *path;
+  char *source;
+  struct timespec mtime;
+  GLMSEnv *env;
+  void *handle;
+  int64_t refs;
+  bool stale;
+  // set while the importer that registered it loads it,
+  // other importers wait on `loaded`.
+  bool loading;
+  pthread_cond_t loaded;
+  // read and parsed ahead of time by glms_module_prefetch.
+  bool prefetched;
+} GLMSModule;
+
+// An importer's own execution of a module. Its env reads the module's
+// code and types through `parent`, and keeps its own globals, so state
+// a module keeps is never shared between importers.
+typedef struct {
+  GLMSModule *module;
+  GLMSEnv env;
+} GLMSModuleInstance;
+
+GLMSModule *glms_module_acquire(const char *path, GLMSConfig cfg);
+
+void glms_module_release(GLMSModule *module);
+
+// Executes `module` in a new instance. The instance holds a reference
+// to the module until glms_module_instance_free.
+GLMSModuleInstance *glms_module_instantiate(GLMSModule *module,
+                                            GLMSConfig cfg);
+
+void glms_module_instance_free(GLMSModuleInstance *instance);
+
+// Reads and parses every script reachable through imports from `root`
+// on up to `threads` threads (< 0 for one per core), so
+// glms_module_acquire only has to execute them. Does nothing for 0 or 1.
+// Returns how many modules were parsed.
+int64_t glms_module_prefetch(GLMSEnv *env, GLMSAST *root, int64_t threads);
+
+// frees every cached module that is no longer referenced.
+int glms_module_registry_clear();
+#endif
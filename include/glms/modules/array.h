@@ -1,6 +1,10 @@
 #ifndef GLMS_MODULES_ARRAY_H
 #define GLMS_MODULES_ARRAY_H
 #include <glms/env.h>
+
+// elements per task of the parallel array functions, unless given.
+#define GLMS_ARRAY_PARALLEL_CHUNK 256
+
 void glms_array_type(GLMSEnv *env);
 
 #endif
@@ -0,0 +1,18 @@
+#ifndef GLMS_MODULES_CHANNEL_H
+#define GLMS_MODULES_CHANNEL_H
+#include <glms/channel.h>
+#include <glms/env.h>
+#include <glms/eval.h>
+
+void glms_channel_constructor(GLMSEval *eval, GLMSStack *stack,
+                              GLMSASTBuffer *args, GLMSAST *self);
+
+// The script value of `channel`, a `channel` struct.
+// `env` holds a reference to the channel until it is cleared.
+GLMSAST *glms_channel_new_ast(GLMSEnv *env, GLMSChannel *channel);
+
+// The channel held by a `channel` struct, 0 for anything else.
+GLMSChannel *glms_channel_from_ast(GLMSAST ast);
+
+void glms_channel_type(GLMSEnv *env);
+#endif
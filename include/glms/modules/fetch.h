@@ -2,7 +2,16 @@
 #define GLMS_MODULES_FETCH_H
 
 #include <glms/env.h>
+#include <glms/eval.h>
+
+// transfers running at once, more requests wait for one to finish.
+#define GLMS_FETCH_MAX_CONCURRENT 8
+
+void glms_response_constructor(GLMSEval *eval, GLMSStack *stack,
+                               GLMSASTBuffer *args, GLMSAST *self);
 
 void glms_fetch(GLMSEnv* env);
 
+void glms_fetch_set_max_concurrent(int64_t max);
+
 #endif
@@ -0,0 +1,17 @@
+#ifndef GLMS_MODULES_FUTURE_H
+#define GLMS_MODULES_FUTURE_H
+#include <glms/async.h>
+#include <glms/env.h>
+#include <glms/eval.h>
+
+void glms_future_constructor(GLMSEval *eval, GLMSStack *stack,
+                             GLMSASTBuffer *args, GLMSAST *self);
+
+// The script value of `future`, a `future` struct.
+GLMSAST *glms_future_new_ast(GLMSEnv *env, GLMSFuture *future);
+
+// The future held by a `future` struct, 0 for anything else.
+GLMSFuture *glms_future_from_ast(GLMSAST ast);
+
+void glms_future_type(GLMSEnv *env);
+#endif
@@ -2,6 +2,9 @@
 #define GLMS_MODULES_IMAGE_H
 #include <glms/env.h>
 
+// image.shade evaluates square tiles of this many pixels per side.
+#define GLMS_IMAGE_SHADE_TILE_SIZE 32
+
 void glms_struct_image_constructor(GLMSEval *eval, GLMSStack *stack,
                                    GLMSASTBuffer *args, GLMSAST *self);
 void glms_struct_image(GLMSEnv *env);
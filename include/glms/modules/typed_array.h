@@ -0,0 +1,10 @@
+#ifndef GLMS_MODULES_TYPED_ARRAY_H
+#define GLMS_MODULES_TYPED_ARRAY_H
+#include <glms/env.h>
+void glms_typed_array_type(GLMSEnv *env);
+
+int glms_typed_array_get(GLMSAST *ast, int64_t index, GLMSAST *out);
+
+int glms_typed_array_set(GLMSAST *ast, int64_t index, GLMSAST value);
+
+#endif
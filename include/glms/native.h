@@ -0,0 +1,28 @@
+#ifndef GLMS_NATIVE_H
+#define GLMS_NATIVE_H
+#include <cglm/struct.h>
+#include <mif/linear/vector2/all.h>
+#include <mif/linear/vector3/all.h>
+#include <mif/linear/vector4/all.h>
+#include <stdbool.h>
+
+#define GLMS_NATIVE_ARGS_CAP 8
+
+// An unboxed argument or return value of a native function.
+// Which member is used is decided by the function signature. Vector
+// arguments are zero padded to `v4`, so a native registered for
+// several vector widths can work on all four components.
+typedef union {
+  float number;
+  bool boolean;
+  Vector2 v2;
+  Vector3 v3;
+  Vector4 v4;
+  mat3s m3;
+  mat4s m4;
+} GLMSNativeValue;
+
+// Natives registered with a signature receive their arguments already
+// evaluated and unboxed, and return a value that is boxed once.
+typedef GLMSNativeValue (*GLMSNativeFunc)(const GLMSNativeValue* args);
+#endif
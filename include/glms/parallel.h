@@ -0,0 +1,45 @@
+#ifndef GLMS_PARALLEL_H
+#define GLMS_PARALLEL_H
+#include <glms/env.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Called once for every task index. `eval` and `stack` belong to the
+// worker running the task: nodes allocated through `eval->env` live
+// until every task is done. Returning 0 stops the remaining tasks.
+typedef int (*GLMSParallelTask)(GLMSEval *eval, GLMSStack *stack,
+                                int64_t task, void *user_ptr);
+
+// Totals over every glms_parallel_run on more than one thread.
+// `steals` counts workers taking tasks off another one's share, and
+// `idle_usec` adds up the time workers waited for the slowest one.
+typedef struct {
+  int64_t runs;
+  int64_t tasks;
+  int64_t steals;
+  int64_t idle_usec;
+} GLMSParallelStats;
+
+// Resolves a requested thread count, <= 0 means one thread per core.
+int64_t glms_parallel_get_threads(int64_t threads);
+
+// Runs `task` for every index in [0, tasks) on up to `threads` threads.
+// Each worker has its own env, whose parent is `eval->env`, and its own
+// copy of `stack`, so callbacks only read the caller's nodes. `eval->env`
+// and its parents are frozen until the workers are done. Workers
+// start on equal contiguous shares of the tasks and steal from each other.
+// With one thread the tasks run in order on the calling thread.
+// `merge` (optional) is then called for every task in order, on the
+// calling thread and while the workers' nodes are still alive.
+int glms_parallel_run(GLMSEval *eval, GLMSStack *stack, int64_t threads,
+                      int64_t tasks, GLMSParallelTask task,
+                      GLMSParallelTask merge, void *user_ptr);
+
+void glms_parallel_get_stats(GLMSParallelStats *out);
+
+void glms_parallel_reset_stats();
+
+// Copies a value made by the worker env `from` into `env`, along with
+// everything it points to, so it outlives the run.
+GLMSAST *glms_parallel_adopt(GLMSEnv *env, GLMSEnv *from, GLMSAST value);
+#endif
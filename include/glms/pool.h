@@ -0,0 +1,50 @@
+#ifndef GLMS_POOL_H
+#define GLMS_POOL_H
+#include <glms/env.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Worker threads, each with its own env forked from one snapshot of a
+// script. Jobs call a function of that script, see docs/integration.md.
+typedef struct GLMS_POOL_STRUCT GLMSPool;
+
+// The result of a submitted job.
+typedef struct GLMS_POOL_JOB_STRUCT GLMSPoolFuture;
+
+// Called on the worker thread once a job is done. `result` belongs to
+// the worker's handle for the job's function and is only valid during
+// the call, the worker releases it with the next job.
+typedef void (*GLMSPoolCallback)(GLMSEnv *env, GLMSAST *result,
+                                 void *user_ptr);
+
+// `source` is parsed once and must outlive the pool.
+// `threads` <= 0 means one thread per core.
+GLMSPool *glms_pool_new(const char *source, const char *entry_path,
+                        int64_t threads, GLMSConfig cfg);
+
+// Arguments can be numbers, booleans, vectors, matrices or strings,
+// they are copied before this returns.
+int glms_pool_submit(GLMSPool *pool, const char *name, GLMSASTBuffer args,
+                     GLMSPoolCallback callback, void *user_ptr);
+
+// Like glms_pool_submit, but the result is kept for glms_pool_future_wait.
+// The future must be freed with glms_pool_future_free.
+GLMSPoolFuture *glms_pool_submit_future(GLMSPool *pool, const char *name,
+                                        GLMSASTBuffer args);
+
+// Blocks until the job is done. Results are copied like arguments,
+// a string result stays valid until the future is freed.
+int glms_pool_future_wait(GLMSPoolFuture *future, GLMSAST *out);
+
+bool glms_pool_future_is_done(GLMSPoolFuture *future);
+
+void glms_pool_future_free(GLMSPoolFuture *future);
+
+// Blocks until every submitted job is done.
+void glms_pool_wait(GLMSPool *pool);
+
+int64_t glms_pool_get_threads(GLMSPool *pool);
+
+// Waits for the remaining jobs and stops the workers.
+void glms_pool_free(GLMSPool *pool);
+#endif
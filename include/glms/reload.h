@@ -0,0 +1,31 @@
+#ifndef GLMS_RELOAD_H
+#define GLMS_RELOAD_H
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+// The top-level statements an env has run, as written in the source.
+// A reload only re-parses and re-runs the statements that are not in here.
+typedef struct {
+  char **chunks;
+  int64_t chunks_length;
+  // chunks no longer in the source; parsed code may still point into them.
+  char **retired;
+  int64_t retired_length;
+  struct timespec mtime;
+  bool initialized;
+} GLMSReload;
+
+// Splits `source` into one string per top-level statement.
+int glms_reload_split(const char *source, char ***chunks, int64_t *length);
+
+// Removes `chunk` from the current chunks and returns it, if it is there.
+char *glms_reload_take(GLMSReload *reload, const char *chunk);
+
+// Retires the current chunks that were not taken and replaces them with `chunks`.
+void glms_reload_replace(GLMSReload *reload, char **chunks, int64_t length);
+
+bool glms_reload_get_mtime(const char *path, struct timespec *out);
+
+void glms_reload_clear(GLMSReload *reload);
+#endif
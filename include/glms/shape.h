@@ -0,0 +1,50 @@
+#ifndef GLMS_SHAPE_H
+#define GLMS_SHAPE_H
+#include <hashy/hashy.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// shapes with more fields than this get a lookup table
+// instead of walking the transition chain.
+#define GLMS_SHAPE_TABLE_THRESHOLD 8
+#define GLMS_SHAPE_TRANSITIONS_CAPACITY 8
+
+// the shared tree stops growing at a shape once it has this many
+// transitions or fields, objects past either limit get a dictionary
+// shape of their own instead.
+#define GLMS_SHAPE_TRANSITIONS_MAX 128
+#define GLMS_SHAPE_LENGTH_MAX 128
+
+typedef struct GLMS_SHAPE_STRUCT {
+  struct GLMS_SHAPE_STRUCT* parent;
+  char* key;
+  int64_t slot;
+  int64_t length;
+  HashyMap transitions;
+  int64_t transitions_length;
+  // built on first use, then only read.
+  HashyMap* table;
+  const char** keys;
+  int64_t keys_capacity;
+  bool dictionary;
+} GLMSShape;
+
+// Shapes are shared by every env, and safe to use from several threads.
+// Dictionary shapes are the exception, they belong to the one node
+// holding the slots and follow it like the slots array does.
+GLMSShape* glms_shape_root();
+
+// Returns `shape` itself when it is a dictionary, the key is then added
+// in place.
+GLMSShape* glms_shape_add(GLMSShape* shape, const char* key);
+
+// Dictionary shapes are cloned, shared shapes are returned as is.
+GLMSShape* glms_shape_copy(GLMSShape* shape);
+
+// Only frees dictionary shapes.
+void glms_shape_free(GLMSShape* shape);
+
+int64_t glms_shape_lookup(GLMSShape* shape, const char* key);
+
+const char* glms_shape_get_key(GLMSShape* shape, int64_t slot);
+#endif
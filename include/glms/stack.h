@@ -8,6 +8,12 @@ struct GLMS_ENV_STRUCT;
 
 #define GLMS_STACK_CAPACITY 256
 
+// a name pushed or popped since glms_stack_mark, and what it held before.
+typedef struct {
+  char* name;
+  GLMSAST* previous;
+} GLMSStackEntry;
+
 typedef struct GLMS_STACK_STRUCT {
   HashyMap locals;
   bool initialized;
@@ -17,6 +23,11 @@ typedef struct GLMS_STACK_STRUCT {
 
   bool return_flag;
 
+  // set by glms_stack_mark, see glms_stack_reset.
+  bool marked;
+  GLMSStackEntry* journal;
+  int64_t journal_length;
+  int64_t journal_capacity;
 } GLMSStack;
 
 int glms_stack_init(GLMSStack* stack);
@@ -32,6 +43,12 @@ void glms_stack_dump(GLMSStack* stack, struct GLMS_ENV_STRUCT* env);
 
 int glms_stack_copy(GLMSStack src, GLMSStack* dest);
 
+// From here on every push and pop is recorded, so glms_stack_reset
+// can bring the locals back to what they are now.
+int glms_stack_mark(GLMSStack* stack);
+
+int glms_stack_reset(GLMSStack* stack);
+
 int glms_stack_clear(GLMSStack* stack);
 
 int glms_stack_clear_trash(GLMSStack* stack);
@@ -1,5 +1,6 @@
 #ifndef GLMS_STRING_VIEW_H
 #define GLMS_STRING_VIEW_H
+#include <stdbool.h>
 #include <stdint.h>
 
 #define GLMS_STRING_VIEW_CAPACITY 1024
@@ -8,8 +9,13 @@ typedef struct {
   int64_t length;
   const char* ptr;
   char tmp_buffer[GLMS_STRING_VIEW_CAPACITY];
+  // `tmp_buffer` already holds the value and is never written again,
+  // so parsed code can be read from several threads.
+  bool frozen;
 } GLMSStringView;
 
 const char* glms_string_view_get_value(GLMSStringView* view);
 
+void glms_string_view_freeze(GLMSStringView* view);
+
 #endif
@@ -9,6 +9,7 @@
 #include "fastjson/json.h"
 #include "fastjson/node.h"
 #include "glms/ast_type.h"
+#include "glms/shape.h"
 #include "glms/stack.h"
 #include "glms/string_view.h"
 #include "glms/type.h"
@@ -29,6 +30,10 @@ GLMSAST* glms_ast_push(GLMSAST* parent, GLMSAST* child) {
 
   if (ptr) return glms_ast_push(ptr, child);
 
+  if (glms_ast_is_shared(parent)) {
+    glms_ast_make_unique(parent, parent->env_ref);
+  }
+
   if (!parent->children) {
     parent->children = NEW(GLMSASTList);
   }
@@ -171,7 +176,7 @@ GLMSAST* glms_ast_access_child_by_index(GLMSEnv* env, GLMSAST* ast,
   if (ast->children == 0 || ast->children->length <= 0) return 0;
 
   if (index < 0 || index >= ast->children->length)
-    GLMS_WARNING_RETURN(ast, stderr, "index out of bounds.\n");
+    GLMS_ERROR_RETURN(ast, stderr, "index out of bounds.\n");
 
   return ast->children->items[index];
 }
@@ -208,7 +213,7 @@ GLMSAST* glms_ast_access_by_index(GLMSAST* ast, int64_t index, GLMSEnv* env) {
       return char_ast;
     }; break;
     default: {
-      GLMS_WARNING_RETURN(ast, stderr, "value cannot be indexed.\n");
+      GLMS_ERROR_RETURN(ast, stderr, "value cannot be indexed.\n");
     }; break;
   }
 
@@ -263,7 +268,10 @@ GLMSAST* glms_ast_access_by_key_private(GLMSAST* ast, const char* key,
     GLMSEnv* astenv = ast->as.stack.env;
     GLMSAST* v = glms_env_lookup(astenv, key);
     if (!v) return 0;
-    v->env_ref = astenv;
+    // values of a frozen env (like a parsed module) are read by
+    // importers on several threads, and were made by the env owning them.
+    if (!astenv->frozen && (v->env_ref == 0 || !v->env_ref->frozen))
+      v->env_ref = astenv;
     return v;
   }
 
@@ -278,11 +286,10 @@ GLMSAST* glms_ast_access_by_key_private(GLMSAST* ast, const char* key,
   }
 
   if (ast->type == GLMS_AST_TYPE_UNDEFINED)
-    GLMS_WARNING_RETURN(0, stderr, "cannot index undefined.\n");
+    GLMS_ERROR_RETURN(0, stderr, "cannot index undefined.\n");
   if (ast->type == GLMS_AST_TYPE_NUMBER)
-    GLMS_WARNING_RETURN(0, stderr, "cannot index number.\n");
-  if (!ast->props.initialized) return 0;
-  return (GLMSAST*)hashy_map_get(&ast->props, key);
+    GLMS_ERROR_RETURN(0, stderr, "cannot index number.\n");
+  return glms_ast_get_property(ast, key);
 }
 
 GLMSAST* glms_ast_access_by_key(GLMSAST* ast, const char* key, GLMSEnv* env) {
@@ -443,25 +450,42 @@ GLMSAST* glms_ast_object_set_property(GLMSAST* obj, const char* key,
                                       GLMSAST* value) {
   if (!obj || !key) return 0;
 
-  if (!obj->props.initialized) {
-    hashy_map_init(&obj->props,
-                      (HashyConfig){.capacity = 256});
+  GLMSShape* shape = obj->shape ? obj->shape : glms_shape_root();
+  int64_t slot = glms_shape_lookup(shape, key);
+
+  // unsetting leaves a hole, the shape stays the same.
+  if (slot < 0 && value == 0) return obj;
+
+  if (slot < 0) {
+    shape = glms_shape_add(shape, key);
+    if (!shape) return 0;
+    slot = shape->length - 1;
   }
 
-  if (value == 0) {
-    hashy_map_unset(&obj->props, key);
-  } else {
-    hashy_map_set(&obj->props, key, value);
+  if (shape->length > obj->slots_capacity) {
+    int64_t capacity = MAX(4, obj->slots_capacity);
+    while (capacity < shape->length) capacity *= 2;
+
+    GLMSAST** slots =
+        (GLMSAST**)realloc(obj->slots, capacity * sizeof(GLMSAST*));
+    if (!slots) GLMS_WARNING_RETURN(0, stderr, "Could not grow slots.\n");
+
+    memset(&slots[obj->slots_capacity], 0,
+           (capacity - obj->slots_capacity) * sizeof(GLMSAST*));
+    obj->slots = slots;
+    obj->slots_capacity = capacity;
   }
 
+  obj->shape = shape;
+  obj->slots[slot] = value;
+
   return obj;
 }
 
 float glms_ast_get_number_by_key(GLMSAST* ast, const char* key) {
   if (!ast || !key) return 0.0f;
-  if (!ast->props.initialized) return 0.0f;
 
-  GLMSAST* value = (GLMSAST*)hashy_map_get(&ast->props, key);
+  GLMSAST* value = glms_ast_get_property(ast, key);
 
   if (!value) return 0.0f;
   if (value->type != GLMS_AST_TYPE_NUMBER) return 0.0f;
@@ -516,14 +540,19 @@ GLMSAST* glms_ast_copy(GLMSAST src, GLMSEnv* env) {
     //     glms_ast_assign(dest, src, &env->eval, &env->stack);
   }
 
-  dest->props = (HashyMap){0};
+  dest->shape = glms_ast_has_props(&src) ? glms_shape_copy(src.shape) : 0;
+  dest->slots = 0;
+  dest->slots_capacity = 0;
   dest->children = 0;
   dest->flags = 0;
   dest->string_rep = 0;
   dest->ptr = src.ptr;
   dest->constructor = src.constructor;
   dest->value_type = src.value_type;
-  dest->env_ref = src.env_ref;
+  // a frozen env is never written again, so copies of its nodes
+  // allocate from the env they were copied into instead.
+  dest->env_ref =
+      src.env_ref != 0 && src.env_ref->frozen ? env : src.env_ref;
 
   dest->iterator_next = src.iterator_next;
 
@@ -535,12 +564,11 @@ GLMSAST* glms_ast_copy(GLMSAST src, GLMSEnv* env) {
 
   if (src.typename) dest->typename = strdup(src.typename);
 
+  // children are shared and only copied once either side mutates them,
+  // see glms_ast_make_unique.
   if (src.children != 0) {
-    for (int64_t i = 0; i < src.children->length; i++) {
-      GLMSAST* child = src.children->items[i];
-      GLMSAST* copied = glms_ast_copy(*child, env);
-      glms_ast_push(dest, copied);
-    }
+    dest->children = src.children;
+    GLMS_REFS_INC(dest->children->refs);
   }
 
   if (src.flags != 0) {
@@ -551,16 +579,14 @@ GLMSAST* glms_ast_copy(GLMSAST src, GLMSEnv* env) {
     }
   }
 
-  if (src.props.initialized) {
-    hashy_map_init(&dest->props, src.props.config);
-    HashyIterator it = {0};
+  if (glms_ast_has_props(&src) && dest->shape != 0) {
+    dest->slots = (GLMSAST**)calloc(src.shape->length, sizeof(GLMSAST*));
+    if (!dest->slots) GLMS_WARNING_RETURN(dest, stderr, "Failed to copy.\n");
+    dest->slots_capacity = src.shape->length;
 
-    while (hashy_map_iterate(&src.props, &it)) {
-      if (!it.bucket->is_set) continue;
-      if (!it.bucket->value) continue;
-
-      const char* key = it.bucket->key.value;
-      GLMSAST* value = (GLMSAST*)it.bucket->value;
+    for (int64_t i = 0; i < src.shape->length; i++) {
+      GLMSAST* value = src.slots[i];
+      if (!value) continue;
 
       GLMSAST* copied = glms_ast_copy(*value, env);
 
@@ -568,13 +594,68 @@ GLMSAST* glms_ast_copy(GLMSAST src, GLMSEnv* env) {
         GLMS_WARNING(stderr, "Failed to copy.\n");
         continue;
       }
-      glms_ast_object_set_property(dest, key, copied);
+      dest->slots[i] = copied;
     }
   }
 
   return dest;
 }
 
+bool glms_ast_is_shared(GLMSAST* ast) {
+  if (!ast) return false;
+  return ast->children != 0 && GLMS_REFS_GET(ast->children->refs) > 0;
+}
+
+void glms_ast_release_children(GLMSAST* ast) {
+  if (!ast || !ast->children) return;
+
+  if (GLMS_REFS_RELEASE(ast->children->refs)) {
+    glms_GLMSAST_list_clear(ast->children);
+    free(ast->children);
+  }
+
+  ast->children = 0;
+}
+
+int glms_ast_make_unique(GLMSAST* ast, GLMSEnv* env) {
+  if (!ast) return 0;
+
+  GLMSAST* ptr = glms_ast_get_ptr(*ast);
+
+  if (ptr) return glms_ast_make_unique(ptr, env);
+
+  if (!glms_ast_is_shared(ast)) return 1;
+
+  env = env ? env : ast->env_ref;
+
+  if (!env) GLMS_WARNING_RETURN(0, stderr, "Cannot copy without env.\n");
+
+  GLMSASTList* shared = ast->children;
+
+  // another holder may have let go since the check above.
+  if (GLMS_REFS_RELEASE(shared->refs)) {
+    GLMS_REFS_INC(shared->refs);
+    return 1;
+  }
+
+  ast->children = NEW(GLMSASTList);
+  glms_GLMSAST_list_init(ast->children);
+
+  if (shared->length <= 0) return 1;
+
+  ast->children->items = (GLMSAST**)calloc(shared->length, sizeof(GLMSAST*));
+  if (!ast->children->items)
+    GLMS_WARNING_RETURN(0, stderr, "Could not allocate list.\n");
+
+  for (int64_t i = 0; i < shared->length; i++) {
+    ast->children->items[i] = glms_ast_copy(*shared->items[i], env);
+  }
+
+  ast->children->length = shared->length;
+
+  return 1;
+}
+
 void glms_ast_destructor_binop(GLMSAST* ast) {
   if (ast->as.binop.left != 0) {
     // glms_ast_destructor(ast->as.binop.left);
@@ -740,15 +821,9 @@ void glms_ast_destructor(GLMSAST* ast) {
   }
   ast->string_rep = 0;
 
-  if (ast->children != 0) {
-    for (int64_t i = 0; i < ast->children->length; i++) {
-      glms_ast_destructor(ast->children->items[i]);
-    }
-
-    glms_GLMSAST_list_clear(ast->children);
-    free(ast->children);
-  }
-  ast->children = 0;
+  // the items themselves are owned by the allocator they came from,
+  // and a shared list may hold items from another env or allocator.
+  glms_ast_release_children(ast);
 
   if (ast->flags != 0) {
     for (int64_t i = 0; i < ast->flags->length; i++) {
@@ -761,7 +836,15 @@ void glms_ast_destructor(GLMSAST* ast) {
   ast->flags = 0;
 
   ast->fptr = 0;
-  hashy_map_clear(&ast->props);
+  ast->native = 0;
+
+  if (ast->slots != 0) {
+    free(ast->slots);
+    ast->slots = 0;
+  }
+  ast->slots_capacity = 0;
+  glms_shape_free(ast->shape);
+  ast->shape = 0;
 
   if (ast->typename != 0) {
     free(ast->typename);
@@ -783,7 +866,7 @@ int64_t glms_ast_array_get_length(GLMSAST* ast) {
     return ast->children ? ast->children->length : 0;
   }
 
-  if (ast->props.initialized && ast->props.num_inserts > 0) return ast->props.num_inserts;
+  if (glms_ast_has_props(ast)) return glms_ast_count_props(ast);
 
   return 0;
 }
@@ -801,9 +884,44 @@ void glms_ast_keep(GLMSAST* ast) {
 
 GLMSAST* glms_ast_get_property(GLMSAST* ast, const char* key) {
   if (!ast || !key) return 0;
-  if (!ast->props.initialized) return 0;
+  if (!glms_ast_has_props(ast)) return 0;
+
+  int64_t slot = glms_shape_lookup(ast->shape, key);
+  if (slot < 0) return 0;
+
+  return ast->slots[slot];
+}
+
+bool glms_ast_has_props(GLMSAST* ast) {
+  if (!ast) return false;
+  return ast->shape != 0 && ast->slots != 0 && ast->shape->length > 0;
+}
+
+int64_t glms_ast_count_props(GLMSAST* ast) {
+  if (!glms_ast_has_props(ast)) return 0;
+
+  int64_t count = 0;
+  for (int64_t i = 0; i < ast->shape->length; i++) {
+    if (ast->slots[i] != 0) count++;
+  }
+
+  return count;
+}
+
+bool glms_ast_iterate_props(GLMSAST* ast, GLMSASTPropIterator* it) {
+  if (!it || !glms_ast_has_props(ast)) return false;
+
+  while (it->index < ast->shape->length) {
+    int64_t slot = it->index++;
+    GLMSAST* value = ast->slots[slot];
+    if (!value) continue;
+
+    it->key = glms_shape_get_key(ast->shape, slot);
+    it->value = value;
+    return true;
+  }
 
-  return (GLMSAST*)hashy_map_get(&ast->props, key);
+  return false;
 }
 
 GLMSAST* glms_ast_register_function(GLMSEnv* env, GLMSAST* ast,
@@ -1046,14 +1164,15 @@ GLMSAST glms_ast_assign(GLMSAST* a, GLMSAST b, struct GLMS_EVAL_STRUCT* eval,
 
       a->as.string.value.length = 0;
       a->as.string.value.ptr = 0;
+      a->as.string.value.frozen = false;
       return b;
     }
   }
 
   if (!same_type) {
-    GLMS_WARNING_RETURN(b, stderr,
-                        "Cannot assign variable of different type (%s = %s).\n",
-                        GLMS_AST_TYPE_STR[a->type], GLMS_AST_TYPE_STR[b.type]);
+    GLMS_ERROR_RETURN(b, stderr,
+                      "Cannot assign variable of different type (%s = %s).\n",
+                      GLMS_AST_TYPE_STR[a->type], GLMS_AST_TYPE_STR[b.type]);
   }
 
   switch (type) {
@@ -1074,8 +1193,36 @@ GLMSAST glms_ast_assign(GLMSAST* a, GLMSAST b, struct GLMS_EVAL_STRUCT* eval,
       a->as.string.value = b.as.string.value;
     }; break;
     default: {
-      // TODO: This is possibly a memory leak. Test and see.
+      // `a` takes a reference on b's list, and drops its own even when
+      // `b` has none.
+      if (b.children != a->children) {
+        if (b.children != 0) GLMS_REFS_INC(b.children->refs);
+        glms_ast_release_children(a);
+      }
+
+      GLMSAST** slots = a->slots;
+      GLMSShape* shape = a->shape;
       *a = b;
+
+      // the slot array and a dictionary shape are owned per node,
+      // the values are not.
+      if (slots != 0 && slots != b.slots) free(slots);
+      if (shape != b.shape) glms_shape_free(shape);
+
+      a->shape = glms_shape_copy(b.shape);
+
+      if (b.slots != 0) {
+        a->slots = a->shape != 0 ? (GLMSAST**)calloc(b.slots_capacity,
+                                                     sizeof(GLMSAST*))
+                                 : 0;
+        if (a->slots != 0) {
+          memcpy(a->slots, b.slots, b.slots_capacity * sizeof(GLMSAST*));
+        } else {
+          a->slots_capacity = 0;
+          glms_shape_free(a->shape);
+          a->shape = 0;
+        }
+      }
     }; break;
   }
 
@@ -1143,25 +1290,26 @@ GLMSAST* glms_ast_register_func_overload(struct GLMS_ENV_STRUCT* env,
   char tmp[256];
   sprintf(tmp, GLMS_FUNC_OVERLOAD_TEMPLATE, name);
 
-  if (!ast->props.initialized) {
-    hashy_map_init(&ast->props,
-                      (HashyConfig){.capacity = 256});
-  }
-
   GLMSAST* arb = glms_env_new_ast(env, GLMS_AST_TYPE_FUNC_OVERLOAD_PTR, false);
   arb->ptr = func;
-  hashy_map_set(&ast->props, tmp, arb);
+  glms_ast_object_set_property(ast, tmp, arb);
 
   return ast;
 }
 
-GLMSFPTR glms_ast_get_func_overload(GLMSAST ast, const char* name) {
-  if (!ast.props.initialized || !name) return 0;
+GLMSFPTR glms_ast_get_func_overload(GLMSAST ast, const char* name,
+                                    GLMSEnv* env) {
+  if (!name) return 0;
 
   char tmp[256];
   sprintf(tmp, GLMS_FUNC_OVERLOAD_TEMPLATE, name);
 
-  GLMSAST* arb = (GLMSAST*)hashy_map_get(&ast.props, tmp);
+  GLMSAST* arb = glms_ast_get_property(&ast, tmp);
+
+  if (!arb && env != 0) {
+    GLMSAST* t = glms_env_get_type_for(env, &ast);
+    arb = t ? glms_ast_get_property(t, tmp) : 0;
+  }
 
   if (!arb) return 0;
   if (!arb->ptr) return 0;
@@ -1218,9 +1366,9 @@ char* glms_ast_generate_docstring_func(GLMSAST ast, const char* fname,
 char* glms_ast_generate_docstring_struct(GLMSAST ast, const char* name,
                                          const char* suffix, int depth,
                                          GLMSDocstringGenerator* gen) {
-  if (!ast.props.initialized) return 0;
+  if (!glms_ast_has_props(&ast)) return 0;
 
-  HashyIterator it = {0};
+  GLMSASTPropIterator it = {0};
 
   char tmp[PATH_MAX];
   sprintf(tmp, "<details><summary>props</summary>\n\n");
@@ -1230,12 +1378,9 @@ char* glms_ast_generate_docstring_struct(GLMSAST ast, const char* name,
   text_append(&str, tmp);
 
   int64_t count = 0;
-  while (hashy_map_iterate(&ast.props, &it)) {
-    if (!it.bucket->is_set) continue;
-    if (!it.bucket->value) continue;
-
-    const char* key = it.bucket->key.value;
-    GLMSAST* value = (GLMSAST*)it.bucket->value;
+  while (glms_ast_iterate_props(&ast, &it)) {
+    const char* key = it.key;
+    GLMSAST* value = it.value;
 
     if (key[0] == '_' || strstr(key, "GLMS_") != 0) continue;
 
@@ -1318,3 +1463,94 @@ int glms_ast_iterate(GLMSEnv* env, GLMSAST* ast, GLMSIterator* it,
   if (!ast->iterator_next) return 0;
   return ast->iterator_next(env, ast, it, out);
 }
+
+size_t glms_ast_type_get_size(GLMSASTType type) {
+  switch (type) {
+    case GLMS_AST_TYPE_NUMBER: return sizeof(float);
+    case GLMS_AST_TYPE_BOOL: return sizeof(bool);
+    case GLMS_AST_TYPE_VEC2: return sizeof(Vector2);
+    case GLMS_AST_TYPE_VEC3: return sizeof(Vector3);
+    case GLMS_AST_TYPE_VEC4: return sizeof(Vector4);
+    case GLMS_AST_TYPE_MAT3: return sizeof(mat3s);
+    case GLMS_AST_TYPE_MAT4: return sizeof(mat4s);
+    default: return 0;
+  }
+}
+
+int glms_ast_read_memory(GLMSASTType type, const void* mem, GLMSAST* out) {
+  if (!mem || !out) return 0;
+
+  *out = (GLMSAST){.type = type};
+
+  switch (type) {
+    case GLMS_AST_TYPE_NUMBER: {
+      out->as.number.value = *(const float*)mem;
+    }; break;
+    case GLMS_AST_TYPE_BOOL: {
+      out->as.boolean = *(const bool*)mem;
+    }; break;
+    case GLMS_AST_TYPE_VEC2: {
+      out->as.v2 = *(const Vector2*)mem;
+    }; break;
+    case GLMS_AST_TYPE_VEC3: {
+      out->as.v3 = *(const Vector3*)mem;
+    }; break;
+    case GLMS_AST_TYPE_VEC4: {
+      out->as.v4 = *(const Vector4*)mem;
+    }; break;
+    case GLMS_AST_TYPE_MAT3: {
+      out->as.m3 = *(const mat3s*)mem;
+    }; break;
+    case GLMS_AST_TYPE_MAT4: {
+      out->as.m4 = *(const mat4s*)mem;
+    }; break;
+    default: {
+      GLMS_WARNING_RETURN(0, stderr, "Unsupported memory type `%s`.\n",
+                          GLMS_AST_TYPE_STR[type]);
+    }; break;
+  }
+
+  return 1;
+}
+
+int glms_ast_write_memory(GLMSASTType type, void* mem, GLMSAST value) {
+  if (!mem) return 0;
+
+  GLMSAST* ptr = glms_ast_get_ptr(value);
+  if (ptr) value = *ptr;
+
+  if (type != GLMS_AST_TYPE_NUMBER && type != GLMS_AST_TYPE_BOOL &&
+      type != value.type) {
+    GLMS_ERROR_RETURN(0, stderr, "Cannot assign `%s` to `%s`.\n",
+                      GLMS_AST_TYPE_STR[value.type], GLMS_AST_TYPE_STR[type]);
+  }
+
+  switch (type) {
+    case GLMS_AST_TYPE_NUMBER: {
+      *(float*)mem = glms_ast_number(value);
+    }; break;
+    case GLMS_AST_TYPE_BOOL: {
+      *(bool*)mem = glms_ast_is_truthy(value);
+    }; break;
+    case GLMS_AST_TYPE_VEC2: {
+      *(Vector2*)mem = value.as.v2;
+    }; break;
+    case GLMS_AST_TYPE_VEC3: {
+      *(Vector3*)mem = value.as.v3;
+    }; break;
+    case GLMS_AST_TYPE_VEC4: {
+      *(Vector4*)mem = value.as.v4;
+    }; break;
+    case GLMS_AST_TYPE_MAT3: {
+      *(mat3s*)mem = value.as.m3;
+    }; break;
+    case GLMS_AST_TYPE_MAT4: {
+      *(mat4s*)mem = value.as.m4;
+    }; break;
+    default: {
+      return 0;
+    }; break;
+  }
+
+  return 1;
+}
@@ -33,38 +33,27 @@ char* glms_ast_to_string(GLMSAST ast, GLMSAllocator alloc,
     case GLMS_AST_TYPE_STACK: {
       char* s = 0;
 
-      HashyIterator it = {0};
-      while (hashy_map_iterate(&ast.as.stack.env->types, &it)) {
-        if (!it.bucket->is_set) continue;
-        if (!it.bucket->value) continue;
-
-        const char* key = it.bucket->key.value;
-        GLMSAST* value = (GLMSAST*)it.bucket->value;
-
-        char* strval = glms_ast_to_string(*value, alloc, env);
-
-        if (!strval) continue;
-        alloc.strcat(alloc.user_ptr, &s, key);
-        alloc.strcat(alloc.user_ptr, &s, " => ");
-        alloc.strcat(alloc.user_ptr, &s, strval);
-        alloc.strcat(alloc.user_ptr, &s, "\n");
-      }
-
-      HashyIterator it2 = {0};
-      while (hashy_map_iterate(&ast.as.stack.env->globals, &it2)) {
-        if (!it2.bucket->is_set) continue;
-        if (!it2.bucket->value) continue;
-
-        const char* key = it2.bucket->key.value;
-        GLMSAST* value = (GLMSAST*)it2.bucket->value;
-
-        char* strval = glms_ast_to_string(*value, alloc, env);
-
-        if (!strval) continue;
-        alloc.strcat(alloc.user_ptr, &s, key);
-        alloc.strcat(alloc.user_ptr, &s, " => ");
-        alloc.strcat(alloc.user_ptr, &s, strval);
-        alloc.strcat(alloc.user_ptr, &s, "\n");
+      for (GLMSEnv* e = ast.as.stack.env; e != 0; e = e->parent) {
+        HashyMap* maps[] = {&e->types, &e->globals};
+
+        for (int i = 0; i < 2; i++) {
+          HashyIterator it = {0};
+          while (hashy_map_iterate(maps[i], &it)) {
+            if (!it.bucket->is_set) continue;
+            if (!it.bucket->value) continue;
+
+            const char* key = it.bucket->key.value;
+            GLMSAST* value = (GLMSAST*)it.bucket->value;
+
+            char* strval = glms_ast_to_string(*value, alloc, env);
+
+            if (!strval) continue;
+            alloc.strcat(alloc.user_ptr, &s, key);
+            alloc.strcat(alloc.user_ptr, &s, " => ");
+            alloc.strcat(alloc.user_ptr, &s, strval);
+            alloc.strcat(alloc.user_ptr, &s, "\n");
+          }
+        }
       }
 
       if (!s) return strdup(GLMS_AST_TYPE_STR[ast.type]);
@@ -73,16 +62,13 @@ char* glms_ast_to_string(GLMSAST ast, GLMSAllocator alloc,
 
     }; break;
     case GLMS_AST_TYPE_STRUCT: {
-      HashyIterator it = {0};
+      GLMSASTPropIterator it = {0};
       char* s = 0;
 
-      if (ast.props.initialized) {
-        while (hashy_map_iterate(&ast.props, &it)) {
-          if (!it.bucket->is_set) continue;
-          if (!it.bucket->value) continue;
-
-          const char* key = it.bucket->key.value;
-          GLMSAST* value = (GLMSAST*)it.bucket->value;
+      if (glms_ast_has_props(&ast)) {
+        while (glms_ast_iterate_props(&ast, &it)) {
+          const char* key = it.key;
+          GLMSAST* value = it.value;
 
           char* strval = glms_ast_to_string(*value, alloc, env);
 
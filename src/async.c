@@ -0,0 +1,404 @@
+#include <glms/async.h>
+#include <glms/eval.h>
+#include <glms/macros.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+// The futures of one env. Background threads only touch the done list.
+typedef struct GLMS_ASYNC_STRUCT {
+  pthread_mutex_t lock;
+  pthread_cond_t changed;
+  // only touched on the env's thread.
+  GLMSFuture *pending;
+  GLMSFuture *settled;
+  int64_t pending_length;
+  int64_t settled_length;
+  GLMSFuture *done_head;
+  GLMSFuture *done_tail;
+  int64_t running;
+} GLMSAsync;
+
+// shared by the background threads of every env.
+typedef struct {
+  pthread_mutex_t lock;
+  pthread_cond_t work;
+  GLMSFuture *head;
+  GLMSFuture *tail;
+} GLMSAsyncQueue;
+
+static GLMSAsyncQueue glms_async_queue = {.lock = PTHREAD_MUTEX_INITIALIZER,
+                                          .work = PTHREAD_COND_INITIALIZER};
+
+static pthread_once_t glms_async_threads_once = PTHREAD_ONCE_INIT;
+
+static void glms_async_finish(GLMSFuture *future) {
+  GLMSAsync *async = future->env->async;
+
+  pthread_mutex_lock(&async->lock);
+
+  future->done = true;
+  if (future->running) async->running--;
+  future->running = false;
+  future->next_queued = 0;
+  if (async->done_tail) async->done_tail->next_queued = future;
+  async->done_tail = future;
+  if (!async->done_head) async->done_head = future;
+
+  pthread_cond_broadcast(&async->changed);
+  pthread_mutex_unlock(&async->lock);
+}
+
+static void *glms_async_worker_main(void *ptr) {
+  GLMSAsyncQueue *queue = &glms_async_queue;
+
+  while (true) {
+    pthread_mutex_lock(&queue->lock);
+    while (!queue->head) {
+      pthread_cond_wait(&queue->work, &queue->lock);
+    }
+
+    GLMSFuture *future = queue->head;
+    queue->head = future->next_queued;
+    if (!queue->head) queue->tail = 0;
+    pthread_mutex_unlock(&queue->lock);
+
+    future->ok = future->work(future) != 0;
+    glms_async_finish(future);
+  }
+
+  return 0;
+}
+
+// the threads wait for work for as long as the process runs.
+static void glms_async_start_threads() {
+  for (int64_t i = 0; i < GLMS_ASYNC_THREADS; i++) {
+    pthread_t thread;
+    pthread_create(&thread, 0, glms_async_worker_main, 0);
+    pthread_detach(thread);
+  }
+}
+
+static GLMSAsync *glms_async_get(GLMSEnv *env) {
+  if (env->async != 0) return env->async;
+
+  GLMSAsync *async = NEW(GLMSAsync);
+  pthread_mutex_init(&async->lock, 0);
+  pthread_cond_init(&async->changed, 0);
+  env->async = async;
+
+  return async;
+}
+
+GLMSFuture *glms_future_new(GLMSEnv *env, GLMSFutureWork work,
+                            GLMSFutureResolve resolve) {
+  if (!env) return 0;
+
+  GLMSAsync *async = glms_async_get(env);
+
+  GLMSFuture *future = NEW(GLMSFuture);
+  if (!future) GLMS_WARNING_RETURN(0, stderr, "Could not allocate future.\n");
+
+  future->env = env;
+  future->work = work;
+  future->resolve = resolve;
+  future->state = GLMS_FUTURE_PENDING;
+  future->next = async->pending;
+  if (async->pending) async->pending->prev = future;
+  async->pending = future;
+  async->pending_length++;
+
+  return future;
+}
+
+static void glms_future_free(GLMSFuture *future) {
+  if (future->path) free(future->path);
+  if (future->data) free(future->data);
+  if (future->parts) free(future->parts);
+  if (future->callbacks) free(future->callbacks);
+  free(future);
+}
+
+static void glms_future_release(GLMSFuture *future) {
+  future->refs--;
+
+  if (future->refs > 0 || future->held) return;
+  if (future->state != GLMS_FUTURE_RESOLVED) return;
+
+  glms_future_free(future);
+}
+
+void glms_future_start(GLMSFuture *future) {
+  if (!future) return;
+
+  // nothing to wait for, it is resolved by the next poll.
+  if (!future->work) {
+    future->ok = true;
+    glms_async_finish(future);
+    return;
+  }
+
+  pthread_once(&glms_async_threads_once, glms_async_start_threads);
+
+  glms_future_begin(future);
+
+  GLMSAsyncQueue *queue = &glms_async_queue;
+  pthread_mutex_lock(&queue->lock);
+
+  future->next_queued = 0;
+  if (queue->tail) queue->tail->next_queued = future;
+  queue->tail = future;
+  if (!queue->head) queue->head = future;
+
+  pthread_cond_signal(&queue->work);
+  pthread_mutex_unlock(&queue->lock);
+}
+
+void glms_future_begin(GLMSFuture *future) {
+  if (!future) return;
+
+  GLMSAsync *async = future->env->async;
+  pthread_mutex_lock(&async->lock);
+  async->running++;
+  future->running = true;
+  pthread_mutex_unlock(&async->lock);
+}
+
+void glms_future_finish(GLMSFuture *future, bool ok) {
+  if (!future) return;
+
+  future->ok = ok;
+  glms_async_finish(future);
+}
+
+static GLMSAST *glms_future_resolve_all(GLMSEnv *env, GLMSFuture *future) {
+  GLMSAST *array = glms_env_new_ast(env, GLMS_AST_TYPE_ARRAY, true);
+
+  for (int64_t i = 0; i < future->parts_length; i++) {
+    glms_ast_push(array, future->parts[i]->value);
+  }
+
+  return array;
+}
+
+GLMSFuture *glms_future_all(GLMSEnv *env, GLMSFuture **parts, int64_t length) {
+  GLMSFuture *future = glms_future_new(env, 0, glms_future_resolve_all);
+  if (!future) return 0;
+
+  future->ok = true;
+
+  if (length <= 0) {
+    glms_future_start(future);
+    return future;
+  }
+
+  future->parts = (GLMSFuture **)calloc(length, sizeof(GLMSFuture *));
+  memcpy(future->parts, parts, length * sizeof(GLMSFuture *));
+  future->parts_length = length;
+
+  for (int64_t i = 0; i < length; i++) {
+    parts[i]->refs++;
+  }
+
+  return future;
+}
+
+static void glms_future_call(GLMSFuture *future, GLMSAST *func) {
+  GLMSEnv *env = future->env;
+
+  GLMSStack stack = {0};
+  glms_stack_init(&stack);
+  glms_stack_copy(env->stack, &stack);
+
+  GLMSASTBuffer args = (GLMSASTBuffer){
+      .initialized = true,
+      .items = (GLMSAST[]){(GLMSAST){.type = GLMS_AST_TYPE_STACK_PTR,
+                                     .as.stackptr.ptr = future->value}},
+      .length = 1};
+
+  glms_eval_call_func(&env->eval, &stack, func, args);
+
+  glms_stack_clear(&stack);
+}
+
+int glms_future_then(GLMSFuture *future, GLMSAST func) {
+  if (!future) return 0;
+
+  if (future->state == GLMS_FUTURE_RESOLVED) {
+    glms_future_call(future, &func);
+    return 1;
+  }
+
+  future->callbacks = (GLMSAST *)realloc(
+      future->callbacks, (future->callbacks_length + 1) * sizeof(GLMSAST));
+  future->callbacks[future->callbacks_length++] = func;
+
+  return 1;
+}
+
+static void glms_future_settle(GLMSFuture *future) {
+  GLMSEnv *env = future->env;
+  GLMSAsync *async = env->async;
+
+  if (future->resolve) future->value = future->resolve(env, future);
+  if (!future->value)
+    future->value = glms_env_new_ast(env, GLMS_AST_TYPE_NULL, true);
+
+  future->state = GLMS_FUTURE_RESOLVED;
+
+  if (future->prev) future->prev->next = future->next;
+  if (future->next) future->next->prev = future->prev;
+  if (async->pending == future) async->pending = future->next;
+  async->pending_length--;
+  future->next = 0;
+  future->prev = 0;
+
+  // a callback may await, so the future is kept until they have run.
+  future->refs++;
+
+  for (int64_t i = 0; i < future->callbacks_length; i++) {
+    glms_future_call(future, &future->callbacks[i]);
+  }
+
+  for (int64_t i = 0; i < future->parts_length; i++) {
+    glms_future_release(future->parts[i]);
+  }
+
+  if (future->parts) free(future->parts);
+  future->parts = 0;
+  future->parts_length = 0;
+
+  if (future->callbacks) free(future->callbacks);
+  future->callbacks = 0;
+  future->callbacks_length = 0;
+
+  if (future->held) {
+    future->next = async->settled;
+    async->settled = future;
+    async->settled_length++;
+  }
+
+  glms_future_release(future);
+}
+
+static bool glms_future_parts_resolved(GLMSFuture *future) {
+  for (int64_t i = 0; i < future->parts_length; i++) {
+    if (future->parts[i]->state != GLMS_FUTURE_RESOLVED) return false;
+  }
+
+  return true;
+}
+
+int64_t glms_async_poll(GLMSEnv *env) {
+  if (!env || !env->async) return 0;
+
+  GLMSAsync *async = env->async;
+
+  pthread_mutex_lock(&async->lock);
+  GLMSFuture *done = async->done_head;
+  async->done_head = 0;
+  async->done_tail = 0;
+  pthread_mutex_unlock(&async->lock);
+
+  while (done != 0) {
+    GLMSFuture *next = done->next_queued;
+    done->next_queued = 0;
+    glms_future_settle(done);
+    done = next;
+  }
+
+  // a part can itself be made by glms_future_all, and settling unlinks
+  // the future, so the walk starts over after each one.
+  bool changed = true;
+
+  while (changed) {
+    changed = false;
+
+    for (GLMSFuture *f = async->pending; f != 0; f = f->next) {
+      if (f->parts == 0 || !glms_future_parts_resolved(f)) continue;
+
+      glms_future_settle(f);
+      changed = true;
+      break;
+    }
+  }
+
+  return async->pending_length;
+}
+
+int64_t glms_async_count(GLMSEnv *env) {
+  if (!env || !env->async) return 0;
+
+  return env->async->pending_length + env->async->settled_length;
+}
+
+// called with the env's lock held.
+static bool glms_future_is_done(GLMSFuture *future) {
+  if (future->done || future->state == GLMS_FUTURE_RESOLVED) return true;
+  if (future->parts == 0) return false;
+
+  for (int64_t i = 0; i < future->parts_length; i++) {
+    if (!glms_future_is_done(future->parts[i])) return false;
+  }
+
+  return true;
+}
+
+GLMSAST *glms_future_await(GLMSFuture *future) {
+  if (!future) return 0;
+
+  GLMSAsync *async = future->env->async;
+
+  pthread_mutex_lock(&async->lock);
+  while (!glms_future_is_done(future)) {
+    pthread_cond_wait(&async->changed, &async->lock);
+  }
+  pthread_mutex_unlock(&async->lock);
+
+  // settling frees a future nothing refers to.
+  future->refs++;
+  glms_async_poll(future->env);
+
+  GLMSAST *value = future->value;
+  glms_future_release(future);
+
+  return value;
+}
+
+void glms_async_clear(GLMSEnv *env) {
+  if (!env || !env->async) return;
+
+  GLMSAsync *async = env->async;
+
+  pthread_mutex_lock(&async->lock);
+  while (async->running > 0) {
+    pthread_cond_wait(&async->changed, &async->lock);
+  }
+  pthread_mutex_unlock(&async->lock);
+
+  // settled parts are only reachable from the pending futures using them.
+  for (GLMSFuture *f = async->pending; f != 0; f = f->next) {
+    for (int64_t i = 0; i < f->parts_length; i++) {
+      if (f->parts[i]->state == GLMS_FUTURE_RESOLVED)
+        glms_future_release(f->parts[i]);
+    }
+  }
+
+  GLMSFuture *lists[] = {async->pending, async->settled};
+
+  for (int64_t i = 0; i < 2; i++) {
+    GLMSFuture *future = lists[i];
+
+    while (future != 0) {
+      GLMSFuture *next = future->next;
+      glms_future_free(future);
+      future = next;
+    }
+  }
+
+  pthread_mutex_destroy(&async->lock);
+  pthread_cond_destroy(&async->changed);
+  free(async);
+
+  env->async = 0;
+}
@@ -0,0 +1,134 @@
+#include <glms/batch.h>
+#include <glms/builtin.h>
+#include <glms/io.h>
+#include <glms/macros.h>
+#include <glms/parallel.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct {
+  const char **paths;
+  int64_t length;
+  GLMSConfig cfg;
+  GLMSBatchResult *results;
+  // the index of the next script to run.
+  int64_t next;
+} GLMSBatch;
+
+static int64_t glms_batch_now() {
+  struct timespec ts = {0};
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static bool glms_batch_run_script(GLMSBatch *batch, const char *path) {
+  char *source = glms_get_file_contents(path);
+  if (!source) return false;
+
+  GLMSEnv env = {0};
+  glms_env_init(&env, source, path, batch->cfg);
+  // the root is returned even if the script failed while running.
+  bool ok = glms_env_exec(&env) != 0 && env.errors == 0;
+  glms_env_clear(&env);
+
+  free(source);
+
+  return ok;
+}
+
+static void *glms_batch_worker_main(void *ptr) {
+  GLMSBatch *batch = (GLMSBatch *)ptr;
+
+  while (true) {
+    int64_t i = __atomic_fetch_add(&batch->next, 1, __ATOMIC_RELAXED);
+    if (i >= batch->length) break;
+
+    int64_t start = glms_batch_now();
+    bool ok = glms_batch_run_script(batch, batch->paths[i]);
+
+    batch->results[i] = (GLMSBatchResult){
+        .path = batch->paths[i], .ok = ok, .usec = glms_batch_now() - start};
+  }
+
+  return 0;
+}
+
+int64_t glms_batch_run(const char **paths, int64_t length, int64_t jobs,
+                       GLMSConfig cfg, GLMSBatchResult *results) {
+  if (!paths || !results || length <= 0) return 0;
+
+  jobs = MIN(glms_parallel_get_threads(jobs), length);
+
+  // every env on every thread finds the builtins ready, see
+  // "Running one script on several threads" in docs/integration.md.
+  glms_builtin_load_modules();
+
+  GLMSBatch batch = {
+      .paths = paths, .length = length, .cfg = cfg, .results = results};
+
+  pthread_t *threads = (pthread_t *)calloc(jobs, sizeof(pthread_t));
+
+  // the calling thread is the first worker.
+  for (int64_t i = 1; i < jobs; i++) {
+    pthread_create(&threads[i], 0, glms_batch_worker_main, &batch);
+  }
+
+  glms_batch_worker_main(&batch);
+
+  for (int64_t i = 1; i < jobs; i++) {
+    pthread_join(threads[i], 0);
+  }
+
+  free(threads);
+
+  int64_t failed = 0;
+
+  for (int64_t i = 0; i < length; i++) {
+    failed += !results[i].ok;
+  }
+
+  return failed;
+}
+
+int glms_batch_read_list(const char *list_path, char ***paths,
+                         int64_t *length) {
+  if (!list_path || !paths || !length) return 0;
+
+  char *contents = glms_get_file_contents(list_path);
+  if (!contents)
+    GLMS_WARNING_RETURN(0, stderr, "Could not read `%s`.\n", list_path);
+
+  *paths = 0;
+  *length = 0;
+
+  char *saveptr = 0;
+  char *line = strtok_r(contents, "\r\n", &saveptr);
+
+  while (line != 0) {
+    while (*line == ' ' || *line == '\t') line++;
+
+    int64_t n = strlen(line);
+    while (n > 0 && (line[n - 1] == ' ' || line[n - 1] == '\t')) line[--n] = 0;
+
+    if (n > 0 && line[0] != '#') {
+      *paths = (char **)realloc(*paths, (*length + 1) * sizeof(char *));
+      (*paths)[(*length)++] = strdup(line);
+    }
+
+    line = strtok_r(0, "\r\n", &saveptr);
+  }
+
+  free(contents);
+
+  return 1;
+}
+
+void glms_batch_free_list(char **paths, int64_t length) {
+  if (!paths) return;
+
+  for (int64_t i = 0; i < length; i++) free(paths[i]);
+
+  free(paths);
+}
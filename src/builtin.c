@@ -6,20 +6,25 @@
 #include <glms/macros.h>
 #include <glms/math.h>
 #include <glms/modules/array.h>
+#include <glms/modules/channel.h>
 #include <glms/modules/fetch.h>
 #include <glms/modules/file.h>
+#include <glms/modules/future.h>
 #include <glms/modules/image.h>
 #include <glms/modules/iterator.h>
 #include <glms/modules/json.h>
 #include <glms/modules/mat4.h>
 #include <glms/modules/mat3.h>
 #include <glms/modules/string.h>
+#include <glms/modules/typed_array.h>
 #include <glms/modules/vec2.h>
 #include <glms/modules/vec3.h>
 #include <glms/modules/vec4.h>
 #include <math.h>
 #include <mif/utils.h>
+#include <pthread.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <mif/linear/vector2/all.h>
 #include <mif/linear/vector3/all.h>
@@ -101,16 +106,10 @@ static void glms_dump_ast(GLMSAST ast, GLMSAllocator alloc) {
 
   if (ptr) return glms_dump_ast(*ptr, alloc);
 
-  if (ast.props.initialized) {
-    HashyIterator it = {0};
-    while (hashy_map_iterate(&ast.props, &it)) {
-      if (!it.bucket->is_set) continue;
-      if (!it.bucket->value) continue;
-
-      const char* key = it.bucket->key.value;
-      GLMSAST* value = (GLMSAST*)it.bucket->value;
-
-      printf("%s\n", key);
+  if (glms_ast_has_props(&ast)) {
+    GLMSASTPropIterator it = {0};
+    while (glms_ast_iterate_props(&ast, &it)) {
+      printf("%s\n", it.key);
     }
   }
 }
@@ -127,67 +126,130 @@ int glms_fptr_dump(GLMSEval* eval, GLMSAST* ast, GLMSASTBuffer* args,
   return 0;
 }
 
-int glms_fptr_dot(GLMSEval* eval, GLMSAST* ast, GLMSASTBuffer* args,
-                  GLMSStack* stack, GLMSAST* out) {
-  if (!args) return 0;
-  if (args->length < 2) return 0;
+static float glms_native_v4_dot(Vector4 a, Vector4 b) {
+  return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+}
+
+GLMSNativeValue glms_native_dot(const GLMSNativeValue* args) {
+  return (GLMSNativeValue){
+      .number = glms_native_v4_dot(args[0].v4, args[1].v4)};
+}
 
-  GLMSAST a = glms_eval(eval, args->items[0], stack);
-  GLMSAST b = glms_eval(eval, args->items[1], stack);
+GLMSNativeValue glms_native_distance(const GLMSNativeValue* args) {
+  Vector4 d = VEC4(args[0].v4.x - args[1].v4.x, args[0].v4.y - args[1].v4.y,
+                   args[0].v4.z - args[1].v4.z, args[0].v4.w - args[1].v4.w);
+  return (GLMSNativeValue){.number = sqrtf(glms_native_v4_dot(d, d))};
+}
 
-  if (!glms_ast_is_vector(&a) || !glms_ast_is_vector(&b))
-    GLMS_WARNING_RETURN(0, stderr, "Not a vector.\n");
+GLMSNativeValue glms_native_cross(const GLMSNativeValue* args) {
+  return (GLMSNativeValue){.v3 = vector3_cross(args[0].v3, args[1].v3)};
+}
 
-  *out = (GLMSAST){.type = GLMS_AST_TYPE_NUMBER,
-                   .as.number.value = vector3_dot(a.as.v3, b.as.v3)};
+GLMSNativeValue glms_native_normalize(const GLMSNativeValue* args) {
+  Vector4 v = args[0].v4;
+  float mag = sqrtf(glms_native_v4_dot(v, v));
+  if (mag == 0) return args[0];
 
-  return 1;
+  return (GLMSNativeValue){
+      .v4 = VEC4(v.x / mag, v.y / mag, v.z / mag, v.w / mag)};
 }
 
-int glms_fptr_distance(GLMSEval* eval, GLMSAST* ast, GLMSASTBuffer* args,
-                       GLMSStack* stack, GLMSAST* out) {
-  if (!args) return 0;
-  if (args->length < 2) return 0;
+GLMSNativeValue glms_native_cos(const GLMSNativeValue* args) {
+  return (GLMSNativeValue){.number = cosf(args[0].number)};
+}
 
-  GLMSAST a = glms_eval(eval, args->items[0], stack);
-  GLMSAST b = glms_eval(eval, args->items[1], stack);
+GLMSNativeValue glms_native_sin(const GLMSNativeValue* args) {
+  return (GLMSNativeValue){.number = sinf(args[0].number)};
+}
 
-  if (!glms_ast_is_vector(&a) || !glms_ast_is_vector(&b))
-    GLMS_WARNING_RETURN(0, stderr, "Not a vector.\n");
+GLMSNativeValue glms_native_tan(const GLMSNativeValue* args) {
+  return (GLMSNativeValue){.number = tanf(args[0].number)};
+}
 
-  float next_value = vector3_distance(a.as.v3, b.as.v3);
-  *out = (GLMSAST){.type = GLMS_AST_TYPE_NUMBER, .as.number.value = next_value};
-  return 1;
+GLMSNativeValue glms_native_fract(const GLMSNativeValue* args) {
+  return (GLMSNativeValue){.number = mif_fract(args[0].number)};
 }
 
-int glms_fptr_cross(GLMSEval* eval, GLMSAST* ast, GLMSASTBuffer* args,
-                    GLMSStack* stack, GLMSAST* out) {
-  if (args->length < 2) return 0;
-  GLMSAST a = glms_eval(eval, args->items[0], stack);
-  GLMSAST b = glms_eval(eval, args->items[1], stack);
+GLMSNativeValue glms_native_abs(const GLMSNativeValue* args) {
+  return (GLMSNativeValue){.number = fabsf(args[0].number)};
+}
 
-  if (!glms_ast_is_vector(&a) || !glms_ast_is_vector(&b))
-    GLMS_WARNING_RETURN(0, stderr, "Not a vector.\n");
+GLMSNativeValue glms_native_floor(const GLMSNativeValue* args) {
+  return (GLMSNativeValue){.number = floorf(args[0].number)};
+}
 
-  *out = (GLMSAST){.type = GLMS_AST_TYPE_VEC3,
-                   .as.v3 = vector3_cross(a.as.v3, b.as.v3)};
+GLMSNativeValue glms_native_ceil(const GLMSNativeValue* args) {
+  return (GLMSNativeValue){.number = ceilf(args[0].number)};
+}
 
-  return 1;
+GLMSNativeValue glms_native_round(const GLMSNativeValue* args) {
+  return (GLMSNativeValue){.number = roundf(args[0].number)};
 }
 
-int glms_fptr_normalize(GLMSEval* eval, GLMSAST* ast, GLMSASTBuffer* args,
-                        GLMSStack* stack, GLMSAST* out) {
-  if (args->length <= 0) return 0;
-  GLMSAST a = glms_eval(eval, args->items[0], stack);
+GLMSNativeValue glms_native_lerp(const GLMSNativeValue* args) {
+  float from_ = args[0].number;
+  float to_ = args[1].number;
+  float scale_ = args[2].number;
 
-  if (!glms_ast_is_vector(&a))
-    GLMS_WARNING_RETURN(0, stderr, "Not a vector.\n");
+  return (GLMSNativeValue){.number = from_ + (to_ - from_) * scale_};
+}
 
-  GLMSAST* result = glms_env_new_ast(eval->env, GLMS_AST_TYPE_VEC3, true);
-  Vector3 v = vector3_unit(a.as.v3);
-  *out = (GLMSAST){.type = GLMS_AST_TYPE_VEC3, .as.v3 = v};
+GLMSNativeValue glms_native_clamp(const GLMSNativeValue* args) {
+  return (GLMSNativeValue){
+      .number = mif_clamp(args[0].number, args[1].number, args[2].number)};
+}
 
-  return 1;
+GLMSNativeValue glms_native_pow(const GLMSNativeValue* args) {
+  return (GLMSNativeValue){.number = powf(args[0].number, args[1].number)};
+}
+
+GLMSNativeValue glms_native_log(const GLMSNativeValue* args) {
+  return (GLMSNativeValue){.number = logf(args[0].number)};
+}
+
+GLMSNativeValue glms_native_log10(const GLMSNativeValue* args) {
+  return (GLMSNativeValue){.number = log10f(args[0].number)};
+}
+
+GLMSNativeValue glms_native_radians(const GLMSNativeValue* args) {
+  return (GLMSNativeValue){.number = glm_rad(args[0].number)};
+}
+
+GLMSNativeValue glms_native_cantor(const GLMSNativeValue* args) {
+  int c = mif_cantor((int)args[0].number, (int)args[1].number);
+  return (GLMSNativeValue){.number = (float)c};
+}
+
+GLMSNativeValue glms_native_perspective(const GLMSNativeValue* args) {
+  return (GLMSNativeValue){.m4 = glms_perspective(args[0].number, args[1].number,
+                                                  args[2].number, args[3].number)};
+}
+
+GLMSNativeValue glms_native_ortho(const GLMSNativeValue* args) {
+  return (GLMSNativeValue){
+      .m4 = glms_ortho(args[0].number, args[1].number, args[2].number,
+                       args[3].number, args[4].number, args[5].number)};
+}
+
+GLMSNativeValue glms_native_identity(const GLMSNativeValue* args) {
+  return (GLMSNativeValue){.m4 = glms_mat4_identity()};
+}
+
+GLMSNativeValue glms_native_transpose(const GLMSNativeValue* args) {
+  return (GLMSNativeValue){.m4 = glms_mat4_transpose(args[0].m4)};
+}
+
+GLMSNativeValue glms_native_inverse(const GLMSNativeValue* args) {
+  return (GLMSNativeValue){.m4 = glms_mat4_inv(args[0].m4)};
+}
+
+GLMSNativeValue glms_native_quat_for(const GLMSNativeValue* args) {
+  Vector3 dir = args[0].v3;
+  Vector3 up = args[1].v3;
+  versors q =
+      glms_quat_for((vec3s){dir.x, dir.y, dir.z}, (vec3s){up.x, up.y, up.z});
+
+  return (GLMSNativeValue){.v4 = VEC4(q.raw[0], q.raw[1], q.raw[2], q.raw[3])};
 }
 
 int glms_fptr_length(GLMSEval* eval, GLMSAST* ast, GLMSASTBuffer* args,
@@ -225,28 +287,6 @@ int glms_fptr_length(GLMSEval* eval, GLMSAST* ast, GLMSASTBuffer* args,
   return 1;
 }
 
-int glms_fptr_cos(GLMSEval* eval, GLMSAST* ast, GLMSASTBuffer* args,
-                  GLMSStack* stack, GLMSAST* out) {
-  if (args->length <= 0) return 0;
-
-  GLMSAST value = glms_eval(eval, args->items[0], stack);
-  float v = value.as.number.value;
-
-  *out = (GLMSAST){.type = GLMS_AST_TYPE_NUMBER, .as.number.value = cosf(v)};
-  return 1;
-}
-
-int glms_fptr_tan(GLMSEval* eval, GLMSAST* ast, GLMSASTBuffer* args,
-                  GLMSStack* stack, GLMSAST* out) {
-  if (args->length <= 0) return 0;
-
-  GLMSAST value = glms_eval(eval, args->items[0], stack);
-  float v = value.as.number.value;
-
-  *out = (GLMSAST){.type = GLMS_AST_TYPE_NUMBER, .as.number.value = tanf(v)};
-  return 1;
-}
-
 int glms_fptr_atan(GLMSEval* eval, GLMSAST* ast, GLMSASTBuffer* args,
                    GLMSStack* stack, GLMSAST* out) {
   if (args->length <= 0) return 0;
@@ -264,119 +304,20 @@ int glms_fptr_atan(GLMSEval* eval, GLMSAST* ast, GLMSASTBuffer* args,
   return 1;
 }
 
-int glms_fptr_fract(GLMSEval* eval, GLMSAST* ast, GLMSASTBuffer* args,
-                    GLMSStack* stack, GLMSAST* out) {
-  if (args->length <= 0) return 0;
-
-  GLMSAST value = glms_eval(eval, args->items[0], stack);
-  float v = value.as.number.value;
-
-  *out =
-      (GLMSAST){.type = GLMS_AST_TYPE_NUMBER, .as.number.value = mif_fract(v)};
-
-  return 1;
-}
-
-int glms_fptr_abs(GLMSEval* eval, GLMSAST* ast, GLMSASTBuffer* args,
-                  GLMSStack* stack, GLMSAST* out) {
-  if (args->length <= 0) return 0;
-
-  GLMSAST value = glms_eval(eval, args->items[0], stack);
-  float v = value.as.number.value;
-
-  float next_value = fabsf(v);
-  *out = (GLMSAST){.type = GLMS_AST_TYPE_NUMBER, .as.number.value = next_value};
-
-  return 1;
-}
-
-int glms_fptr_floor(GLMSEval* eval, GLMSAST* ast, GLMSASTBuffer* args,
-                  GLMSStack* stack, GLMSAST* out) {
-  if (args->length <= 0) return 0;
-
-  GLMSAST value = glms_eval(eval, args->items[0], stack);
-
-  *out = (GLMSAST){.type = GLMS_AST_TYPE_NUMBER, .as.number.value = floorf(glms_ast_number(value))};
-
-  return 1;
-}
-
-int glms_fptr_ceil(GLMSEval* eval, GLMSAST* ast, GLMSASTBuffer* args,
-                  GLMSStack* stack, GLMSAST* out) {
-  if (args->length <= 0) return 0;
-
-  GLMSAST value = glms_eval(eval, args->items[0], stack);
-
-  *out = (GLMSAST){.type = GLMS_AST_TYPE_NUMBER, .as.number.value = ceilf(glms_ast_number(value))};
-
-  return 1;
-}
-
-int glms_fptr_round(GLMSEval* eval, GLMSAST* ast, GLMSASTBuffer* args,
-                  GLMSStack* stack, GLMSAST* out) {
-  if (args->length <= 0) return 0;
-
-  GLMSAST value = glms_eval(eval, args->items[0], stack);
-
-  *out = (GLMSAST){.type = GLMS_AST_TYPE_NUMBER, .as.number.value = roundf(glms_ast_number(value))};
-
-  return 1;
-}
-
-int glms_fptr_sin(GLMSEval* eval, GLMSAST* ast, GLMSASTBuffer* args,
-                  GLMSStack* stack, GLMSAST* out) {
-  if (args->length <= 0) return 0;
-
-  GLMSAST value = glms_eval(eval, args->items[0], stack);
-  float v = value.as.number.value;
-
-  *out = (GLMSAST){.type = GLMS_AST_TYPE_NUMBER, .as.number.value = sinf(v)};
-
-  return 1;
-}
-
-int glms_fptr_lerp(GLMSEval* eval, GLMSAST* ast, GLMSASTBuffer* args,
-                   GLMSStack* stack, GLMSAST* out) {
-  if (args->length < 3) return 0;
-
-  float from_ = glms_eval(eval, args->items[0], stack).as.number.value;
-  float to_ = glms_eval(eval, args->items[1], stack).as.number.value;
-  float scale_ = glms_eval(eval, args->items[2], stack).as.number.value;
-
-  float v = from_ + (to_ - from_) * scale_;
-  *out = (GLMSAST){.type = GLMS_AST_TYPE_NUMBER, .as.number.value = v};
-  return 1;
-}
-
-int glms_fptr_clamp(GLMSEval* eval, GLMSAST* ast, GLMSASTBuffer* args,
-                    GLMSStack* stack, GLMSAST* out) {
-  if (args->length < 3) return 0;
-
-  float value = glms_eval(eval, args->items[0], stack).as.number.value;
-  float min = glms_eval(eval, args->items[1], stack).as.number.value;
-  float max = glms_eval(eval, args->items[2], stack).as.number.value;
-
-  float v = mif_clamp(value, min, max);
-
-  *out = (GLMSAST){.type = GLMS_AST_TYPE_NUMBER, .as.number.value = v};
-
-  return 1;
-}
-
 int glms_fptr_random(GLMSEval* eval, GLMSAST* ast, GLMSASTBuffer* args,
                      GLMSStack* stack, GLMSAST* out) {
   float min = 0.0f;
   float max = 1.0f;
   float seed = 32.0f;
   if (args && args->length >= 2) {
-    min = glms_eval(eval, args->items[0], stack).as.number.value;
-    max = glms_eval(eval, args->items[1], stack).as.number.value;
+    min = glms_ast_number(args->items[0]);
+    max = glms_ast_number(args->items[1]);
   }
 
   if (args && args->length >= 3) {
-    seed = glms_eval(eval, args->items[2], stack).as.number.value;
+    seed = glms_ast_number(args->items[2]);
   } else {
-    seed = ((float)rand() / (float)RAND_MAX) * 321415.0f;
+    seed = ((float)rand_r(&eval->seed) / (float)RAND_MAX) * 321415.0f;
   }
 
   *out = (GLMSAST){.type = GLMS_AST_TYPE_NUMBER,
@@ -391,7 +332,7 @@ int glms_fptr_min(GLMSEval* eval, GLMSAST* ast, GLMSASTBuffer* args,
   float min = INFINITY;
 
   for (int64_t i = 0; i < args->length; i++) {
-    float v = glms_eval(eval, args->items[i], stack).as.number.value;
+    float v = glms_ast_number(args->items[i]);
 
     min = fminf(min, v);
   }
@@ -407,7 +348,7 @@ int glms_fptr_max(GLMSEval* eval, GLMSAST* ast, GLMSASTBuffer* args,
   float max = -INFINITY;
 
   for (int64_t i = 0; i < args->length; i++) {
-    float v = glms_eval(eval, args->items[i], stack).as.number.value;
+    float v = glms_ast_number(args->items[i]);
 
     max = fmaxf(max, v);
   }
@@ -416,115 +357,6 @@ int glms_fptr_max(GLMSEval* eval, GLMSAST* ast, GLMSASTBuffer* args,
   return 1;
 }
 
-int glms_fptr_pow(GLMSEval* eval, GLMSAST* ast, GLMSASTBuffer* args,
-                  GLMSStack* stack, GLMSAST* out) {
-  glms_eval_expect(eval, stack,
-                   (GLMSASTType[]){GLMS_AST_TYPE_NUMBER, GLMS_AST_TYPE_NUMBER},
-                   2, args);
-
-  float x = glms_ast_number(args->items[0]);
-  float y = glms_ast_number(args->items[1]);
-
-  *out = (GLMSAST){.type = GLMS_AST_TYPE_NUMBER, .as.number.value = powf(x, y)};
-
-  return 1;
-}
-
-int glms_fptr_log(GLMSEval* eval, GLMSAST* ast, GLMSASTBuffer* args,
-                  GLMSStack* stack, GLMSAST* out) {
-  glms_eval_expect(eval, stack, (GLMSASTType[]){GLMS_AST_TYPE_NUMBER}, 1, args);
-
-  float x = glms_ast_number(args->items[0]);
-  *out = (GLMSAST){.type = GLMS_AST_TYPE_NUMBER, .as.number.value = logf(x)};
-
-  return 1;
-}
-
-int glms_fptr_log10(GLMSEval* eval, GLMSAST* ast, GLMSASTBuffer* args,
-                    GLMSStack* stack, GLMSAST* out) {
-  glms_eval_expect(eval, stack, (GLMSASTType[]){GLMS_AST_TYPE_NUMBER}, 1, args);
-
-  float x = glms_ast_number(args->items[0]);
-  *out = (GLMSAST){.type = GLMS_AST_TYPE_NUMBER, .as.number.value = log10f(x)};
-
-  return 1;
-}
-
-int glms_fptr_perspective(GLMSEval* eval, GLMSAST* ast, GLMSASTBuffer* args,
-                          GLMSStack* stack, GLMSAST* out) {
-  float fov = glms_ast_number(args->items[0]);
-  float aspect = glms_ast_number(args->items[1]);
-  float near = glms_ast_number(args->items[2]);
-  float far = glms_ast_number(args->items[3]);
-
-  GLMSAST result = (GLMSAST){.type = GLMS_AST_TYPE_MAT4,
-                             .as.m4 = glms_perspective(fov, aspect, near, far)};
-
-  mat4s m = result.as.m4;
-
-  *out = result;
-
-  return 1;
-}
-
-int glms_fptr_ortho(GLMSEval* eval, GLMSAST* ast, GLMSASTBuffer* args,
-                    GLMSStack* stack, GLMSAST* out) {
-  float left = glms_ast_number(args->items[0]);
-  float right = glms_ast_number(args->items[1]);
-  float bottom = glms_ast_number(args->items[2]);
-  float top = glms_ast_number(args->items[3]);
-  float near = glms_ast_number(args->items[4]);
-  float far = glms_ast_number(args->items[5]);
-
-  GLMSAST result =
-      (GLMSAST){.type = GLMS_AST_TYPE_MAT4,
-                .as.m4 = glms_ortho(left, right, bottom, top, near, far)};
-
-  *out = result;
-
-  return 1;
-}
-
-int glms_fptr_identity(GLMSEval* eval, GLMSAST* ast, GLMSASTBuffer* args,
-                       GLMSStack* stack, GLMSAST* out) {
-  GLMSAST result =
-      (GLMSAST){.type = GLMS_AST_TYPE_MAT4, .as.m4 = glms_mat4_identity()};
-  *out = result;
-
-  return 1;
-}
-
-int glms_fptr_transpose(GLMSEval* eval, GLMSAST* ast, GLMSASTBuffer* args,
-                        GLMSStack* stack, GLMSAST* out) {
-  GLMSAST result =
-      (GLMSAST){.type = GLMS_AST_TYPE_MAT4,
-                .as.m4 = glms_mat4_transpose(args->items[0].as.m4)};
-  *out = result;
-
-  glms_env_apply_type(eval->env, eval, stack, out);
-  return 1;
-}
-
-int glms_fptr_inverse(GLMSEval* eval, GLMSAST* ast, GLMSASTBuffer* args,
-                      GLMSStack* stack, GLMSAST* out) {
-  GLMSAST result = (GLMSAST){.type = GLMS_AST_TYPE_MAT4,
-                             .as.m4 = glms_mat4_inv(args->items[0].as.m4)};
-  *out = result;
-
-  return 1;
-}
-
-int glms_fptr_radians(GLMSEval* eval, GLMSAST* ast, GLMSASTBuffer* args,
-                      GLMSStack* stack, GLMSAST* out) {
-  float v = glms_ast_number(args->items[0]);
-
-  GLMSAST result =
-      (GLMSAST){.type = GLMS_AST_TYPE_NUMBER, .as.number.value = glm_rad(v)};
-  *out = result;
-
-  return 1;
-}
-
 int glms_fptr_smoothstep(GLMSEval* eval, GLMSAST* ast, GLMSASTBuffer* args,
                          GLMSStack* stack, GLMSAST* out) {
   GLMSAST arg0 = args->items[0];
@@ -570,36 +402,6 @@ int glms_fptr_trace(GLMSEval* eval, GLMSAST* ast, GLMSASTBuffer* args,
   return 0;
 }
 
-int glms_fptr_quat_for(GLMSEval* eval, GLMSAST* ast, GLMSASTBuffer* args,
-                       GLMSStack* stack, GLMSAST* out) {
-  Vector3 dir = args->items[0].as.v3;
-  Vector3 up = args->items[1].as.v3;
-  versors q =
-      glms_quat_for((vec3s){dir.x, dir.y, dir.z}, (vec3s){up.x, up.y, up.z});
-
-  GLMSAST result =
-      (GLMSAST){.type = GLMS_AST_TYPE_VEC4,
-                .as.v4 = VEC4(q.raw[0], q.raw[1], q.raw[2], q.raw[3])};
-  *out = result;
-
-  glms_env_apply_type(eval->env, eval, stack, out);
-  return 1;
-}
-
-int glms_fptr_cantor(GLMSEval* eval, GLMSAST* ast, GLMSASTBuffer* args,
-                     GLMSStack* stack, GLMSAST* out) {
-  if (args->length <= 0) return 0;
-
-  float x = glms_ast_number(args->items[0]);
-  float y = glms_ast_number(args->items[1]);
-
-  int c = mif_cantor((int)x, (int)y);
-
-  *out = (GLMSAST){.type = GLMS_AST_TYPE_NUMBER, .as.number.value = (float)c};
-
-  return 1;
-}
-
 int glms_fptr_decant(GLMSEval* eval, GLMSAST* ast, GLMSASTBuffer* args,
                      GLMSStack* stack, GLMSAST* out) {
   if (args->length <= 0) return 0;
@@ -622,6 +424,90 @@ int glms_fptr_decant(GLMSEval* eval, GLMSAST* ast, GLMSASTBuffer* args,
   return 1;
 }
 
+typedef struct {
+  GLMSAST func;
+  int64_t start;
+  int64_t end;
+  int64_t grain;
+} GLMSParallelFor;
+
+static int glms_parallel_for_task(GLMSEval* eval, GLMSStack* stack,
+                                  int64_t task, void* user_ptr) {
+  GLMSParallelFor* loop = (GLMSParallelFor*)user_ptr;
+  int64_t begin = loop->start + task * loop->grain;
+  int64_t end = MIN(begin + loop->grain, loop->end);
+
+  for (int64_t i = begin; i < end; i++) {
+    GLMSASTBuffer call_args = (GLMSASTBuffer){
+        .initialized = true,
+        .items = (GLMSAST[]){(GLMSAST){.type = GLMS_AST_TYPE_NUMBER,
+                                       .as.number.value = (float)i}},
+        .length = 1};
+
+    glms_eval_call_func(eval, stack, &loop->func, call_args);
+  }
+
+  return 1;
+}
+
+// parallelFor(start, end, func, grain?, threads?)
+int glms_fptr_parallel_for(GLMSEval* eval, GLMSAST* ast, GLMSASTBuffer* args,
+                           GLMSStack* stack, GLMSAST* out) {
+  if (!args || args->length < 3)
+    GLMS_ERROR_RETURN(0, stderr, "Expected at least 3 arguments.\n");
+
+  GLMSAST* ptr = glms_ast_get_ptr(args->items[2]);
+  GLMSParallelFor loop = {
+      .func = ptr ? *ptr : args->items[2],
+      .start = (int64_t)glms_ast_number(args->items[0]),
+      .end = (int64_t)glms_ast_number(args->items[1])};
+
+  if (loop.func.type != GLMS_AST_TYPE_FUNC)
+    GLMS_ERROR_RETURN(0, stderr, "Expected `%s` at arg `2` but got `%s`.\n",
+                      GLMS_AST_TYPE_STR[GLMS_AST_TYPE_FUNC],
+                      GLMS_AST_TYPE_STR[loop.func.type]);
+
+  int64_t threads = args->length > 4 ? glms_ast_number(args->items[4]) : 0;
+  int64_t length = MAX(loop.end - loop.start, 0);
+
+  threads = glms_parallel_get_threads(threads);
+  loop.grain = args->length > 3 ? glms_ast_number(args->items[3]) : 0;
+
+  // by default every thread gets a few tasks to steal from.
+  if (loop.grain <= 0)
+    loop.grain = MAX((length + threads * 8 - 1) / (threads * 8), 1);
+
+  int ok = glms_parallel_run(eval, stack, threads,
+                             (length + loop.grain - 1) / loop.grain,
+                             glms_parallel_for_task, 0, &loop);
+
+  *out = (GLMSAST){.type = GLMS_AST_TYPE_BOOL, .as.boolean = ok};
+
+  return 1;
+}
+
+int glms_fptr_parallel_stats(GLMSEval* eval, GLMSAST* ast, GLMSASTBuffer* args,
+                             GLMSStack* stack, GLMSAST* out) {
+  GLMSParallelStats stats = {0};
+  glms_parallel_get_stats(&stats);
+
+  GLMSAST* obj = glms_env_new_ast(eval->env, GLMS_AST_TYPE_OBJECT, true);
+
+  glms_ast_object_set_property(
+      obj, "runs", glms_env_new_ast_number(eval->env, stats.runs, true));
+  glms_ast_object_set_property(
+      obj, "tasks", glms_env_new_ast_number(eval->env, stats.tasks, true));
+  glms_ast_object_set_property(
+      obj, "steals", glms_env_new_ast_number(eval->env, stats.steals, true));
+  glms_ast_object_set_property(
+      obj, "idle",
+      glms_env_new_ast_number(eval->env, stats.idle_usec / 1000.0f, true));
+
+  *out = (GLMSAST){.type = GLMS_AST_TYPE_STACK_PTR, .as.stackptr.ptr = obj};
+
+  return 1;
+}
+
 int glms_fptr_exit(GLMSEval* eval, GLMSAST* ast, GLMSASTBuffer* args,
                    GLMSStack* stack, GLMSAST* out) {
   int x = args != 0 && args->length > 0 ? glms_ast_number(args->items[0]) : 0;
@@ -631,10 +517,180 @@ int glms_fptr_exit(GLMSEval* eval, GLMSAST* ast, GLMSASTBuffer* args,
   return 1;
 }
 
+static GLMSEnv glms_builtin_prototype = {0};
+
+#define GLMS_BUILTIN_MODULE_NAMES_CAPACITY 4
+
+typedef struct {
+  const char* names[GLMS_BUILTIN_MODULE_NAMES_CAPACITY];
+  GLMSExtensionEntryFunc init;
+  // set under glms_builtin_modules_lock while `init` runs.
+  bool loading;
+  // set once every name of the module is registered.
+  bool loaded;
+} GLMSBuiltinModule;
+
+// modules pulling in large dependencies are registered into the
+// prototype the first time one of their names is looked up.
+static GLMSBuiltinModule glms_builtin_modules[] = {
+    {{"image"}, glms_struct_image},
+    {{"file"}, glms_file_type},
+    {{"fetch", "response", "fetchAsync", "fetchAll"}, glms_fetch},
+    {{"json"}, glms_json}};
+
+#define GLMS_BUILTIN_MODULES_LENGTH \
+  (sizeof(glms_builtin_modules) / sizeof(glms_builtin_modules[0]))
+
+static int64_t glms_builtin_modules_pending = GLMS_BUILTIN_MODULES_LENGTH;
+
+static pthread_once_t glms_builtin_prototype_once = PTHREAD_ONCE_INIT;
+
+// recursive, since a module may look up (and load) another one.
+static pthread_mutex_t glms_builtin_modules_lock;
+static pthread_once_t glms_builtin_modules_lock_once = PTHREAD_ONCE_INIT;
+
+// held for writing while a module registers into the prototype's maps,
+// and for reading by lookups on other threads, see glms_builtin_lock_lookup.
+static pthread_rwlock_t glms_builtin_maps_lock = PTHREAD_RWLOCK_INITIALIZER;
+
+// how many modules this thread is registering, whose `init`
+// may look up names while the maps are held for writing.
+static __thread int64_t glms_builtin_loading = 0;
+
+static void glms_builtin_init_modules_lock() {
+  pthread_mutexattr_t attr;
+  pthread_mutexattr_init(&attr);
+  pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+  pthread_mutex_init(&glms_builtin_modules_lock, &attr);
+  pthread_mutexattr_destroy(&attr);
+}
+
+// also reached while the prototype itself is being built,
+// so it must not wait for glms_builtin_get_prototype.
+static void glms_builtin_lock_modules() {
+  pthread_once(&glms_builtin_modules_lock_once, glms_builtin_init_modules_lock);
+  pthread_mutex_lock(&glms_builtin_modules_lock);
+}
+
+bool glms_builtin_lock_lookup() {
+  if (glms_builtin_loading > 0) return false;
+  if (__atomic_load_n(&glms_builtin_modules_pending, __ATOMIC_ACQUIRE) <= 0)
+    return false;
+
+  pthread_rwlock_rdlock(&glms_builtin_maps_lock);
+
+  return true;
+}
+
+void glms_builtin_unlock_lookup(bool locked) {
+  if (locked) pthread_rwlock_unlock(&glms_builtin_maps_lock);
+}
+
+static void glms_builtin_load(GLMSBuiltinModule* module) {
+  glms_builtin_lock_modules();
+
+  if (!module->loaded && !module->loading) {
+    module->loading = true;
+
+    bool outer = glms_builtin_loading++ == 0;
+    if (outer) pthread_rwlock_wrlock(&glms_builtin_maps_lock);
+
+    // the prototype stays frozen for the threads reading it,
+    // only the new nodes are typed here.
+    GLMSEnv* prototype = &glms_builtin_prototype;
+    module->init(prototype);
+    glms_env_freeze(prototype);
+
+    if (outer) pthread_rwlock_unlock(&glms_builtin_maps_lock);
+    glms_builtin_loading--;
+
+    // only now can a lookup that missed find the module's names.
+    __atomic_store_n(&module->loaded, true, __ATOMIC_RELEASE);
+    __atomic_sub_fetch(&glms_builtin_modules_pending, 1, __ATOMIC_RELEASE);
+  }
+
+  pthread_mutex_unlock(&glms_builtin_modules_lock);
+}
+
+int glms_builtin_load_module(const char* name) {
+  if (!name) return 0;
+  if (__atomic_load_n(&glms_builtin_modules_pending, __ATOMIC_ACQUIRE) <= 0)
+    return 0;
+
+  for (int64_t i = 0; i < GLMS_BUILTIN_MODULES_LENGTH; i++) {
+    GLMSBuiltinModule* module = &glms_builtin_modules[i];
+
+    for (int j = 0; j < GLMS_BUILTIN_MODULE_NAMES_CAPACITY; j++) {
+      if (!module->names[j] || strcmp(module->names[j], name) != 0) continue;
+
+      // the lookup that missed ran before the module was registered.
+      if (__atomic_load_n(&module->loaded, __ATOMIC_ACQUIRE)) return 0;
+
+      // waits for another thread registering the same module,
+      // so the lookup can be retried either way.
+      glms_builtin_load(module);
+
+      return __atomic_load_n(&module->loaded, __ATOMIC_ACQUIRE);
+    }
+  }
+
+  return 0;
+}
+
+void glms_builtin_load_modules() {
+  glms_builtin_get_prototype();
+
+  for (int64_t i = 0; i < GLMS_BUILTIN_MODULES_LENGTH; i++) {
+    glms_builtin_load(&glms_builtin_modules[i]);
+  }
+}
+
+static void glms_builtin_init_prototype() {
+  glms_env_init(&glms_builtin_prototype, 0, 0, (GLMSConfig){0});
+  glms_builtin_init(&glms_builtin_prototype);
+  glms_env_freeze(&glms_builtin_prototype);
+}
+
+GLMSEnv* glms_builtin_get_prototype() {
+  pthread_once(&glms_builtin_prototype_once, glms_builtin_init_prototype);
+  return &glms_builtin_prototype;
+}
+
+bool glms_builtin_is_prototype(GLMSEnv* env) {
+  return env == &glms_builtin_prototype;
+}
+
+// registers `native` once for vec2, vec3 and vec4 arguments. An
+// undefined `return_type` returns a vector as wide as the arguments.
+static void glms_builtin_register_vector_native(GLMSEnv* env, const char* name,
+                                                int args_length,
+                                                GLMSASTType return_type,
+                                                GLMSNativeFunc native) {
+  GLMSASTType widths[] = {GLMS_AST_TYPE_VEC3, GLMS_AST_TYPE_VEC2,
+                          GLMS_AST_TYPE_VEC4};
+  GLMSType args[GLMS_NATIVE_ARGS_CAP];
+
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < args_length; j++) args[j] = (GLMSType){widths[i]};
+
+    GLMSFunctionSignature signature = {
+        .return_type = (GLMSType){return_type == GLMS_AST_TYPE_UNDEFINED
+                                      ? widths[i]
+                                      : return_type},
+        .args = args,
+        .args_length = args_length};
+
+    if (i == 0) {
+      glms_env_register_native(env, name, signature, native);
+    } else {
+      glms_env_register_function_signature(env, 0, name, signature);
+    }
+  }
+}
+
 void glms_builtin_init(GLMSEnv* env) {
   if (env->has_builtins) return;
   env->has_builtins = true;
-  srand(time(0));
 
   glms_env_register_any(env, "PI", glms_env_new_ast_number(env, M_PI, true));
   glms_env_register_any(env, "TAU",
@@ -644,15 +700,14 @@ void glms_builtin_init(GLMSEnv* env) {
   glms_env_register_function(env, "trace", glms_fptr_trace);
   glms_env_register_function(env, "exit", glms_fptr_exit);
   glms_env_register_function(env, "quit", glms_fptr_exit);
-  glms_env_register_function(env, "quatFor", glms_fptr_quat_for);
-  glms_env_register_function(env, "cantor", glms_fptr_cantor);
-  glms_env_register_function_signature(
-      env, 0, "cantor",
+  glms_env_register_native(
+      env, "cantor",
       (GLMSFunctionSignature){
           .return_type = (GLMSType){GLMS_AST_TYPE_NUMBER},
           .args = (GLMSType[]){(GLMSType){GLMS_AST_TYPE_NUMBER},
                                (GLMSType){GLMS_AST_TYPE_NUMBER}},
-          .args_length = 2});
+          .args_length = 2},
+      glms_native_cantor);
 
   glms_env_register_function(env, "decant", glms_fptr_decant);
   glms_env_register_function_signature(
@@ -662,14 +717,15 @@ void glms_builtin_init(GLMSEnv* env) {
           .args = (GLMSType[]){(GLMSType){GLMS_AST_TYPE_NUMBER}},
           .args_length = 1});
 
-  glms_env_register_function_signature(
-      env, 0, "quatFor",
+  glms_env_register_native(
+      env, "quatFor",
       (GLMSFunctionSignature){
           .return_type = (GLMSType){GLMS_AST_TYPE_VEC4},
           .args =
-              (GLMSType[]){(GLMSType){GLMS_AST_TYPE_VEC4, .valuename = "dir"},
-                           (GLMSType){GLMS_AST_TYPE_VEC4, .valuename = "up"}},
-          .args_length = 2});
+              (GLMSType[]){(GLMSType){GLMS_AST_TYPE_VEC3, .valuename = "dir"},
+                           (GLMSType){GLMS_AST_TYPE_VEC3, .valuename = "up"}},
+          .args_length = 2},
+      glms_native_quat_for);
 
   glms_env_register_function(env, "smoothstep", glms_fptr_smoothstep);
   glms_env_register_function_signature(
@@ -703,39 +759,38 @@ void glms_builtin_init(GLMSEnv* env) {
                   (GLMSType){GLMS_AST_TYPE_VEC3, .valuename = "value"}},
           .args_length = 3});
 
-  glms_env_register_function(env, "radians", glms_fptr_radians);
-  glms_env_register_function_signature(
-      env, 0, "radians",
+  glms_env_register_native(
+      env, "radians",
       (GLMSFunctionSignature){
           .return_type = (GLMSType){GLMS_AST_TYPE_NUMBER},
           .args = (GLMSType[]){(GLMSType){GLMS_AST_TYPE_NUMBER}},
-          .args_length = 1});
+          .args_length = 1},
+      glms_native_radians);
 
-  glms_env_register_function(env, "identity", glms_fptr_identity);
-  glms_env_register_function_signature(
-      env, 0, "identity",
+  glms_env_register_native(
+      env, "identity",
       (GLMSFunctionSignature){.return_type = (GLMSType){GLMS_AST_TYPE_MAT4},
-                              .args_length = 0});
+                              .args_length = 0},
+      glms_native_identity);
 
-  glms_env_register_function(env, "transpose", glms_fptr_identity);
-  glms_env_register_function_signature(
-      env, 0, "transpose",
+  glms_env_register_native(
+      env, "transpose",
       (GLMSFunctionSignature){
           .return_type = (GLMSType){GLMS_AST_TYPE_MAT4},
           .args = (GLMSType[]){(GLMSType){GLMS_AST_TYPE_MAT4}},
-          .args_length = 1});
+          .args_length = 1},
+      glms_native_transpose);
 
-  glms_env_register_function(env, "inverse", glms_fptr_identity);
-  glms_env_register_function_signature(
-      env, 0, "inverse",
+  glms_env_register_native(
+      env, "inverse",
       (GLMSFunctionSignature){
           .return_type = (GLMSType){GLMS_AST_TYPE_MAT4},
           .args = (GLMSType[]){(GLMSType){GLMS_AST_TYPE_MAT4}},
-          .args_length = 1});
+          .args_length = 1},
+      glms_native_inverse);
 
-  glms_env_register_function(env, "ortho", glms_fptr_ortho);
-  glms_env_register_function_signature(
-      env, 0, "ortho",
+  glms_env_register_native(
+      env, "ortho",
       (GLMSFunctionSignature){
           .return_type = (GLMSType){GLMS_AST_TYPE_MAT4},
           .args =
@@ -746,11 +801,11 @@ void glms_builtin_init(GLMSEnv* env) {
                   (GLMSType){GLMS_AST_TYPE_NUMBER, .valuename = "top"},
                   (GLMSType){GLMS_AST_TYPE_NUMBER, .valuename = "near"},
                   (GLMSType){GLMS_AST_TYPE_NUMBER, .valuename = "far"}},
-          .args_length = 6});
+          .args_length = 6},
+      glms_native_ortho);
 
-  glms_env_register_function(env, "perspective", glms_fptr_perspective);
-  glms_env_register_function_signature(
-      env, 0, "perspective",
+  glms_env_register_native(
+      env, "perspective",
       (GLMSFunctionSignature){
           .return_type = (GLMSType){GLMS_AST_TYPE_MAT4},
           .args =
@@ -759,50 +814,20 @@ void glms_builtin_init(GLMSEnv* env) {
                   (GLMSType){GLMS_AST_TYPE_NUMBER, .valuename = "aspect"},
                   (GLMSType){GLMS_AST_TYPE_NUMBER, .valuename = "near"},
                   (GLMSType){GLMS_AST_TYPE_NUMBER, .valuename = "far"}},
-          .args_length = 4});
-
-  glms_env_register_function(env, "dot", glms_fptr_dot);
-  glms_env_register_function_signature(
-      env, 0, "dot",
-      (GLMSFunctionSignature){
-          .return_type = (GLMSType){GLMS_AST_TYPE_NUMBER},
-          .args = (GLMSType[]){(GLMSType){GLMS_AST_TYPE_VEC3},
-                               (GLMSType){GLMS_AST_TYPE_VEC3}},
-          .args_length = 2});
-
-  glms_env_register_function(env, "distance", glms_fptr_distance);
-  glms_env_register_function_signature(
-      env, 0, "distance",
-      (GLMSFunctionSignature){
-          .return_type = (GLMSType){GLMS_AST_TYPE_NUMBER},
-          .args = (GLMSType[]){(GLMSType){GLMS_AST_TYPE_VEC3},
-                               (GLMSType){GLMS_AST_TYPE_VEC3}},
-          .args_length = 2});
-
-  glms_env_register_function(env, "cross", glms_fptr_cross);
-  glms_env_register_function_signature(
-      env, 0, "cross",
-      (GLMSFunctionSignature){
-          .return_type = (GLMSType){GLMS_AST_TYPE_VEC3},
-          .args = (GLMSType[]){(GLMSType){GLMS_AST_TYPE_VEC3},
-                               (GLMSType){GLMS_AST_TYPE_VEC3}},
-          .args_length = 2});
-
-  glms_env_register_function(env, "normalize", glms_fptr_normalize);
-  glms_env_register_function_signature(
-      env, 0, "normalize",
-      (GLMSFunctionSignature){
-          .return_type = (GLMSType){GLMS_AST_TYPE_VEC3},
-          .args = (GLMSType[]){(GLMSType){GLMS_AST_TYPE_VEC3}},
-          .args_length = 1});
-
-  glms_env_register_function(env, "unit", glms_fptr_normalize);
-  glms_env_register_function_signature(
-      env, 0, "unit",
-      (GLMSFunctionSignature){
-          .return_type = (GLMSType){GLMS_AST_TYPE_VEC3},
-          .args = (GLMSType[]){(GLMSType){GLMS_AST_TYPE_VEC3}},
-          .args_length = 1});
+          .args_length = 4},
+      glms_native_perspective);
+
+  glms_builtin_register_vector_native(env, "dot", 2, GLMS_AST_TYPE_NUMBER,
+                                      glms_native_dot);
+  glms_builtin_register_vector_native(env, "distance", 2, GLMS_AST_TYPE_NUMBER,
+                                      glms_native_distance);
+  glms_builtin_register_vector_native(env, "cross", 2, GLMS_AST_TYPE_VEC3,
+                                      glms_native_cross);
+  glms_builtin_register_vector_native(env, "normalize", 1,
+                                      GLMS_AST_TYPE_UNDEFINED,
+                                      glms_native_normalize);
+  glms_builtin_register_vector_native(env, "unit", 1, GLMS_AST_TYPE_UNDEFINED,
+                                      glms_native_normalize);
 
   glms_env_register_function(env, "length", glms_fptr_length);
   glms_env_register_function_signature(
@@ -824,69 +849,69 @@ void glms_builtin_init(GLMSEnv* env) {
           .args = (GLMSType[]){(GLMSType){GLMS_AST_TYPE_ARRAY}},
           .args_length = 1});
 
-  glms_env_register_function(env, "cos", glms_fptr_cos);
-  glms_env_register_function_signature(
-      env, 0, "cos",
+  glms_env_register_native(
+      env, "cos",
       (GLMSFunctionSignature){
           .return_type = (GLMSType){GLMS_AST_TYPE_NUMBER},
           .args = (GLMSType[]){(GLMSType){GLMS_AST_TYPE_NUMBER}},
-          .args_length = 1});
+          .args_length = 1},
+      glms_native_cos);
 
-  glms_env_register_function(env, "sin", glms_fptr_sin);
-  glms_env_register_function_signature(
-      env, 0, "sin",
+  glms_env_register_native(
+      env, "sin",
       (GLMSFunctionSignature){
           .return_type = (GLMSType){GLMS_AST_TYPE_NUMBER},
           .args = (GLMSType[]){(GLMSType){GLMS_AST_TYPE_NUMBER}},
-          .args_length = 1});
+          .args_length = 1},
+      glms_native_sin);
 
-  glms_env_register_function(env, "tan", glms_fptr_tan);
-  glms_env_register_function_signature(
-      env, 0, "tan",
+  glms_env_register_native(
+      env, "tan",
       (GLMSFunctionSignature){
           .return_type = (GLMSType){GLMS_AST_TYPE_NUMBER},
           .args = (GLMSType[]){(GLMSType){GLMS_AST_TYPE_NUMBER}},
-          .args_length = 1});
+          .args_length = 1},
+      glms_native_tan);
 
-  glms_env_register_function(env, "fract", glms_fptr_fract);
-  glms_env_register_function_signature(
-      env, 0, "fract",
+  glms_env_register_native(
+      env, "fract",
       (GLMSFunctionSignature){
           .return_type = (GLMSType){GLMS_AST_TYPE_NUMBER},
           .args = (GLMSType[]){(GLMSType){GLMS_AST_TYPE_NUMBER}},
-          .args_length = 1});
+          .args_length = 1},
+      glms_native_fract);
 
-  glms_env_register_function(env, "abs", glms_fptr_abs);
-  glms_env_register_function_signature(
-      env, 0, "abs",
+  glms_env_register_native(
+      env, "abs",
       (GLMSFunctionSignature){
           .return_type = (GLMSType){GLMS_AST_TYPE_NUMBER},
           .args = (GLMSType[]){(GLMSType){GLMS_AST_TYPE_NUMBER}},
-          .args_length = 1});
+          .args_length = 1},
+      glms_native_abs);
 
-  glms_env_register_function(env, "floor", glms_fptr_floor);
-  glms_env_register_function_signature(
-      env, 0, "floor",
+  glms_env_register_native(
+      env, "floor",
       (GLMSFunctionSignature){
           .return_type = (GLMSType){GLMS_AST_TYPE_NUMBER},
           .args = (GLMSType[]){(GLMSType){GLMS_AST_TYPE_NUMBER}},
-          .args_length = 1});
+          .args_length = 1},
+      glms_native_floor);
 
-  glms_env_register_function(env, "ceil", glms_fptr_ceil);
-  glms_env_register_function_signature(
-      env, 0, "ceil",
+  glms_env_register_native(
+      env, "ceil",
       (GLMSFunctionSignature){
           .return_type = (GLMSType){GLMS_AST_TYPE_NUMBER},
           .args = (GLMSType[]){(GLMSType){GLMS_AST_TYPE_NUMBER}},
-          .args_length = 1});
+          .args_length = 1},
+      glms_native_ceil);
 
-  glms_env_register_function(env, "round", glms_fptr_round);
-  glms_env_register_function_signature(
-      env, 0, "round",
+  glms_env_register_native(
+      env, "round",
       (GLMSFunctionSignature){
           .return_type = (GLMSType){GLMS_AST_TYPE_NUMBER},
           .args = (GLMSType[]){(GLMSType){GLMS_AST_TYPE_NUMBER}},
-          .args_length = 1});
+          .args_length = 1},
+      glms_native_round);
 
   glms_env_register_function(env, "atan", glms_fptr_atan);
   glms_env_register_function_signature(
@@ -903,9 +928,8 @@ void glms_builtin_init(GLMSEnv* env) {
                                (GLMSType){GLMS_AST_TYPE_NUMBER}},
           .args_length = 2});
 
-  glms_env_register_function(env, "lerp", glms_fptr_lerp);
-  glms_env_register_function_signature(
-      env, 0, "lerp",
+  glms_env_register_native(
+      env, "lerp",
       (GLMSFunctionSignature){
           .return_type = (GLMSType){GLMS_AST_TYPE_NUMBER},
           .args =
@@ -913,7 +937,8 @@ void glms_builtin_init(GLMSEnv* env) {
                   (GLMSType){GLMS_AST_TYPE_NUMBER, .valuename = "from"},
                   (GLMSType){GLMS_AST_TYPE_NUMBER, .valuename = "to"},
                   (GLMSType){GLMS_AST_TYPE_NUMBER, .valuename = "scale"}},
-          .args_length = 3});
+          .args_length = 3},
+      glms_native_lerp);
   glms_env_register_function_signature(
       env, 0, "lerp",
       (GLMSFunctionSignature){
@@ -925,9 +950,8 @@ void glms_builtin_init(GLMSEnv* env) {
                   (GLMSType){GLMS_AST_TYPE_NUMBER, .valuename = "scale"}},
           .args_length = 3});
 
-  glms_env_register_function(env, "mix", glms_fptr_lerp);
-  glms_env_register_function_signature(
-      env, 0, "mix",
+  glms_env_register_native(
+      env, "mix",
       (GLMSFunctionSignature){
           .return_type = (GLMSType){GLMS_AST_TYPE_NUMBER},
           .args =
@@ -935,7 +959,8 @@ void glms_builtin_init(GLMSEnv* env) {
                   (GLMSType){GLMS_AST_TYPE_NUMBER, .valuename = "from"},
                   (GLMSType){GLMS_AST_TYPE_NUMBER, .valuename = "to"},
                   (GLMSType){GLMS_AST_TYPE_NUMBER, .valuename = "scale"}},
-          .args_length = 3});
+          .args_length = 3},
+      glms_native_lerp);
   glms_env_register_function_signature(
       env, 0, "mix",
       (GLMSFunctionSignature){
@@ -947,9 +972,8 @@ void glms_builtin_init(GLMSEnv* env) {
                   (GLMSType){GLMS_AST_TYPE_NUMBER, .valuename = "scale"}},
           .args_length = 3});
 
-  glms_env_register_function(env, "clamp", glms_fptr_clamp);
-  glms_env_register_function_signature(
-      env, 0, "clamp",
+  glms_env_register_native(
+      env, "clamp",
       (GLMSFunctionSignature){
           .return_type = (GLMSType){GLMS_AST_TYPE_NUMBER},
           .args =
@@ -957,7 +981,8 @@ void glms_builtin_init(GLMSEnv* env) {
                   (GLMSType){GLMS_AST_TYPE_NUMBER, .valuename = "value"},
                   (GLMSType){GLMS_AST_TYPE_NUMBER, .valuename = "min"},
                   (GLMSType){GLMS_AST_TYPE_NUMBER, .valuename = "max"}},
-          .args_length = 3});
+          .args_length = 3},
+      glms_native_clamp);
 
   glms_env_register_function(env, "min", glms_fptr_min);
   glms_env_register_function_signature(
@@ -977,30 +1002,55 @@ void glms_builtin_init(GLMSEnv* env) {
                                (GLMSType){GLMS_AST_TYPE_NUMBER}},
           .args_length = 2});
 
-  glms_env_register_function(env, "pow", glms_fptr_pow);
-  glms_env_register_function_signature(
-      env, 0, "pow",
+  glms_env_register_native(
+      env, "pow",
       (GLMSFunctionSignature){
           .return_type = (GLMSType){GLMS_AST_TYPE_NUMBER},
           .args = (GLMSType[]){(GLMSType){GLMS_AST_TYPE_NUMBER},
                                (GLMSType){GLMS_AST_TYPE_NUMBER}},
-          .args_length = 2});
+          .args_length = 2},
+      glms_native_pow);
 
-  glms_env_register_function(env, "log", glms_fptr_log);
-  glms_env_register_function_signature(
-      env, 0, "log",
+  glms_env_register_native(
+      env, "log",
       (GLMSFunctionSignature){
           .return_type = (GLMSType){GLMS_AST_TYPE_NUMBER},
           .args = (GLMSType[]){(GLMSType){GLMS_AST_TYPE_NUMBER}},
-          .args_length = 1});
+          .args_length = 1},
+      glms_native_log);
 
-  glms_env_register_function(env, "log10", glms_fptr_log10);
-  glms_env_register_function_signature(
-      env, 0, "log10",
+  glms_env_register_native(
+      env, "log10",
       (GLMSFunctionSignature){
           .return_type = (GLMSType){GLMS_AST_TYPE_NUMBER},
           .args = (GLMSType[]){(GLMSType){GLMS_AST_TYPE_NUMBER}},
-          .args_length = 1});
+          .args_length = 1},
+      glms_native_log10);
+
+  glms_env_register_function(env, "parallelFor", glms_fptr_parallel_for);
+  glms_env_register_function_signature(
+      env, 0, "parallelFor",
+      (GLMSFunctionSignature){
+          .return_type = (GLMSType){GLMS_AST_TYPE_BOOL},
+          .args =
+              (GLMSType[]){
+                  (GLMSType){GLMS_AST_TYPE_NUMBER, .valuename = "start"},
+                  (GLMSType){GLMS_AST_TYPE_NUMBER, .valuename = "end"},
+                  (GLMSType){GLMS_AST_TYPE_FUNC},
+                  (GLMSType){GLMS_AST_TYPE_NUMBER, .valuename = "grain"},
+                  (GLMSType){GLMS_AST_TYPE_NUMBER, .valuename = "threads"}},
+          .args_length = 5,
+          .description = "Calls func(i) for every i in [start, end) on several "
+                         "threads."});
+
+  glms_env_register_function(env, "parallelStats", glms_fptr_parallel_stats);
+  glms_env_register_function_signature(
+      env, 0, "parallelStats",
+      (GLMSFunctionSignature){
+          .return_type = (GLMSType){GLMS_AST_TYPE_OBJECT},
+          .args_length = 0,
+          .description = "Returns runs, tasks, steals and idle (ms) of "
+                         "every parallel call so far."});
 
   glms_env_register_function(env, "random", glms_fptr_random);
   glms_env_register_function_signature(
@@ -1031,14 +1081,19 @@ void glms_builtin_init(GLMSEnv* env) {
 
   glms_string_type(env);
   glms_array_type(env);
+  glms_typed_array_type(env);
   glms_iterator_type(env);
   glms_struct_vec2(env);
   glms_struct_vec3(env);
   glms_struct_vec4(env);
   glms_mat4_type(env);
   glms_mat3_type(env);
-  glms_struct_image(env);
-  glms_file_type(env);
-  glms_fetch(env);
-  glms_json(env);
+  glms_future_type(env);
+  glms_channel_type(env);
+
+  if (env == &glms_builtin_prototype) return;
+
+  for (int64_t i = 0; i < GLMS_BUILTIN_MODULES_LENGTH; i++) {
+    glms_builtin_modules[i].init(env);
+  }
 }
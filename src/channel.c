@@ -0,0 +1,335 @@
+#include <glms/ast.h>
+#include <glms/channel.h>
+#include <glms/macros.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// A value taken out of its env, so it can be received by another one.
+typedef struct GLMS_CHANNEL_VALUE_STRUCT {
+  // the type, and `as` for values that are sent as they are.
+  GLMSAST ast;
+  char *string;
+  // the elements of an array, or the values of an object.
+  struct GLMS_CHANNEL_VALUE_STRUCT **items;
+  char **keys;
+  int64_t length;
+} GLMSChannelValue;
+
+// A cell is free to send into once its sequence equals the position
+// of the sender, and holds a value once it is that position + 1.
+typedef struct {
+  int64_t sequence;
+  GLMSChannelValue *value;
+} GLMSChannelCell;
+
+struct GLMS_CHANNEL_STRUCT {
+  GLMSChannelCell *cells;
+  int64_t capacity;
+  // positions of the next send and receive, they only grow.
+  int64_t send_pos;
+  int64_t recv_pos;
+  bool closed;
+  int64_t refs;
+};
+
+static void glms_channel_value_free(GLMSChannelValue *value) {
+  if (!value) return;
+
+  for (int64_t i = 0; i < value->length; i++) {
+    glms_channel_value_free(value->items[i]);
+    if (value->keys) free(value->keys[i]);
+  }
+
+  if (value->items) free(value->items);
+  if (value->keys) free(value->keys);
+  if (value->string) free(value->string);
+  free(value);
+}
+
+static GLMSChannelValue *glms_channel_value_new(GLMSAST ast) {
+  GLMSAST *ptr = glms_ast_get_ptr(ast);
+  if (ptr) ast = *ptr;
+
+  GLMSChannelValue *value = NEW(GLMSChannelValue);
+  if (!value) GLMS_WARNING_RETURN(0, stderr, "Could not allocate value.\n");
+
+  value->ast = (GLMSAST){.type = ast.type};
+
+  switch (ast.type) {
+    case GLMS_AST_TYPE_NULL: break;
+    case GLMS_AST_TYPE_NUMBER:
+    case GLMS_AST_TYPE_BOOL:
+    case GLMS_AST_TYPE_VEC2:
+    case GLMS_AST_TYPE_VEC3:
+    case GLMS_AST_TYPE_VEC4:
+    case GLMS_AST_TYPE_MAT3:
+    case GLMS_AST_TYPE_MAT4:
+    case GLMS_AST_TYPE_TYPED_ARRAY: {
+      value->ast.as = ast.as;
+    }; break;
+    case GLMS_AST_TYPE_STRING: {
+      const char *str = glms_ast_get_string_value(&ast);
+      value->string = strdup(str ? str : "");
+    }; break;
+    case GLMS_AST_TYPE_ARRAY: {
+      int64_t length = ast.children ? ast.children->length : 0;
+      value->items = (GLMSChannelValue **)calloc(MAX(length, 1),
+                                                 sizeof(GLMSChannelValue *));
+
+      for (int64_t i = 0; i < length; i++) {
+        value->items[i] = glms_channel_value_new(*ast.children->items[i]);
+        value->length++;
+        if (!value->items[i]) goto fail;
+      }
+    }; break;
+    case GLMS_AST_TYPE_OBJECT: {
+      if (ast.json != 0) {
+        GLMS_WARNING(stderr, "Objects parsed from json can not be sent.\n");
+        goto fail;
+      }
+
+      int64_t length = glms_ast_count_props(&ast);
+      value->items = (GLMSChannelValue **)calloc(MAX(length, 1),
+                                                 sizeof(GLMSChannelValue *));
+      value->keys = (char **)calloc(MAX(length, 1), sizeof(char *));
+
+      GLMSASTPropIterator it = {0};
+
+      while (value->length < length && glms_ast_iterate_props(&ast, &it)) {
+        int64_t i = value->length++;
+        value->keys[i] = strdup(it.key);
+        value->items[i] = glms_channel_value_new(*it.value);
+        if (!value->items[i]) goto fail;
+      }
+    }; break;
+    default: {
+      GLMS_WARNING(stderr, "`%s` can not be sent.\n",
+                   GLMS_AST_TYPE_STR[ast.type]);
+      goto fail;
+    }; break;
+  }
+
+  return value;
+
+fail:
+  glms_channel_value_free(value);
+  return 0;
+}
+
+// strings are moved into the new nodes, `value` is left empty.
+static GLMSAST *glms_channel_value_take(GLMSChannelValue *value,
+                                        GLMSEnv *env) {
+  switch (value->ast.type) {
+    case GLMS_AST_TYPE_STRING: {
+      GLMSAST *ast = glms_env_new_ast(env, GLMS_AST_TYPE_STRING, true);
+      ast->as.string.heap = value->string;
+      value->string = 0;
+      return ast;
+    }; break;
+    case GLMS_AST_TYPE_TYPED_ARRAY: {
+      return glms_env_new_ast_typed_array(
+          env, value->ast.as.typed_array.element_type,
+          value->ast.as.typed_array.data, value->ast.as.typed_array.length,
+          value->ast.as.typed_array.stride, value->ast.as.typed_array.writable);
+    }; break;
+    case GLMS_AST_TYPE_ARRAY: {
+      GLMSAST *ast = glms_env_new_ast(env, GLMS_AST_TYPE_ARRAY, true);
+
+      for (int64_t i = 0; i < value->length; i++) {
+        glms_ast_push(ast, glms_channel_value_take(value->items[i], env));
+      }
+
+      return ast;
+    }; break;
+    case GLMS_AST_TYPE_OBJECT: {
+      GLMSAST *ast = glms_env_new_ast(env, GLMS_AST_TYPE_OBJECT, true);
+
+      for (int64_t i = 0; i < value->length; i++) {
+        glms_ast_object_set_property(
+            ast, value->keys[i], glms_channel_value_take(value->items[i], env));
+      }
+
+      return ast;
+    }; break;
+    default: {
+      GLMSAST *ast = glms_env_new_ast(env, value->ast.type, true);
+      ast->as = value->ast.as;
+      // vectors and matrices get their methods and operators.
+      glms_env_apply_type(env, &env->eval, &env->stack, ast);
+      return ast;
+    }; break;
+  }
+
+  return 0;
+}
+
+GLMSChannel *glms_channel_new(int64_t capacity) {
+  if (capacity <= 0) capacity = 1;
+
+  GLMSChannel *channel = NEW(GLMSChannel);
+  if (!channel) GLMS_WARNING_RETURN(0, stderr, "Could not allocate channel.\n");
+
+  channel->cells =
+      (GLMSChannelCell *)calloc(capacity, sizeof(GLMSChannelCell));
+  if (!channel->cells) {
+    free(channel);
+    GLMS_WARNING_RETURN(0, stderr, "Could not allocate channel.\n");
+  }
+
+  for (int64_t i = 0; i < capacity; i++) channel->cells[i].sequence = i;
+
+  channel->capacity = capacity;
+  channel->refs = 1;
+
+  return channel;
+}
+
+GLMSChannel *glms_channel_retain(GLMSChannel *channel) {
+  if (!channel) return 0;
+
+  __atomic_add_fetch(&channel->refs, 1, __ATOMIC_RELAXED);
+
+  return channel;
+}
+
+void glms_channel_release(GLMSChannel *channel) {
+  if (!channel) return;
+  if (__atomic_sub_fetch(&channel->refs, 1, __ATOMIC_ACQ_REL) > 0) return;
+
+  for (int64_t i = 0; i < channel->capacity; i++) {
+    glms_channel_value_free(channel->cells[i].value);
+  }
+
+  free(channel->cells);
+  free(channel);
+}
+
+static bool glms_channel_try_send(GLMSChannel *channel,
+                                  GLMSChannelValue *value) {
+  int64_t pos = __atomic_load_n(&channel->send_pos, __ATOMIC_RELAXED);
+
+  while (true) {
+    GLMSChannelCell *cell = &channel->cells[pos % channel->capacity];
+    int64_t sequence = __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE);
+    int64_t diff = sequence - pos;
+
+    if (diff < 0) return false;
+
+    if (diff == 0 &&
+        __atomic_compare_exchange_n(&channel->send_pos, &pos, pos + 1, true,
+                                    __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+      cell->value = value;
+      __atomic_store_n(&cell->sequence, pos + 1, __ATOMIC_RELEASE);
+      return true;
+    }
+
+    // a failed exchange has already loaded the new position.
+    if (diff > 0) pos = __atomic_load_n(&channel->send_pos, __ATOMIC_RELAXED);
+  }
+
+  return false;
+}
+
+static GLMSChannelValue *glms_channel_try_recv(GLMSChannel *channel) {
+  int64_t pos = __atomic_load_n(&channel->recv_pos, __ATOMIC_RELAXED);
+
+  while (true) {
+    GLMSChannelCell *cell = &channel->cells[pos % channel->capacity];
+    int64_t sequence = __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE);
+    int64_t diff = sequence - (pos + 1);
+
+    if (diff < 0) return 0;
+
+    if (diff == 0 &&
+        __atomic_compare_exchange_n(&channel->recv_pos, &pos, pos + 1, true,
+                                    __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+      GLMSChannelValue *value = cell->value;
+      cell->value = 0;
+      __atomic_store_n(&cell->sequence, pos + channel->capacity,
+                       __ATOMIC_RELEASE);
+      return value;
+    }
+
+    if (diff > 0) pos = __atomic_load_n(&channel->recv_pos, __ATOMIC_RELAXED);
+  }
+
+  return 0;
+}
+
+// spins for a short while, then yields, then sleeps.
+static void glms_channel_backoff(int64_t *tries) {
+  int64_t n = (*tries)++;
+
+  if (n < 64) return;
+
+  if (n < 256) {
+    sched_yield();
+    return;
+  }
+
+  struct timespec ts = {.tv_sec = 0, .tv_nsec = 50000};
+  nanosleep(&ts, 0);
+}
+
+int glms_channel_send(GLMSChannel *channel, GLMSAST value) {
+  if (!channel) return 0;
+
+  if (glms_channel_is_closed(channel))
+    GLMS_WARNING_RETURN(0, stderr, "channel is closed.\n");
+
+  GLMSChannelValue *sent = glms_channel_value_new(value);
+  if (!sent) return 0;
+
+  int64_t tries = 0;
+
+  while (!glms_channel_try_send(channel, sent)) {
+    if (glms_channel_is_closed(channel)) {
+      glms_channel_value_free(sent);
+      GLMS_WARNING_RETURN(0, stderr, "channel is closed.\n");
+    }
+
+    glms_channel_backoff(&tries);
+  }
+
+  return 1;
+}
+
+GLMSAST *glms_channel_recv(GLMSChannel *channel, GLMSEnv *env) {
+  if (!channel || !env) return 0;
+
+  int64_t tries = 0;
+  GLMSChannelValue *value = 0;
+
+  while ((value = glms_channel_try_recv(channel)) == 0) {
+    // a sender may still be writing into a cell it has taken.
+    if (glms_channel_is_closed(channel) &&
+        __atomic_load_n(&channel->recv_pos, __ATOMIC_ACQUIRE) >=
+            __atomic_load_n(&channel->send_pos, __ATOMIC_ACQUIRE))
+      return 0;
+
+    glms_channel_backoff(&tries);
+  }
+
+  GLMSAST *ast = glms_channel_value_take(value, env);
+  glms_channel_value_free(value);
+
+  return ast;
+}
+
+void glms_channel_close(GLMSChannel *channel) {
+  if (!channel) return;
+
+  __atomic_store_n(&channel->closed, true, __ATOMIC_RELEASE);
+}
+
+bool glms_channel_is_closed(GLMSChannel *channel) {
+  if (!channel) return true;
+
+  return __atomic_load_n(&channel->closed, __ATOMIC_ACQUIRE);
+}
+
+int64_t glms_channel_get_capacity(GLMSChannel *channel) {
+  return channel ? channel->capacity : 0;
+}
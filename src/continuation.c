@@ -0,0 +1,195 @@
+#if defined(__APPLE__)
+#define _XOPEN_SOURCE 600
+#endif
+#include <glms/continuation.h>
+#include <glms/env.h>
+#include <glms/eval.h>
+#include <glms/macros.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+#if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+
+struct GLMS_CONTINUATION_STRUCT {
+  GLMSEnv *env;
+  ucontext_t host;
+  ucontext_t script;
+  char *stack;
+
+  GLMSAST *func;
+  GLMSAST *args;
+  int64_t args_length;
+  GLMSStack frame;
+
+  GLMSAST result;
+  GLMSExecStatus status;
+
+  int64_t nodes;
+  int64_t nodes_limit;
+  int64_t deadline;
+};
+
+static int64_t glms_continuation_now() {
+  struct timespec ts = {0};
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+// stacks of freed continuations, so budgeted calls made every frame
+// do not map a new one each time.
+static struct {
+  pthread_mutex_t lock;
+  char *stacks[GLMS_CONTINUATION_STACK_POOL];
+  int64_t length;
+} glms_continuation_stacks = {.lock = PTHREAD_MUTEX_INITIALIZER};
+
+static size_t glms_continuation_guard_size() {
+  long page = sysconf(_SC_PAGESIZE);
+  return page > 0 ? (size_t)page : 4096;
+}
+
+// the stack grows down towards a page that faults on any access, so
+// deep recursion crashes instead of writing over the heap.
+static char *glms_continuation_stack_new() {
+  pthread_mutex_lock(&glms_continuation_stacks.lock);
+  char *stack = glms_continuation_stacks.length > 0
+                    ? glms_continuation_stacks
+                          .stacks[--glms_continuation_stacks.length]
+                    : 0;
+  pthread_mutex_unlock(&glms_continuation_stacks.lock);
+
+  if (stack) return stack;
+
+  size_t guard = glms_continuation_guard_size();
+  char *mem = (char *)mmap(0, GLMS_CONTINUATION_STACK_SIZE + guard,
+                           PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+                           -1, 0);
+  if (mem == MAP_FAILED) return 0;
+
+  if (mprotect(mem, guard, PROT_NONE) != 0) {
+    munmap(mem, GLMS_CONTINUATION_STACK_SIZE + guard);
+    return 0;
+  }
+
+  return mem + guard;
+}
+
+static void glms_continuation_stack_free(char *stack) {
+  if (!stack) return;
+
+  pthread_mutex_lock(&glms_continuation_stacks.lock);
+  bool pooled = glms_continuation_stacks.length < GLMS_CONTINUATION_STACK_POOL;
+  if (pooled)
+    glms_continuation_stacks.stacks[glms_continuation_stacks.length++] = stack;
+  pthread_mutex_unlock(&glms_continuation_stacks.lock);
+
+  if (pooled) return;
+
+  size_t guard = glms_continuation_guard_size();
+  munmap(stack - guard, GLMS_CONTINUATION_STACK_SIZE + guard);
+}
+
+// makecontext only passes ints, so the pointer is split in two.
+static void glms_continuation_entry(unsigned int hi, unsigned int lo) {
+  GLMSContinuation *c =
+      (GLMSContinuation *)(uintptr_t)(((uint64_t)hi << 32) | (uint64_t)lo);
+  GLMSEnv *env = c->env;
+
+  if (c->func != 0) {
+    GLMSASTBuffer args = (GLMSASTBuffer){
+        .initialized = true, .items = c->args, .length = c->args_length};
+
+    glms_stack_init(&c->frame);
+    glms_stack_copy(env->stack, &c->frame);
+    c->result = glms_eval_call_func(&env->eval, &c->frame, c->func, args);
+  } else {
+    c->result = glms_eval(&env->eval, *env->root, &env->stack);
+  }
+
+  c->status = GLMS_EXEC_DONE;
+}
+
+GLMSContinuation *glms_continuation_new(GLMSEnv *env, GLMSAST *func,
+                                        GLMSASTBuffer args) {
+  if (!env) return 0;
+
+  GLMSContinuation *c = NEW(GLMSContinuation);
+  if (!c) GLMS_WARNING_RETURN(0, stderr, "Could not allocate continuation.\n");
+
+  c->env = env;
+  c->func = func;
+  c->stack = glms_continuation_stack_new();
+
+  if (!c->stack) {
+    free(c);
+    GLMS_WARNING_RETURN(0, stderr, "Could not allocate continuation stack.\n");
+  }
+
+  // the caller's buffer may be gone by the time the script is resumed.
+  if (args.length > 0) {
+    c->args = (GLMSAST *)calloc(args.length, sizeof(GLMSAST));
+    memcpy(c->args, args.items, args.length * sizeof(GLMSAST));
+    c->args_length = args.length;
+  }
+
+  uint64_t ptr = (uint64_t)(uintptr_t)c;
+
+  getcontext(&c->script);
+  c->script.uc_stack.ss_sp = c->stack;
+  c->script.uc_stack.ss_size = GLMS_CONTINUATION_STACK_SIZE;
+  c->script.uc_link = &c->host;
+  makecontext(&c->script, (void (*)())glms_continuation_entry, 2,
+              (unsigned int)(ptr >> 32), (unsigned int)(ptr & 0xFFFFFFFF));
+
+  c->status = GLMS_EXEC_SUSPENDED;
+
+  return c;
+}
+
+GLMSExecStatus glms_continuation_run(GLMSContinuation *c, GLMSBudget budget,
+                                     GLMSAST *out) {
+  if (!c) return GLMS_EXEC_ERROR;
+  if (c->status != GLMS_EXEC_SUSPENDED) return c->status;
+
+  c->nodes = 0;
+  c->nodes_limit = budget.nodes;
+  c->deadline = budget.usec > 0 ? glms_continuation_now() + budget.usec : 0;
+
+  c->env->eval.continuation = c;
+  swapcontext(&c->host, &c->script);
+  c->env->eval.continuation = 0;
+
+  if (c->status == GLMS_EXEC_DONE && out != 0) *out = c->result;
+
+  return c->status;
+}
+
+void glms_continuation_tick(GLMSContinuation *c) {
+  c->nodes++;
+
+  bool out_of_nodes = c->nodes_limit > 0 && c->nodes >= c->nodes_limit;
+  bool out_of_time = c->deadline > 0 &&
+                     (c->nodes % GLMS_CONTINUATION_CLOCK_INTERVAL) == 0 &&
+                     glms_continuation_now() >= c->deadline;
+
+  if (!out_of_nodes && !out_of_time) return;
+
+  c->status = GLMS_EXEC_SUSPENDED;
+  swapcontext(&c->script, &c->host);
+}
+
+void glms_continuation_free(GLMSContinuation *c) {
+  if (!c) return;
+
+  if (c->frame.initialized) glms_stack_clear(&c->frame);
+  if (c->args) free(c->args);
+  glms_continuation_stack_free(c->stack);
+  free(c);
+}
@@ -195,19 +195,12 @@ static int glms_emit_glsl_object(GLMSEmit *emit, GLMSAST ast, int indent) {
 }
 static int glms_emit_glsl_struct(GLMSEmit *emit, GLMSAST ast, int indent) {
   // EMIT_APPEND_INDENTED("struct {\n", indent);
-  if (ast.props.initialized == true) {
-    HashyKeyList keys = {0};
-    hashy_map_get_keys(&ast.props, &keys);
-    for (int64_t i = 0; i < keys.length; i++) {
-      const char* key = keys.items[i].value;
-      if (!key) continue;
-      GLMSAST* child = glms_ast_get_property(&ast, key);
-      if (!child) continue;
-      glms_emit_glsl_(emit, *child, indent + INDENT_NUM);
+  if (glms_ast_has_props(&ast)) {
+    GLMSASTPropIterator it = {0};
+    while (glms_ast_iterate_props(&ast, &it)) {
+      glms_emit_glsl_(emit, *it.value, indent + INDENT_NUM);
       EMIT_APPEND_INDENTED(";\n", indent);
     }
-
-    hashy_key_list_clear(&keys);
   }
   EMIT_APPEND_INDENTED("\n}", indent);
   return 1;
@@ -1,8 +1,12 @@
+#include <glms/async.h>
 #include <glms/builtin.h>
+#include <glms/channel.h>
 #include <glms/constants.h>
 #include <glms/env.h>
 #include <glms/io.h>
 #include <glms/macros.h>
+#include <glms/module.h>
+#include <glms/parallel.h>
 #include <limits.h>
 #include <spath/spath.h>
 #include <stdio.h>
@@ -21,6 +25,25 @@
 #include "hashy/hashy.h"
 #include "text/text.h"
 
+int64_t glms_env_get_page_capacity(const char* source) {
+  if (!source) return GLMS_MEMO_AST_PAGE_CAPACITY_MIN;
+
+  int64_t capacity = GLMS_MEMO_AST_PAGE_CAPACITY_MIN +
+                     (strlen(source) / GLMS_MEMO_AST_CHARS_PER_NODE);
+
+  return MIN(capacity, GLMS_MEMO_AST_PAGE_CAPACITY);
+}
+
+static bool glms_env_has_shared_memo(GLMSEnv* env) {
+  return env->config.memo_ast != 0 && env->config.memo_ast->initialized;
+}
+
+Memo* glms_env_get_memo(GLMSEnv* env) {
+  if (!env) return 0;
+  if (glms_env_has_shared_memo(env)) return env->config.memo_ast;
+  return env->memo_ast.initialized ? &env->memo_ast : 0;
+}
+
 int glms_env_init(GLMSEnv* env, const char* source, const char* entry_path,
                   GLMSConfig cfg) {
   if (!env) return 0;
@@ -35,23 +58,21 @@ int glms_env_init(GLMSEnv* env, const char* source, const char* entry_path,
   glms_allocator_string_allocator(&env->string_alloc);
   hashy_map_init(&env->globals, (HashyConfig){.capacity = 256});
   hashy_map_init(&env->types, (HashyConfig){.capacity = 256});
+  hashy_map_init(&env->handles, (HashyConfig){.capacity = 16});
+  hashy_map_init(&env->layouts, (HashyConfig){.capacity = 16});
+
+  env->page_capacity = glms_env_get_page_capacity(source);
 
-  if (!env->memo_ast.initialized) {
+  // an env given a shared allocator never touches its own memo,
+  // and the arena is only set up once something is allocated at runtime.
+  if (!env->memo_ast.initialized && !glms_env_has_shared_memo(env)) {
     memo_init(
         &env->memo_ast,
         (MemoConfig){.item_size = sizeof(GLMSAST),
-                     .page_capacity = GLMS_MEMO_AST_PAGE_CAPACITY,
+                     .page_capacity = env->page_capacity,
                      .destructor = (MemoDestructorFunc)glms_ast_destructor});
   }
 
-  if (!env->arena_ast.initialized) {
-    arena_init(
-        &env->arena_ast,
-        (ArenaConfig){.items_per_page = GLMS_ARENA_AST_CAPACITY,
-                      .item_size = sizeof(GLMSAST),
-                      .free_function = (ArenaFreeFunction)glms_ast_destructor});
-  }
-
   if (env->undefined == 0) {
     env->undefined = glms_env_new_ast(env, GLMS_AST_TYPE_UNDEFINED, false);
   }
@@ -63,8 +84,11 @@ int glms_env_init(GLMSEnv* env, const char* source, const char* entry_path,
   glms_eval_init(&env->eval, env);
   glms_stack_init(&env->stack);
 
-  if (!env->has_builtins) {
-    glms_builtin_init(env);
+  // the prototype is initialized through here as well,
+  // and registers its builtins itself.
+  if (!env->has_builtins && !glms_builtin_is_prototype(env)) {
+    env->parent = glms_builtin_get_prototype();
+    env->has_builtins = true;
   }
 
   if (env->source != 0) {
@@ -75,30 +99,208 @@ int glms_env_init(GLMSEnv* env, const char* source, const char* entry_path,
   return 1;
 }
 
+static void glms_env_clear_handles(GLMSEnv* env) {
+  HashyIterator it = {0};
+
+  while (hashy_map_iterate(&env->handles, &it)) {
+    if (!it.bucket->is_set) continue;
+    if (!it.bucket->value) continue;
+
+    GLMSFunctionHandle* handle = (GLMSFunctionHandle*)it.bucket->value;
+    glms_stack_clear(&handle->frame);
+    glms_env_clear(&handle->scope);
+    if (handle->params) free(handle->params);
+    if (handle->param_names) free(handle->param_names);
+    free(handle);
+  }
+
+  hashy_map_clear(&env->handles);
+}
+
+static void glms_env_clear_layouts(GLMSEnv* env) {
+  HashyIterator it = {0};
+
+  while (hashy_map_iterate(&env->layouts, &it)) {
+    if (!it.bucket->is_set) continue;
+    if (!it.bucket->value) continue;
+
+    glms_struct_layout_free((GLMSStructLayout*)it.bucket->value);
+  }
+
+  hashy_map_clear(&env->layouts);
+}
+
+static void glms_env_clear_channels(GLMSEnv* env) {
+  for (int64_t i = 0; i < env->channels_length; i++) {
+    glms_channel_release(env->channels[i]);
+  }
+
+  if (env->channels) free(env->channels);
+  env->channels = 0;
+  env->channels_length = 0;
+}
+
 int glms_env_clear(GLMSEnv* env) {
   if (!env) return 0;
   if (!env->initialized)
     GLMS_WARNING_RETURN(0, stderr, "env not initialized.\n");
 
+  // background work still writes into the env's futures.
+  glms_async_clear(env);
+  glms_env_clear_channels(env);
+
   env->source = 0;
   hashy_map_clear(&env->parser.symbols);
   hashy_map_clear(&env->globals);
   hashy_map_clear(&env->types);
+  glms_env_clear_handles(env);
+  glms_env_clear_layouts(env);
+  glms_reload_clear(&env->reload);
   glms_stack_clear(&env->stack);
   env->undefined = 0;
-  memo_clear(&env->memo_ast);
+  if (env->memo_ast.initialized) memo_clear(&env->memo_ast);
   glms_emit_destroy(&env->emit);
   glms_eval_clear(&env->eval);
 
-  arena_destroy(&env->arena_ast);
+  if (env->arena_ast.initialized) arena_destroy(&env->arena_ast);
   // arena_reset(&env->arena_ast);
   // arena_clear(&env->arena_ast);
 
+  env->parent = 0;
+  env->frozen = false;
   env->initialized = false;
 
   return 1;
 }
 
+// types are constructed lazily on first use, which would allocate
+// into whichever env happens to use them first.
+void glms_env_construct_types(GLMSEnv* env) {
+  HashyIterator it = {0};
+
+  while (hashy_map_iterate(&env->types, &it)) {
+    if (!it.bucket->is_set) continue;
+    if (!it.bucket->value) continue;
+
+    GLMSAST* t = (GLMSAST*)it.bucket->value;
+    if (!t->constructor || t->constructed) continue;
+
+    t->constructor(&env->eval, &env->stack, 0, t);
+    t->constructed = true;
+  }
+}
+
+static void glms_env_apply_types_in(GLMSEnv* env, HashyMap* map) {
+  HashyIterator it = {0};
+
+  while (hashy_map_iterate(map, &it)) {
+    if (!it.bucket->is_set) continue;
+    if (!it.bucket->value) continue;
+
+    glms_env_apply_type(env, &env->eval, &env->stack,
+                        (GLMSAST*)it.bucket->value);
+  }
+}
+
+void glms_env_freeze(GLMSEnv* env) {
+  if (!env || !env->initialized) return;
+
+  glms_env_construct_types(env);
+  glms_env_apply_types_in(env, &env->globals);
+  glms_env_apply_types_in(env, &env->stack.locals);
+
+  env->frozen = true;
+}
+
+GLMSEnvSnapshot* glms_env_snapshot(GLMSEnv* env) {
+  if (!env) return 0;
+  if (!env->initialized)
+    GLMS_WARNING_RETURN(0, stderr, "env not initialized.\n");
+
+  if (env->root == 0 && env->source != 0) glms_env_exec(env);
+
+  // forks may run on other threads, which must find every builtin
+  // module already registered and every shared node already typed.
+  glms_builtin_load_modules();
+  glms_env_freeze(env);
+
+  GLMSEnvSnapshot* snapshot = NEW(GLMSEnvSnapshot);
+  if (!snapshot)
+    GLMS_WARNING_RETURN(0, stderr, "Could not allocate snapshot.\n");
+
+  snapshot->env = env;
+  glms_stack_init(&snapshot->shared);
+  glms_stack_init(&snapshot->values);
+
+  HashyIterator it = {0};
+
+  while (hashy_map_iterate(&env->stack.locals, &it)) {
+    if (!it.bucket->is_set) continue;
+    if (!it.bucket->value) continue;
+
+    const char* key = it.bucket->key.value;
+    GLMSAST* value = (GLMSAST*)it.bucket->value;
+    GLMSAST* ptr = glms_ast_get_ptr(*value);
+
+    if ((ptr ? ptr : value)->type == GLMS_AST_TYPE_FUNC) {
+      glms_stack_push(&snapshot->shared, key, value);
+    } else {
+      glms_stack_push(&snapshot->values, key, value);
+    }
+  }
+
+  return snapshot;
+}
+
+void glms_env_snapshot_free(GLMSEnvSnapshot* snapshot) {
+  if (!snapshot) return;
+
+  glms_stack_clear(&snapshot->shared);
+  glms_stack_clear(&snapshot->values);
+  free(snapshot);
+}
+
+int glms_env_fork(GLMSEnvSnapshot* snapshot, GLMSEnv* env, const char* source,
+                  const char* entry_path) {
+  if (!snapshot || !snapshot->env || !env) return 0;
+  if (env->initialized)
+    GLMS_WARNING_RETURN(0, stderr, "env already initialized.\n");
+
+  GLMSEnv* parent = snapshot->env;
+
+  env->parent = parent;
+  env->has_builtins = true;
+
+  if (!glms_env_init(env, source, entry_path ? entry_path : parent->entry_path,
+                     parent->config))
+    return 0;
+
+  glms_stack_copy(snapshot->shared, &env->stack);
+
+  HashyIterator it = {0};
+
+  while (hashy_map_iterate(&snapshot->values.locals, &it)) {
+    if (!it.bucket->is_set) continue;
+    if (!it.bucket->value) continue;
+
+    const char* key = it.bucket->key.value;
+    GLMSAST* value = (GLMSAST*)it.bucket->value;
+    GLMSAST* copied = glms_ast_copy(*value, env);
+    GLMSAST* ptr = glms_ast_get_ptr(*value);
+
+    // children are copy-on-write, so this stays cheap for large arrays.
+    if (ptr) copied->as.stackptr.ptr = glms_ast_copy(*ptr, env);
+
+    glms_stack_push(&env->stack, key, copied);
+  }
+
+  if (source == 0) {
+    env->root = glms_env_new_ast(env, GLMS_AST_TYPE_COMPOUND, false);
+  }
+
+  return 1;
+}
+
 GLMSAST* glms_env_new_ast(GLMSEnv* env, GLMSASTType type, bool arena) {
   if (!env) return 0;
   if (!env->initialized)
@@ -106,16 +308,22 @@ GLMSAST* glms_env_new_ast(GLMSEnv* env, GLMSASTType type, bool arena) {
 
   arena = env->use_arena;
 
-  Memo* selected_memo = env->config.memo_ast;
-
   ArenaRef ref = {0};
   GLMSAST* ast = 0;
 
-  if (selected_memo != 0 && selected_memo->initialized) {
-    ast = (GLMSAST*)memo_malloc(selected_memo);
+  if (glms_env_has_shared_memo(env)) {
+    ast = (GLMSAST*)memo_malloc(env->config.memo_ast);
+  } else if (arena) {
+    if (!env->arena_ast.initialized) {
+      arena_init(
+          &env->arena_ast,
+          (ArenaConfig){.items_per_page = env->page_capacity * 2,
+                        .item_size = sizeof(GLMSAST),
+                        .free_function = (ArenaFreeFunction)glms_ast_destructor});
+    }
+    ast = (GLMSAST*)arena_malloc(&env->arena_ast, &ref);
   } else {
-    ast = (GLMSAST*)(arena ? arena_malloc(&env->arena_ast, &ref)
-                           : memo_malloc(&env->memo_ast));
+    ast = (GLMSAST*)memo_malloc(&env->memo_ast);
   }
   if (!ast) GLMS_WARNING_RETURN(0, stderr, "Failed to allocate AST.\n");
 
@@ -180,18 +388,41 @@ GLMSAST* glms_env_exec(GLMSEnv* env) {
 
   env->use_arena = false;
 
+  long warnings = glms_warnings_raised;
+  long errors = glms_errors_raised;
+
+  bool parsed = env->root == 0;
   GLMSAST* root = env->root ? env->root : glms_parser_parse(&env->parser);
 
   env->root = root;
   env->use_arena = true;
 
+  // imports are read and parsed up front, and still executed in order.
+  if (parsed) glms_module_prefetch(env, root, env->config.import_threads);
+
 
   if (env->config.emit.mode != GLMS_EMIT_MODE_UNDEFINED) {
     glms_env_emit(env);
   } else {
     glms_eval(&env->eval, *root, &env->stack);
   }
-  
+
+  env->warnings = glms_warnings_raised - warnings;
+  env->errors = glms_errors_raised - errors;
+
+  return root;
+}
+
+int64_t glms_env_poll(GLMSEnv* env) { return glms_async_poll(env); }
+
+GLMSAST* glms_env_exec_root(GLMSEnv* env, GLMSAST* root) {
+  if (!env || !root) return 0;
+  if (!env->initialized)
+    GLMS_WARNING_RETURN(0, stderr, "env not initialized.\n");
+
+  env->use_arena = true;
+  glms_eval(&env->eval, *root, &env->stack);
+
   return root;
 }
 
@@ -222,6 +453,87 @@ GLMSAST* glms_env_exec_source(GLMSEnv* env, const char* source) {
   return root;
 }
 
+static GLMSBudget glms_env_get_budget(GLMSEnv* env, GLMSBudget budget) {
+  if (budget.nodes > 0 || budget.usec > 0) return budget;
+  return env->config.budget;
+}
+
+static GLMSExecStatus glms_env_run_continuation(GLMSEnv* env,
+                                                GLMSContinuation* c,
+                                                GLMSBudget budget,
+                                                GLMSAST* out) {
+  if (!c) return GLMS_EXEC_ERROR;
+
+  GLMSExecStatus status =
+      glms_continuation_run(c, glms_env_get_budget(env, budget), out);
+
+  if (status == GLMS_EXEC_SUSPENDED) {
+    env->eval.suspended = c;
+  } else {
+    env->eval.suspended = 0;
+    glms_continuation_free(c);
+  }
+
+  return status;
+}
+
+GLMSExecStatus glms_env_exec_budget(GLMSEnv* env, GLMSBudget budget) {
+  if (!env) return GLMS_EXEC_ERROR;
+  if (!env->initialized)
+    GLMS_WARNING_RETURN(GLMS_EXEC_ERROR, stderr, "env not initialized.\n");
+  if (env->eval.suspended)
+    GLMS_WARNING_RETURN(GLMS_EXEC_ERROR, stderr,
+                        "env is suspended, use glms_env_resume.\n");
+
+  env->use_arena = false;
+  env->root = env->root ? env->root : glms_parser_parse(&env->parser);
+  env->use_arena = true;
+
+  if (!env->root) return GLMS_EXEC_ERROR;
+
+  GLMSContinuation* c = glms_continuation_new(env, 0, (GLMSASTBuffer){0});
+
+  return glms_env_run_continuation(env, c, budget, 0);
+}
+
+GLMSExecStatus glms_env_call_function_budget(GLMSEnv* env, const char* name,
+                                             GLMSASTBuffer args,
+                                             GLMSBudget budget, GLMSAST* out) {
+  if (!env || !name) return GLMS_EXEC_ERROR;
+  if (!env->initialized)
+    GLMS_WARNING_RETURN(GLMS_EXEC_ERROR, stderr, "env not initialized.\n");
+  if (env->eval.suspended)
+    GLMS_WARNING_RETURN(GLMS_EXEC_ERROR, stderr,
+                        "env is suspended, use glms_env_resume.\n");
+
+  if (env->root == 0) {
+    glms_env_exec(env);
+  }
+
+  GLMSAST* func = glms_eval_lookup(&env->eval, &env->stack, name);
+
+  if (!func) {
+    GLMS_WARNING_RETURN(GLMS_EXEC_ERROR, stderr, "No such function: `%s`.\n",
+                        name);
+  }
+
+  GLMSContinuation* c = glms_continuation_new(env, func, args);
+
+  return glms_env_run_continuation(env, c, budget, out);
+}
+
+GLMSExecStatus glms_env_resume(GLMSEnv* env, GLMSBudget budget, GLMSAST* out) {
+  if (!env) return GLMS_EXEC_ERROR;
+  if (!env->eval.suspended)
+    GLMS_WARNING_RETURN(GLMS_EXEC_ERROR, stderr, "env is not suspended.\n");
+
+  return glms_env_run_continuation(env, env->eval.suspended, budget, out);
+}
+
+bool glms_env_is_suspended(GLMSEnv* env) {
+  return env != 0 && env->eval.suspended != 0;
+}
+
 int glms_env_reset(GLMSEnv* env) {
   if (!env) return 0;
   if (!env->initialized)
@@ -247,6 +559,9 @@ int glms_env_call_function(GLMSEnv* env, const char* name, GLMSASTBuffer args,
   if (!env->initialized)
     GLMS_WARNING_RETURN(0, stderr, "env not initialized.\n");
 
+  if (glms_env_is_suspended(env))
+    GLMS_WARNING_RETURN(0, stderr, "env is suspended, use glms_env_resume.\n");
+
   if (!name) return 0;
 
   if (env->root == 0) {
@@ -272,6 +587,495 @@ int glms_env_call_function(GLMSEnv* env, const char* name, GLMSASTBuffer args,
   return 1;
 }
 
+// nodes per page of a handle's scope, which is set up again every call.
+#define GLMS_ENV_HANDLE_PAGE_CAPACITY 64
+
+// also used to refresh a handle once its function was reloaded.
+static void glms_env_setup_handle_params(GLMSFunctionHandle* handle) {
+  GLMSAST* func = handle->func;
+
+  if (handle->params) free(handle->params);
+  if (handle->param_names) free(handle->param_names);
+  handle->params = 0;
+  handle->param_names = 0;
+  handle->params_length = 0;
+
+  int64_t n = func->children ? func->children->length : 0;
+
+  if (n > 0 && func->fptr == 0) {
+    handle->params = (GLMSAST**)calloc(n, sizeof(GLMSAST*));
+    handle->param_names = (const char**)calloc(n, sizeof(char*));
+    handle->params_length = n;
+
+    for (int64_t i = 0; i < n; i++) {
+      handle->param_names[i] = glms_ast_get_name(func->children->items[i]);
+      handle->params[i] =
+          glms_env_new_ast(handle->env, GLMS_AST_TYPE_UNDEFINED, false);
+      handle->params[i]->keep = true;
+    }
+  }
+}
+
+GLMSFunctionHandle* glms_env_get_function(GLMSEnv* env, const char* name) {
+  if (!env || !name) return 0;
+  if (!env->initialized)
+    GLMS_WARNING_RETURN(0, stderr, "env not initialized.\n");
+
+  GLMSFunctionHandle* handle =
+      (GLMSFunctionHandle*)hashy_map_get(&env->handles, name);
+  if (handle != 0) return handle;
+
+  if (env->root == 0) {
+    glms_env_exec(env);
+  }
+
+  GLMSAST* func = glms_eval_lookup(&env->eval, &env->stack, name);
+  GLMSAST* ptr = func ? glms_ast_get_ptr(*func) : 0;
+  func = ptr ? ptr : func;
+
+  if (!func) {
+    GLMS_WARNING_RETURN(0, stderr, "No such function: `%s`.\n", name);
+  }
+
+  handle = NEW(GLMSFunctionHandle);
+  if (!handle) GLMS_WARNING_RETURN(0, stderr, "Could not allocate handle.\n");
+
+  handle->env = env;
+  handle->func = func;
+
+  // constructed here, a type first used by a call would point into
+  // its scope.
+  glms_env_construct_types(env);
+
+  GLMSConfig cfg = env->config;
+  cfg.memo_ast = 0;
+
+  handle->scope.parent = env;
+  handle->scope.has_builtins = true;
+  glms_env_init(&handle->scope, 0, env->entry_path, cfg);
+  handle->scope.page_capacity = GLMS_ENV_HANDLE_PAGE_CAPACITY;
+  handle->scope.use_arena = true;
+  handle->scope.scoped = true;
+
+  glms_stack_init(&handle->frame);
+  glms_stack_copy(env->stack, &handle->frame);
+
+  if (!glms_stack_get(&handle->frame, "self")) {
+    glms_stack_push(&handle->frame, "self", func);
+  }
+
+  glms_env_setup_handle_params(handle);
+
+  // what each call declares is undone once it returns.
+  glms_stack_mark(&handle->frame);
+
+  hashy_map_set(&env->handles, name, handle);
+
+  return handle;
+}
+
+// numbers, booleans, vectors and matrices are written straight into
+// the preallocated parameter, anything owning memory gets a copy.
+static bool glms_env_is_plain_value(GLMSAST* ast) {
+  switch (ast->type) {
+    case GLMS_AST_TYPE_NUMBER:
+    case GLMS_AST_TYPE_BOOL:
+    case GLMS_AST_TYPE_VEC2:
+    case GLMS_AST_TYPE_VEC3:
+    case GLMS_AST_TYPE_VEC4:
+    case GLMS_AST_TYPE_MAT3:
+    case GLMS_AST_TYPE_MAT4:
+      return ast->children == 0 && !glms_ast_has_props(ast);
+    default:
+      return false;
+  }
+}
+
+// plain values are written into `param`, anything else is copied into
+// the env of `eval` and shadows it until the frame is reset.
+static void glms_env_bind_param(GLMSEval* eval, GLMSStack* frame,
+                                const char* name, GLMSAST* param,
+                                GLMSAST arg) {
+  if (!name || !param) return;
+
+  GLMSAST* ptr = glms_ast_get_ptr(arg);
+  GLMSAST* value = ptr ? ptr : &arg;
+
+  if (!glms_env_is_plain_value(value)) {
+    glms_stack_push(frame, name, glms_ast_copy(*value, eval->env));
+    return;
+  }
+
+  param->type = value->type;
+  param->as = value->as;
+  param->value_type = value->value_type;
+  param->constructor = value->constructor;
+  param->swizzle = value->swizzle;
+  param->to_string = value->to_string;
+  memcpy(&param->op_overloads[0], &value->op_overloads[0],
+         sizeof(GLMSASTOperatorOverload) * GLMS_AST_OPERATOR_OVERLOAD_CAP);
+
+  glms_stack_push(frame, name, param);
+}
+
+// releases everything the previous call allocated, the arena is set up
+// again by the first value this call allocates.
+static void glms_env_reset_handle_scope(GLMSFunctionHandle* handle) {
+  if (handle->scope.arena_ast.initialized)
+    arena_destroy(&handle->scope.arena_ast);
+}
+
+// runs the handle's function in `frame`, a marked copy of the handle's
+// frame whose parameters are `params`, and undoes what the call declared.
+static GLMSAST glms_env_call_frame(GLMSFunctionHandle* handle, GLMSEval* eval,
+                                   GLMSStack* frame, GLMSAST** params,
+                                   GLMSASTBuffer args) {
+  GLMSAST* func = handle->func;
+  GLMSAST result = {0};
+
+  frame->return_flag = false;
+
+  if (func->fptr != 0 || func->as.func.body == 0) {
+    result = glms_eval_call_func(eval, frame, func, args);
+  } else {
+    int64_t n = MIN(args.length, handle->params_length);
+
+    for (int64_t i = 0; i < n; i++) {
+      glms_env_bind_param(eval, frame, handle->param_names[i], params[i],
+                          args.items[i]);
+    }
+
+    result = glms_eval(eval, *func->as.func.body, frame);
+  }
+
+  // locals, parameters and `return` of this call are not seen by the next.
+  glms_stack_reset(frame);
+
+  return result;
+}
+
+static GLMSAST glms_env_call_handle_row(GLMSFunctionHandle* handle,
+                                        GLMSASTBuffer args) {
+  return glms_env_call_frame(handle, &handle->scope.eval, &handle->frame,
+                             handle->params, args);
+}
+
+// a result pointing at a parameter would change with the next row, so
+// plain results are kept by value.
+static GLMSAST glms_env_row_result(GLMSAST result) {
+  GLMSAST* ptr = glms_ast_get_ptr(result);
+
+  if (ptr != 0 && glms_env_is_plain_value(ptr)) return *ptr;
+
+  return result;
+}
+
+int glms_env_call_handle(GLMSFunctionHandle* handle, GLMSASTBuffer args,
+                         GLMSAST* out) {
+  if (!handle || !handle->env || !handle->func) return 0;
+  if (glms_env_is_suspended(handle->env))
+    GLMS_WARNING_RETURN(0, stderr, "env is suspended, use glms_env_resume.\n");
+
+  glms_env_reset_handle_scope(handle);
+
+  GLMSAST result = glms_env_call_handle_row(handle, args);
+
+  if (out != 0) *out = result;
+
+  return 1;
+}
+
+// rows handed to each task of a pure batch.
+#define GLMS_ENV_CALL_BATCH_CHUNK 64
+
+typedef struct {
+  GLMSFunctionHandle* handle;
+  GLMSASTBuffer* args_matrix;
+  int64_t n;
+  GLMSAST* results;
+  GLMSEnv** envs;
+} GLMSEnvCallBatch;
+
+static int glms_env_call_batch_chunk(GLMSEval* eval, GLMSStack* stack,
+                                     int64_t task, void* user_ptr) {
+  GLMSEnvCallBatch* batch = (GLMSEnvCallBatch*)user_ptr;
+  int64_t end = MIN((task + 1) * GLMS_ENV_CALL_BATCH_CHUNK, batch->n);
+
+  GLMSFunctionHandle* handle = batch->handle;
+
+  batch->envs[task] = eval->env;
+
+  // a worker's copy of the frame gets parameters of its own the first
+  // time, later rows only rebind them like glms_env_call_handle does.
+  if (!stack->marked) {
+    for (int64_t i = 0; i < handle->params_length; i++) {
+      if (!handle->param_names[i]) continue;
+
+      glms_stack_push(stack, handle->param_names[i],
+                      glms_env_new_ast(eval->env, GLMS_AST_TYPE_UNDEFINED,
+                                       true));
+    }
+
+    glms_stack_mark(stack);
+  }
+
+  GLMSAST** params = 0;
+
+  if (handle->params_length > 0) {
+    params = (GLMSAST**)calloc(handle->params_length, sizeof(GLMSAST*));
+
+    for (int64_t i = 0; i < handle->params_length; i++) {
+      params[i] = glms_stack_get(stack, handle->param_names[i]);
+    }
+  }
+
+  for (int64_t i = task * GLMS_ENV_CALL_BATCH_CHUNK; i < end; i++) {
+    GLMSAST result =
+        glms_env_call_frame(handle, eval, stack, params, batch->args_matrix[i]);
+    batch->results[i] = glms_env_row_result(glms_eval(eval, result, stack));
+  }
+
+  if (params) free(params);
+
+  return 1;
+}
+
+static int glms_env_call_batch_merge(GLMSEval* eval, GLMSStack* stack,
+                                     int64_t task, void* user_ptr) {
+  GLMSEnvCallBatch* batch = (GLMSEnvCallBatch*)user_ptr;
+  int64_t end = MIN((task + 1) * GLMS_ENV_CALL_BATCH_CHUNK, batch->n);
+
+  for (int64_t i = task * GLMS_ENV_CALL_BATCH_CHUNK; i < end; i++) {
+    GLMSAST result = batch->results[i];
+    GLMSAST* ptr = glms_ast_get_ptr(result);
+    GLMSAST* value = ptr ? ptr : &result;
+
+    // plain results are handed out by value, the rest outlive the workers.
+    if (glms_env_is_plain_value(value)) {
+      batch->results[i] = *value;
+      continue;
+    }
+
+    batch->results[i] = (GLMSAST){
+        .type = GLMS_AST_TYPE_STACK_PTR,
+        .as.stackptr.ptr =
+            glms_parallel_adopt(eval->env, batch->envs[task], *value)};
+  }
+
+  return 1;
+}
+
+// every row runs in its own frame on a worker, see glms_parallel_run.
+static int glms_env_call_batch_parallel(GLMSFunctionHandle* handle,
+                                        GLMSASTBuffer* args_matrix, int64_t n,
+                                        GLMSAST* out_results) {
+  GLMSEnv* env = handle->env;
+  int64_t chunks =
+      (n + GLMS_ENV_CALL_BATCH_CHUNK - 1) / GLMS_ENV_CALL_BATCH_CHUNK;
+
+  GLMSEnvCallBatch batch = {
+      .handle = handle,
+      .args_matrix = args_matrix,
+      .n = n,
+      .results = (GLMSAST*)calloc(n, sizeof(GLMSAST)),
+      .envs = (GLMSEnv**)calloc(chunks, sizeof(GLMSEnv*))};
+
+  // results are adopted by the scope, like those of a serial batch.
+  int ok = glms_parallel_run(&handle->scope.eval, &handle->frame, 0, chunks,
+                             glms_env_call_batch_chunk,
+                             glms_env_call_batch_merge, &batch);
+
+  if (ok && out_results != 0)
+    memcpy(out_results, batch.results, n * sizeof(GLMSAST));
+
+  free(batch.results);
+  free(batch.envs);
+
+  return ok;
+}
+
+int glms_env_call_batch(GLMSEnv* env, GLMSFunctionHandle* handle,
+                        GLMSASTBuffer* args_matrix, int64_t n,
+                        GLMSAST* out_results) {
+  if (!env || !handle || !handle->func) return 0;
+  if (handle->env != env)
+    GLMS_WARNING_RETURN(0, stderr, "handle belongs to another env.\n");
+  if (glms_env_is_suspended(env))
+    GLMS_WARNING_RETURN(0, stderr, "env is suspended, use glms_env_resume.\n");
+  if (n <= 0) return 1;
+  if (!args_matrix) return 0;
+
+  glms_env_reset_handle_scope(handle);
+
+  if (handle->pure && n > GLMS_ENV_CALL_BATCH_CHUNK)
+    return glms_env_call_batch_parallel(handle, args_matrix, n, out_results);
+
+  for (int64_t i = 0; i < n; i++) {
+    GLMSAST result = glms_env_call_handle_row(handle, args_matrix[i]);
+    if (out_results != 0) out_results[i] = glms_env_row_result(result);
+  }
+
+  return 1;
+}
+
+static GLMSAST* glms_env_reload_parse(GLMSEnv* env, const char* chunk) {
+  glms_env_reset(env);
+
+  env->use_arena = false;
+  glms_lexer_init(&env->lexer, chunk);
+  glms_parser_init(&env->parser, env);
+  GLMSAST* root = glms_parser_parse(&env->parser);
+  env->use_arena = true;
+
+  if (!root || env->parser.error)
+    GLMS_WARNING_RETURN(0, stderr, "Could not parse reloaded `%s`.\n", chunk);
+
+  return root;
+}
+
+// functions declared by the script live on the stack,
+// so that is where the previous version is found.
+static GLMSAST* glms_env_reload_find_function(GLMSEnv* env, GLMSAST* func) {
+  const char* name = glms_ast_get_name(func);
+  if (!name) return 0;
+
+  GLMSAST* existing = glms_stack_get(&env->stack, name);
+  GLMSAST* ptr = existing ? glms_ast_get_ptr(*existing) : 0;
+  existing = ptr ? ptr : existing;
+
+  if (!existing || existing->type != GLMS_AST_TYPE_FUNC) return 0;
+  if (existing->fptr || existing->native) return 0;
+
+  return existing;
+}
+
+// swaps body and parameters in place, so everything already
+// pointing at the function (handles, values, closures) sees the new one.
+static void glms_env_reload_function(GLMSEnv* env, GLMSAST* existing,
+                                     GLMSAST* fresh) {
+  existing->as.func.body = fresh->as.func.body;
+
+  if (existing->children != fresh->children) {
+    glms_ast_release_children(existing);
+    existing->children = fresh->children;
+    if (existing->children) GLMS_REFS_INC(existing->children->refs);
+  }
+
+  HashyIterator it = {0};
+
+  while (hashy_map_iterate(&env->handles, &it)) {
+    if (!it.bucket->is_set) continue;
+    if (!it.bucket->value) continue;
+
+    GLMSFunctionHandle* handle = (GLMSFunctionHandle*)it.bucket->value;
+    if (handle->func == existing) glms_env_setup_handle_params(handle);
+  }
+}
+
+static int glms_env_reload_chunk(GLMSEnv* env, const char* chunk) {
+  GLMSAST* root = glms_env_reload_parse(env, chunk);
+  if (!root) return 0;
+
+  int64_t n = root->children ? root->children->length : 0;
+
+  for (int64_t i = 0; i < n; i++) {
+    GLMSAST* statement = root->children->items[i];
+
+    GLMSAST* existing = statement->type == GLMS_AST_TYPE_FUNC
+                            ? glms_env_reload_find_function(env, statement)
+                            : 0;
+
+    if (existing) {
+      glms_env_reload_function(env, existing, statement);
+    } else {
+      glms_eval(&env->eval, *statement, &env->stack);
+    }
+  }
+
+  return 1;
+}
+
+// what was run initially is compared against by the first reload.
+static int glms_env_reload_baseline(GLMSEnv* env) {
+  if (env->reload.initialized) return 1;
+
+  if (env->source == 0) {
+    env->reload.initialized = true;
+    return 1;
+  }
+
+  char** chunks = 0;
+  int64_t length = 0;
+  if (!glms_reload_split(env->source, &chunks, &length)) return 0;
+  glms_reload_replace(&env->reload, chunks, length);
+
+  return 1;
+}
+
+int glms_env_reload(GLMSEnv* env, const char* source) {
+  if (!env || !source) return 0;
+  if (!env->initialized)
+    GLMS_WARNING_RETURN(0, stderr, "env not initialized.\n");
+  if (env->eval.suspended)
+    GLMS_WARNING_RETURN(0, stderr, "env is suspended, use glms_env_resume.\n");
+
+  if (env->root == 0) {
+    glms_env_exec(env);
+  }
+
+  if (!glms_env_reload_baseline(env)) return 0;
+
+  char** chunks = 0;
+  int64_t length = 0;
+  if (!glms_reload_split(source, &chunks, &length)) return 0;
+
+  for (int64_t i = 0; i < length; i++) {
+    char* unchanged = glms_reload_take(&env->reload, chunks[i]);
+
+    if (unchanged) {
+      free(chunks[i]);
+      chunks[i] = unchanged;
+      continue;
+    }
+
+    glms_env_reload_chunk(env, chunks[i]);
+  }
+
+  glms_reload_replace(&env->reload, chunks, length);
+
+  return 1;
+}
+
+int glms_env_reload_if_changed(GLMSEnv* env) {
+  if (!env) return 0;
+  if (!env->initialized)
+    GLMS_WARNING_RETURN(0, stderr, "env not initialized.\n");
+  if (!env->entry_path) return 0;
+
+  struct timespec mtime = {0};
+  if (!glms_reload_get_mtime(env->entry_path, &mtime)) return 0;
+
+  if (!env->reload.initialized) {
+    glms_env_reload_baseline(env);
+    env->reload.mtime = mtime;
+    return 0;
+  }
+
+  if (env->reload.mtime.tv_sec == mtime.tv_sec &&
+      env->reload.mtime.tv_nsec == mtime.tv_nsec)
+    return 0;
+
+  char* source = glms_get_file_contents(env->entry_path);
+  if (!source) return 0;
+
+  int ok = glms_env_reload(env, source);
+  free(source);
+
+  env->reload.mtime = mtime;
+
+  return ok;
+}
+
 int glms_env_register_function_signature(GLMSEnv* env, GLMSAST* ast,
                                          const char* name,
                                          GLMSFunctionSignature signature) {
@@ -335,6 +1139,28 @@ GLMSAST* glms_env_register_function(GLMSEnv* env, const char* name,
   return func;
 }
 
+GLMSAST* glms_env_register_native(GLMSEnv* env, const char* name,
+                                  GLMSFunctionSignature signature,
+                                  GLMSNativeFunc native) {
+  if (!env || !name || !native) return 0;
+  if (!env->initialized)
+    GLMS_WARNING_RETURN(0, stderr, "env not initialized.\n");
+
+  if (signature.args_length > GLMS_NATIVE_ARGS_CAP)
+    GLMS_WARNING_RETURN(0, stderr, "Too many arguments for native `%s`.\n",
+                        name);
+
+  GLMSAST* func = glms_env_new_ast(env, GLMS_AST_TYPE_FUNC, false);
+  func->native = native;
+  func->as.func.name = strdup(name);
+  hashy_map_set(&env->globals, name, func);
+
+  // the first signature is the one the native is called with.
+  glms_env_register_function_signature(env, 0, name, signature);
+
+  return func;
+}
+
 GLMSAST* glms_env_register_struct(GLMSEnv* env, const char* name,
                                   GLMSAST** fields, int fields_length) {
   if (!env || !name || !fields) return 0;
@@ -396,20 +1222,123 @@ GLMSAST* glms_env_register_type(GLMSEnv* env, const char* name, GLMSAST* ast,
 
   return ast;
 }
+static void glms_env_struct_layout_constructor(GLMSEval* eval, GLMSStack* stack,
+                                               GLMSASTBuffer* args,
+                                               GLMSAST* self) {
+  self->constructor = glms_env_struct_layout_constructor;
+}
+
+GLMSAST* glms_env_register_struct_layout(GLMSEnv* env, const char* name,
+                                         GLMSStructField* fields,
+                                         int64_t fields_length) {
+  if (!env || !name || !fields) return 0;
+  if (!env->initialized)
+    GLMS_WARNING_RETURN(0, stderr, "env not initialized.\n");
+
+  if (hashy_map_get(&env->layouts, name) != 0)
+    GLMS_WARNING_RETURN(0, stderr, "Layout `%s` already registered.\n", name);
+
+  GLMSStructLayout* layout = glms_struct_layout_new(fields, fields_length);
+  if (!layout) return 0;
+
+  hashy_map_set(&env->layouts, name, layout);
+
+  GLMSAST* t = glms_env_new_ast(env, GLMS_AST_TYPE_STRUCT, false);
+  t->struct_layout = layout;
+
+  return glms_env_register_type(env, name, t,
+                                glms_env_struct_layout_constructor, 0, 0, 0);
+}
+
+GLMSAST* glms_env_new_ast_bound(GLMSEnv* env, const char* name, void* ptr) {
+  if (!env || !name || !ptr) return 0;
+
+  GLMSAST* t = glms_env_lookup_type(env, name);
+
+  if (!t || !t->struct_layout)
+    GLMS_WARNING_RETURN(0, stderr, "No layout registered for `%s`.\n", name);
+
+  GLMSAST* instance = glms_env_new_ast(env, GLMS_AST_TYPE_STRUCT, true);
+  instance->value_type = t;
+  instance->constructor = t->constructor;
+  instance->constructed = true;
+  instance->ptr = ptr;
+
+  return instance;
+}
+
+GLMSAST* glms_env_new_ast_typed_array(GLMSEnv* env, GLMSASTType element_type,
+                                      void* data, int64_t length,
+                                      int64_t stride, bool writable) {
+  if (!env || !data || length < 0) return 0;
+
+  size_t size = glms_ast_type_get_size(element_type);
+
+  if (size == 0)
+    GLMS_WARNING_RETURN(0, stderr, "Unsupported element type `%s`.\n",
+                        GLMS_AST_TYPE_STR[element_type]);
+
+  GLMSAST* ast = glms_env_new_ast(env, GLMS_AST_TYPE_TYPED_ARRAY, true);
+  ast->as.typed_array.data = data;
+  ast->as.typed_array.length = length;
+  ast->as.typed_array.stride = stride > 0 ? stride : (int64_t)size;
+  ast->as.typed_array.element_type = element_type;
+  ast->as.typed_array.writable = writable;
+
+  return ast;
+}
+
 GLMSAST* glms_env_register_any(GLMSEnv* env, const char* name, GLMSAST* ast) {
   if (!name || !ast || !env) return 0;
   hashy_map_set(&env->globals, name, ast);
   return ast;
 }
 
+GLMSAST* glms_env_lookup_global(GLMSEnv* env, const char* name) {
+  if (!name) return 0;
+
+  // the prototype at the end of the chain may be getting a module
+  // registered on another thread.
+  bool locked = glms_builtin_lock_lookup();
+  GLMSAST* v = 0;
+
+  for (GLMSEnv* e = env; e != 0 && !v; e = e->parent) {
+    v = (GLMSAST*)hashy_map_get(&e->globals, name);
+  }
+
+  glms_builtin_unlock_lookup(locked);
+  if (v) return v;
+
+  if (glms_builtin_load_module(name)) return glms_env_lookup_global(env, name);
+
+  return 0;
+}
+
+static GLMSAST* glms_env_lookup_type_entry(GLMSEnv* env, const char* name) {
+  bool locked = glms_builtin_lock_lookup();
+  GLMSAST* v = 0;
+
+  for (GLMSEnv* e = env; e != 0 && !v; e = e->parent) {
+    v = (GLMSAST*)hashy_map_get(&e->types, name);
+  }
+
+  glms_builtin_unlock_lookup(locked);
+  if (v) return v;
+
+  if (glms_builtin_load_module(name))
+    return glms_env_lookup_type_entry(env, name);
+
+  return 0;
+}
+
 GLMSAST* glms_env_lookup(GLMSEnv* env, const char* name) {
   if (!env || !name) return 0;
   if (!env->initialized)
     GLMS_WARNING_RETURN(0, stderr, "env not initialized.\n");
 
   GLMSAST* v = 0;
-  v = v ? v : (GLMSAST*)hashy_map_get(&env->globals, name);
-  v = v ? v : (GLMSAST*)hashy_map_get(&env->types, name);
+  v = v ? v : glms_env_lookup_global(env, name);
+  v = v ? v : glms_env_lookup_type_entry(env, name);
   v = v ? v : glms_stack_get(&env->stack, name);
 
   if (!v) return 0;
@@ -424,7 +1353,7 @@ GLMSAST* glms_env_lookup_function(GLMSEnv* env, const char* name) {
   if (!env->initialized)
     GLMS_WARNING_RETURN(0, stderr, "env not initialized.\n");
 
-  return (GLMSAST*)hashy_map_get(&env->globals, name);
+  return glms_env_lookup_global(env, name);
 }
 
 static GLMSAST* glms_env_get_type_for_private(GLMSEnv* env, GLMSAST* ast) {
@@ -458,7 +1387,8 @@ GLMSAST* glms_env_get_type_for(GLMSEnv* env, GLMSAST* ast) {
   GLMSAST* t = glms_env_get_type_for_private(env, ast);
   if (!t) return 0;
 
-  glms_env_apply_type(env, &env->eval, &env->stack, t);
+  // registered types are constructed once and shared by every instance.
+  if (!t->constructed) glms_env_apply_type(env, &env->eval, &env->stack, t);
 
   return t;
 }
@@ -469,8 +1399,8 @@ GLMSAST* glms_env_lookup_type(GLMSEnv* env, const char* name) {
   if (!env->initialized)
     GLMS_WARNING_RETURN(0, stderr, "env not initialized.\n");
 
-  GLMSAST* a = (GLMSAST*)hashy_map_get(&env->types, name);
-  GLMSAST* b = (GLMSAST*)hashy_map_get(&env->globals, name);
+  GLMSAST* a = glms_env_lookup_type_entry(env, name);
+  GLMSAST* b = glms_env_lookup_global(env, name);
   GLMSAST* c = glms_stack_get(&env->stack, name);
 
   if (a && a->constructor) return a;
@@ -496,6 +1426,10 @@ GLMSAST* glms_env_apply_type(GLMSEnv* env, GLMSEval* eval, GLMSStack* stack,
     if (ptr) return glms_env_apply_type(env, eval, stack, ptr);
   }
 
+  // nodes of a frozen env are shared between envs, and once typed
+  // by glms_env_freeze they are never written again.
+  if (env->frozen && ast->constructed) return ast;
+
   if (ast->type == GLMS_AST_TYPE_BINOP) return ast;
   //  if (ast->value_type != 0 && ast->constructor != 0) return ast;
   if (ast->constructed && ast->constructor != 0 && ast->to_string != 0) return ast;
@@ -538,19 +1472,11 @@ GLMSAST* glms_env_apply_type(GLMSEnv* env, GLMSEval* eval, GLMSStack* stack,
   // ast->swizzle = type->swizzle;
 
   /*
-if (type->props.initialized) {
-  HashyIterator it = {0};
-
-  while (hashy_map_iterate(&type->props, &it)) {
-    if (!it.bucket->key)
-      continue;
-    if (!it.bucket->value)
-      continue;
-
-    const char *key = it.bucket->key;
-    GLMSAST *value = (GLMSAST *)it.bucket->value;
+if (glms_ast_has_props(type)) {
+  GLMSASTPropIterator it = {0};
 
-    glms_ast_object_set_property(ast, key, value);
+  while (glms_ast_iterate_props(type, &it)) {
+    glms_ast_object_set_property(ast, it.key, it.value);
   }
  }*/
 
@@ -628,14 +1554,20 @@ int glms_env_export_docstrings(GLMSEnv* env, const char* filepath) {
 
   char* str0 = 0;
 
+  glms_builtin_load_modules();
+
   text_append(&str, "## Global functions\n\n");
-  if ((str0 = glms_env_export_docstrings_from_map(env, env->globals, true))) {
-    text_append(&str, str0);
+  for (GLMSEnv* e = env; e != 0; e = e->parent) {
+    if ((str0 = glms_env_export_docstrings_from_map(env, e->globals, true))) {
+      text_append(&str, str0);
+    }
   }
 
   text_append(&str, "## Types & structures\n\n");
-  if ((str0 = glms_env_export_docstrings_from_map(env, env->types, false))) {
-    text_append(&str, str0);
+  for (GLMSEnv* e = env; e != 0; e = e->parent) {
+    if ((str0 = glms_env_export_docstrings_from_map(env, e->types, false))) {
+      text_append(&str, str0);
+    }
   }
 
   FILE* fp = fopen(filepath, "w+");
@@ -4,13 +4,18 @@
 #include <glms/eval.h>
 #include <glms/io.h>
 #include <glms/macros.h>
+#include <glms/module.h>
+#include <glms/modules/typed_array.h>
+#include <glms/parallel.h>
 #include <string.h>
 #include <text/text.h>
+#include <time.h>
 
 #include "glms/ast.h"
 #include "glms/ast_type.h"
 #include "glms/emit/emit.h"
 #include "glms/fptr.h"
+#include "glms/shape.h"
 #include "glms/stack.h"
 #include "glms/string_view.h"
 #include "glms/token.h"
@@ -62,13 +67,28 @@ int glms_eval_init(GLMSEval *eval, struct GLMS_ENV_STRUCT *env) {
     return 1;
   eval->initialized = true;
   eval->env = env;
+  eval->seed = (unsigned int)time(0) ^ (unsigned int)(uintptr_t)eval;
   hashy_map_init(&eval->visited_paths, (HashyConfig){.capacity = GLMS_EVAL_VISITED_PATHS_MAP_CAPACITY});
+  hashy_map_init(&eval->modules, (HashyConfig){.capacity = GLMS_EVAL_VISITED_PATHS_MAP_CAPACITY});
   return 1;
 }
 
 int glms_eval_clear(GLMSEval *eval) {
   if (!eval || !eval->initialized) return 0;
   hashy_map_clear(&eval->visited_paths);
+
+  HashyIterator it = {0};
+  while (hashy_map_iterate(&eval->modules, &it)) {
+    if (!it.bucket->is_set) continue;
+    if (!it.bucket->value) continue;
+
+    glms_module_instance_free((GLMSModuleInstance *)it.bucket->value);
+  }
+  hashy_map_clear(&eval->modules);
+
+  glms_continuation_free(eval->suspended);
+  eval->suspended = 0;
+
   return 1;
 }
 
@@ -86,18 +106,15 @@ GLMSAST *glms_eval_lookup(GLMSEval *eval, GLMSStack *stack, const char *key) {
     return t;
   }
 
-  GLMSAST *global = (GLMSAST *)hashy_map_get(&eval->env->globals, key);
+  GLMSAST *global = glms_env_lookup_global(eval->env, key);
   if (global)
     return global;
 
   return glms_stack_get(stack, key);
 }
 
-int glms_eval_construct_string(GLMSEval *eval, GLMSAST *ptr, GLMSStack *stack) {
-
-  GLMSAST* astptr = glms_ast_get_ptr(*ptr);
-  if (astptr != 0) ptr = astptr;
-  
+static char *glms_eval_join_string(GLMSEval *eval, GLMSAST *ptr,
+				   GLMSStack *stack) {
   if (ptr->type != GLMS_AST_TYPE_STRING)
     return 0;
 
@@ -117,6 +134,16 @@ int glms_eval_construct_string(GLMSEval *eval, GLMSAST *ptr, GLMSStack *stack) {
     text_append(&str, childstr);
   }
 
+  return str;
+}
+
+int glms_eval_construct_string(GLMSEval *eval, GLMSAST *ptr, GLMSStack *stack) {
+
+  GLMSAST* astptr = glms_ast_get_ptr(*ptr);
+  if (astptr != 0) ptr = astptr;
+
+  char *str = glms_eval_join_string(eval, ptr, stack);
+
   if (str == 0) return 0;
 
   if (ptr->as.string.heap != 0) {
@@ -126,8 +153,7 @@ int glms_eval_construct_string(GLMSEval *eval, GLMSAST *ptr, GLMSStack *stack) {
 
   ptr->as.string.heap = str;
 
-  glms_GLMSAST_list_clear(ptr->children);
-  ptr->children = 0;
+  glms_ast_release_children(ptr);
 
   return 1;
 }
@@ -152,8 +178,148 @@ void glms_eval_push_args(GLMSEval *eval, GLMSStack *stack, GLMSAST *func,
   }
 }
 
+static int glms_eval_unbox_native(GLMSType type, GLMSAST value,
+				  GLMSNativeValue *out) {
+  GLMSAST *ptr = glms_ast_get_ptr(value);
+  if (ptr)
+    value = *ptr;
+
+  if (value.type != type.ast_type)
+    GLMS_ERROR_RETURN(0, stderr, "Expected `%s` but got `%s`.\n",
+		      GLMS_AST_TYPE_STR[type.ast_type],
+		      GLMS_AST_TYPE_STR[value.type]);
+
+  switch (type.ast_type) {
+  case GLMS_AST_TYPE_NUMBER: {
+    out->number = value.as.number.value;
+  }; break;
+  case GLMS_AST_TYPE_BOOL: {
+    out->boolean = value.as.boolean;
+  }; break;
+  case GLMS_AST_TYPE_VEC2: {
+    out->v4 = VEC4(value.as.v2.x, value.as.v2.y, 0, 0);
+  }; break;
+  case GLMS_AST_TYPE_VEC3: {
+    out->v4 = VEC4(value.as.v3.x, value.as.v3.y, value.as.v3.z, 0);
+  }; break;
+  case GLMS_AST_TYPE_VEC4: {
+    out->v4 = value.as.v4;
+  }; break;
+  case GLMS_AST_TYPE_MAT3: {
+    out->m3 = value.as.m3;
+  }; break;
+  case GLMS_AST_TYPE_MAT4: {
+    out->m4 = value.as.m4;
+  }; break;
+  default: {
+    GLMS_ERROR_RETURN(0, stderr, "`%s` cannot be passed to a native.\n",
+		      GLMS_AST_TYPE_STR[type.ast_type]);
+  }; break;
+  }
+
+  return 1;
+}
+
+static GLMSAST glms_eval_box_native(GLMSType type, GLMSNativeValue value) {
+  GLMSAST result = (GLMSAST){.type = type.ast_type};
+
+  switch (type.ast_type) {
+  case GLMS_AST_TYPE_NUMBER: {
+    result.as.number.value = value.number;
+  }; break;
+  case GLMS_AST_TYPE_BOOL: {
+    result.as.boolean = value.boolean;
+  }; break;
+  case GLMS_AST_TYPE_VEC2: {
+    result.as.v2 = value.v2;
+  }; break;
+  case GLMS_AST_TYPE_VEC3: {
+    result.as.v3 = value.v3;
+  }; break;
+  case GLMS_AST_TYPE_VEC4: {
+    result.as.v4 = value.v4;
+  }; break;
+  case GLMS_AST_TYPE_MAT3: {
+    result.as.m3 = value.m3;
+  }; break;
+  case GLMS_AST_TYPE_MAT4: {
+    result.as.m4 = value.m4;
+  }; break;
+  default: {
+    result.type = GLMS_AST_TYPE_VOID;
+  }; break;
+  }
+
+  return result;
+}
+
+static bool glms_eval_native_matches(GLMSFunctionSignature signature,
+				     GLMSASTBuffer args) {
+  if (args.length != signature.args_length)
+    return false;
+
+  for (int i = 0; i < signature.args_length; i++) {
+    GLMSAST *ptr = glms_ast_get_ptr(args.items[i]);
+    GLMSAST value = ptr ? *ptr : args.items[i];
+
+    if (value.type != signature.args[i].ast_type)
+      return false;
+  }
+
+  return true;
+}
+
+// Arguments reaching a native are already evaluated, so they are
+// only unboxed here and the result is boxed once. A native registered
+// with several signatures is called with the first one matching the
+// arguments.
+static GLMSAST glms_eval_call_native(GLMSEval *eval, GLMSStack *stack,
+				     GLMSAST *func, GLMSASTBuffer args) {
+  const char *fname =
+      func->as.func.name ? func->as.func.name : glms_ast_get_name(func);
+
+  if (!func->as.func.signatures.initialized ||
+      func->as.func.signatures.length <= 0)
+    GLMS_ERROR_RETURN((GLMSAST){.type = GLMS_AST_TYPE_UNDEFINED}, stderr,
+		      "`%s` has no signature.\n", fname);
+
+  GLMSFunctionSignature signature = func->as.func.signatures.items[0];
+
+  for (int64_t i = 0; func->as.func.signatures.length > 1 &&
+		     i < func->as.func.signatures.length;
+       i++) {
+    if (glms_eval_native_matches(func->as.func.signatures.items[i], args)) {
+      signature = func->as.func.signatures.items[i];
+      break;
+    }
+  }
+
+  if (args.length != signature.args_length)
+    GLMS_ERROR_RETURN((GLMSAST){.type = GLMS_AST_TYPE_UNDEFINED}, stderr,
+		      "`%s` expects %d arguments but got %ld.\n", fname,
+		      signature.args_length, args.length);
+
+  GLMSNativeValue regs[GLMS_NATIVE_ARGS_CAP];
+
+  for (int i = 0; i < signature.args_length; i++) {
+    if (!glms_eval_unbox_native(signature.args[i], args.items[i], &regs[i]))
+      return (GLMSAST){.type = GLMS_AST_TYPE_UNDEFINED};
+  }
+
+  GLMSAST result =
+      glms_eval_box_native(signature.return_type, func->native(regs));
+
+  if (result.type == GLMS_AST_TYPE_NUMBER || result.type == GLMS_AST_TYPE_BOOL)
+    return result;
+
+  return glms_eval(eval, result, stack);
+}
+
 GLMSAST glms_eval_call_func(GLMSEval *eval, GLMSStack *stack, GLMSAST *func,
 			    GLMSASTBuffer args) {
+  if (func->native)
+    return glms_eval_call_native(eval, stack, func, args);
+
   GLMSFPTR fptr = func->fptr;
 
   GLMSAST *self = glms_stack_get(stack, "self");
@@ -180,18 +346,13 @@ GLMSAST glms_eval_call_func(GLMSEval *eval, GLMSStack *stack, GLMSAST *func,
     glms_stack_init(&tmp_stack);
     glms_stack_copy(*stack, &tmp_stack);
 
-    if (args.length > 0 && func->props.initialized) {
-      HashyIterator it = {0};
+    if (args.length > 0 && glms_ast_has_props(func)) {
+      GLMSASTPropIterator it = {0};
 
       int64_t i = 0;
-      while (hashy_map_iterate(&func->props, &it)) {
-	if (!it.bucket->is_set)
-	  continue;
-	if (!it.bucket->value)
-	  continue;
-
-	const char *key = it.bucket->key.value;
-	GLMSAST *val = (GLMSAST *)it.bucket->value;
+      while (glms_ast_iterate_props(func, &it)) {
+	const char *key = it.key;
+	GLMSAST *val = it.value;
 	GLMSAST value = glms_eval(eval, *val, &tmp_stack);
 
 	GLMSAST arg_value = glms_eval(eval, args.items[i], &tmp_stack);
@@ -200,7 +361,6 @@ GLMSAST glms_eval_call_func(GLMSEval *eval, GLMSStack *stack, GLMSAST *func,
 	i++;
 
 	if (i >= args.length) {
-	  hashy_key_list_clear(&it.keys);
 	  break;
 	}
       }
@@ -258,7 +418,13 @@ GLMSAST glms_eval_call_func(GLMSEval *eval, GLMSStack *stack, GLMSAST *func,
       }
     }
 
+    // functions of a module run in the importer's instance of it.
+    GLMSEnv *module = eval->module;
+    if (func->env_ref != 0 && func->env_ref->imported)
+      eval->module = func->env_ref;
+
     GLMSAST result = glms_eval(eval, *func->as.func.body, &tmp_stack);
+    eval->module = module;
     glms_stack_clear(&tmp_stack);
     return result;
   }
@@ -309,14 +475,14 @@ GLMSAST glms_eval_call(GLMSEval *eval, GLMSAST ast, GLMSStack *stack) {
       //	glms_GLMSAST_buffer_clear(&atoms);
       //      } else {
 
-      overload = overload ? overload : glms_ast_get_func_overload(arg, name);
+      overload = overload ? overload : glms_ast_get_func_overload(arg, name, eval->env);
       glms_GLMSAST_buffer_push(&args, arg);
       // }
     }
   }
 
   if (!func) {
-    GLMS_WARNING_RETURN(ast, stderr, "No such function `%s`\n", name);
+    GLMS_ERROR_RETURN(ast, stderr, "No such function `%s`\n", name);
   }
 
   GLMSAST result = {0};
@@ -359,6 +525,43 @@ GLMSAST glms_eval_compound(GLMSEval *eval, GLMSAST ast, GLMSStack *stack) {
   return ast;
 }
 
+bool glms_eval_can_write(GLMSEval *eval, GLMSAST *ast) {
+  if (!ast)
+    return true;
+
+  GLMSAST *ptr = glms_ast_get_ptr(*ast);
+  if (ptr)
+    ast = ptr;
+
+  if (ast->env_ref == 0 || ast->env_ref == eval->env)
+    return true;
+
+  if (eval->env->isolated)
+    GLMS_ERROR_RETURN(false, stderr,
+		      "Values outside of a parallel task are read-only.\n");
+
+  // like the nodes of a parsed module or a snapshot, which envs on any
+  // thread share. Importers write to their own instance of a module.
+  if (ast->env_ref->frozen)
+    GLMS_ERROR_RETURN(false, stderr,
+		      "Values of a frozen env are read-only.\n");
+
+  return true;
+}
+
+GLMSAST *glms_eval_copy_for(GLMSEval *eval, GLMSAST *target, GLMSAST value) {
+  GLMSAST *ptr = target ? glms_ast_get_ptr(*target) : 0;
+  if (ptr)
+    target = ptr;
+
+  GLMSEnv *owner = target ? target->env_ref : 0;
+
+  if (!eval->env->scoped || owner == 0 || owner == eval->env)
+    return glms_ast_copy(value, eval->env);
+
+  return glms_parallel_adopt(owner, eval->env, value);
+}
+
 GLMSAST glms_eval_assign(GLMSEval *eval, GLMSAST left, GLMSAST right,
 			 GLMSStack *stack) {
   const char *name = 0;
@@ -376,7 +579,17 @@ GLMSAST glms_eval_assign(GLMSEval *eval, GLMSAST left, GLMSAST right,
   }
 
   if (existing) {
-    glms_ast_assign(existing, ptr ? (*ptr) : right, eval, stack);
+    if (!glms_eval_can_write(eval, existing))
+      return left;
+
+    GLMSAST value = ptr ? (*ptr) : right;
+
+    // the list and properties would be shared with `existing`.
+    if (eval->env->scoped &&
+	(value.children != 0 || glms_ast_has_props(&value)))
+      value = *glms_eval_copy_for(eval, existing, value);
+
+    glms_ast_assign(existing, value, eval, stack);
   } else if (name) {
     GLMSAST *copy = ptr ? ptr : glms_ast_copy(right, eval->env);
     GLMSAST t = {0};
@@ -398,20 +611,37 @@ GLMSAST glms_eval_assign(GLMSEval *eval, GLMSAST left, GLMSAST right,
   return right;
 }
 
+// code parsed in a parent env (a snapshot, the builtin prototype or an
+// imported module) is resolved in the env running it, never in the parent.
+static GLMSEnv *glms_eval_get_env_for(GLMSEval *eval, GLMSAST ast) {
+  if (!ast.env_ref)
+    return 0;
+
+  if (eval->module != 0 && eval->module->parent == ast.env_ref)
+    return eval->module;
+
+  for (GLMSEnv *e = eval->env->parent; e != 0; e = e->parent) {
+    if (e == ast.env_ref)
+      return eval->env;
+  }
+
+  return ast.env_ref;
+}
+
 GLMSAST glms_eval_id(GLMSEval *eval, GLMSAST ast, GLMSStack *stack) {
   const char *name = glms_string_view_get_value(&ast.as.id.value);
   GLMSAST *value = 0;
+  GLMSEnv *env = glms_eval_get_env_for(eval, ast);
 
-  value = ast.env_ref ? glms_env_lookup(ast.env_ref, name) : 0;
+  value = env ? glms_env_lookup(env, name) : 0;
   value = value ? value : glms_eval_lookup(eval, stack, name);
 
   if (value != 0) {
-    glms_env_apply_type(ast.env_ref ? ast.env_ref : eval->env, eval, stack,
-			value);
+    glms_env_apply_type(env ? env : eval->env, eval, stack, value);
     return (GLMSAST){.type = GLMS_AST_TYPE_STACK_PTR, .as.stackptr.ptr = value};
   } else if (value == 0 && ((ast.flags == 0) || (ast.flags->length <= 0))) {
     if (!GLMS_IS_EMIT()) {
-      GLMS_WARNING_RETURN((GLMSAST){.type = GLMS_AST_TYPE_UNDEFINED}, stderr,
+      GLMS_ERROR_RETURN((GLMSAST){.type = GLMS_AST_TYPE_UNDEFINED}, stderr,
 			"`%s` is not defined.", name);
     }
   }
@@ -425,7 +655,13 @@ GLMSAST glms_eval_stack_ptr(GLMSEval *eval, GLMSAST ast, GLMSStack *stack) {
   if (ptr) {
     glms_env_apply_type(eval->env, eval, stack, ptr);
 
-    glms_eval_construct_string(eval, ptr, stack);
+    // nodes of frozen envs may be read by several threads at once.
+    if (ptr->env_ref != 0 && ptr->env_ref->frozen) {
+      if (ptr->type == GLMS_AST_TYPE_STRING && ptr->children != 0)
+	return glms_eval_string(eval, *ptr, stack);
+    } else {
+      glms_eval_construct_string(eval, ptr, stack);
+    }
   }
 
   return ast;
@@ -445,10 +681,14 @@ GLMSAST glms_eval_unop_left(GLMSEval *eval, GLMSAST ast, GLMSStack *stack) {
   }; break;
   case GLMS_TOKEN_TYPE_ADD_ADD: {
     GLMSAST left = glms_eval(eval, *ast.as.unop.left, stack);
+    if (!glms_eval_can_write(eval, &left))
+      return left;
     return glms_ast_op_add_add(&left);
   }; break;
   case GLMS_TOKEN_TYPE_SUB_SUB: {
     GLMSAST left = glms_eval(eval, *ast.as.unop.left, stack);
+    if (!glms_eval_can_write(eval, &left))
+      return left;
     return glms_ast_op_sub_sub(&left);
   }; break;
   default: {
@@ -477,10 +717,14 @@ GLMSAST glms_eval_unop_right(GLMSEval *eval, GLMSAST ast, GLMSStack *stack) {
   }; break;
   case GLMS_TOKEN_TYPE_ADD_ADD: {
     GLMSAST right = glms_eval(eval, *ast.as.unop.right, stack);
+    if (!glms_eval_can_write(eval, &right))
+      return right;
     return glms_ast_op_add_add(&right);
   }; break;
   case GLMS_TOKEN_TYPE_SUB_SUB: {
     GLMSAST right = glms_eval(eval, *ast.as.unop.right, stack);
+    if (!glms_eval_can_write(eval, &right))
+      return right;
     return glms_ast_op_sub_sub(&right);
   }; break;
   case GLMS_TOKEN_TYPE_SPECIAL_RETURN: {
@@ -506,9 +750,172 @@ GLMSAST glms_eval_unop(GLMSEval *eval, GLMSAST ast, GLMSStack *stack) {
   return glms_eval_unop_right(eval, ast, stack);
 }
 
+static GLMSStructLayout *glms_eval_get_struct_layout(GLMSEval *eval,
+						     GLMSAST *L);
+
+static GLMSAST glms_eval_access_by_key_from(GLMSEval *eval, GLMSAST ast,
+					    GLMSAST left, GLMSStack *stack);
+
+// a frozen env may be read by several threads at once, and the workers
+// of glms_parallel_run are cleared before the caller reads its values
+// again, so neither may replace the elements of someone else's container.
+static bool glms_eval_can_unshare(GLMSEval *eval, GLMSAST *container) {
+  GLMSEnv *owner = container->env_ref;
+
+  if (owner == eval->env)
+    return true;
+  if (eval->env->isolated)
+    return false;
+
+  return owner == 0 || !owner->frozen;
+}
+
+static GLMSAST glms_eval_access_index_from(GLMSEval *eval, GLMSAST ast,
+					   GLMSAST left, GLMSStack *stack);
+
+static int64_t glms_eval_access_get_index(GLMSEval *eval, GLMSAST ast,
+					  GLMSStack *stack);
+
+static GLMSAST glms_eval_access_index_for_write(GLMSEval *eval, GLMSAST ast,
+						GLMSAST left, GLMSStack *stack);
+
+static bool glms_eval_is_assign_op(GLMSTokenType op) {
+  return op == GLMS_TOKEN_TYPE_EQUALS || op == GLMS_TOKEN_TYPE_ADD_EQUALS ||
+	 op == GLMS_TOKEN_TYPE_SUB_EQUALS || op == GLMS_TOKEN_TYPE_MUL_EQUALS ||
+	 op == GLMS_TOKEN_TYPE_DIV_EQUALS;
+}
+
+// Combines the current value of a host memory location with
+// the right hand side of a (compound) assignment.
+static GLMSAST glms_eval_assign_value(GLMSEval *eval, GLMSStack *stack,
+				      GLMSTokenType op, GLMSAST current,
+				      GLMSAST value) {
+  GLMSTokenType binop = GLMS_TOKEN_TYPE_EQUALS;
+
+  switch (op) {
+  case GLMS_TOKEN_TYPE_ADD_EQUALS: {
+    binop = GLMS_TOKEN_TYPE_ADD;
+  }; break;
+  case GLMS_TOKEN_TYPE_SUB_EQUALS: {
+    binop = GLMS_TOKEN_TYPE_SUB;
+  }; break;
+  case GLMS_TOKEN_TYPE_MUL_EQUALS: {
+    binop = GLMS_TOKEN_TYPE_MUL;
+  }; break;
+  case GLMS_TOKEN_TYPE_DIV_EQUALS: {
+    binop = GLMS_TOKEN_TYPE_DIV;
+  }; break;
+  default: {
+    return value;
+  }; break;
+  }
+
+  GLMSAST result = {0};
+  GLMSASTOperatorOverload overload =
+      glms_ast_get_op_overload(current, binop, eval->env);
+
+  if (overload != 0 && overload(eval, stack, &current, &value, &result))
+    return glms_eval(eval, result, stack);
+
+  switch (binop) {
+  case GLMS_TOKEN_TYPE_ADD:
+    return glms_ast_op_add(current, value);
+  case GLMS_TOKEN_TYPE_SUB:
+    return glms_ast_op_sub(current, value);
+  case GLMS_TOKEN_TYPE_MUL:
+    return glms_ast_op_mul(current, value);
+  default:
+    return glms_ast_op_div(current, value);
+  }
+}
+
+static GLMSAST glms_eval_assign_right(GLMSEval *eval, GLMSAST ast,
+				      GLMSStack *stack) {
+  GLMSAST value = glms_eval(eval, *ast.as.binop.right, stack);
+  GLMSAST *vptr = glms_ast_get_ptr(value);
+  return vptr ? *vptr : value;
+}
+
+// Assigns straight into the host memory behind a struct layout field
+// or a typed array element. Returns 0 if `object` is neither.
+static int glms_eval_assign_host(GLMSEval *eval, GLMSAST ast, GLMSAST object,
+				 GLMSStack *stack, GLMSAST *out) {
+  GLMSAST *ptr = glms_ast_get_ptr(object);
+  GLMSAST *L = ptr ? ptr : &object;
+  GLMSAST access = *ast.as.binop.left;
+  GLMSTokenType op = ast.as.binop.op;
+
+  if (access.as.access.right->type == GLMS_AST_TYPE_ARRAY) {
+    if (L->type != GLMS_AST_TYPE_TYPED_ARRAY)
+      return 0;
+
+    int64_t idx = glms_eval_access_get_index(eval, access, stack);
+    GLMSAST value = glms_eval_assign_right(eval, ast, stack);
+    GLMSAST current = {0};
+
+    *out = (GLMSAST){.type = GLMS_AST_TYPE_UNDEFINED};
+
+    if (op != GLMS_TOKEN_TYPE_EQUALS &&
+	!glms_typed_array_get(L, idx, &current))
+      return 1;
+
+    value = glms_eval_assign_value(eval, stack, op, current, value);
+
+    if (glms_typed_array_set(L, idx, value))
+      *out = value;
+
+    return 1;
+  }
+
+  GLMSStructLayout *layout = glms_eval_get_struct_layout(eval, L);
+  if (!layout)
+    return 0;
+
+  GLMSAST *site = access.as.access.right;
+  int64_t slot = glms_struct_layout_lookup(layout, site,
+					   glms_ast_get_string_value(site));
+
+  *out = (GLMSAST){.type = GLMS_AST_TYPE_UNDEFINED};
+
+  if (slot < 0)
+    GLMS_ERROR_RETURN(1, stderr, "No such field `%s`.\n",
+		      glms_ast_get_string_value(site));
+
+  GLMSAST value = glms_eval_assign_right(eval, ast, stack);
+  GLMSAST current = {0};
+
+  if (op != GLMS_TOKEN_TYPE_EQUALS &&
+      !glms_struct_layout_read(layout, slot, L->ptr, &current))
+    return 1;
+
+  value = glms_eval_assign_value(eval, stack, op, current, value);
+
+  if (glms_struct_layout_write(layout, slot, L->ptr, value))
+    *out = value;
+
+  return 1;
+}
+
 GLMSAST glms_eval_binop(GLMSEval *eval, GLMSAST ast, GLMSStack *stack) {
   // bool is_assign = ast.as.binop.op == GLMS_TOKEN_TYPE_EQUALS;
-  GLMSAST left = glms_eval(eval, *ast.as.binop.left, stack);
+  GLMSAST left = {0};
+
+  if (glms_eval_is_assign_op(ast.as.binop.op) &&
+      ast.as.binop.left->type == GLMS_AST_TYPE_ACCESS) {
+    GLMSAST access = *ast.as.binop.left;
+    GLMSAST object = glms_eval(eval, *access.as.access.left, stack);
+    GLMSAST result = {0};
+
+    if (glms_eval_assign_host(eval, ast, object, stack, &result))
+      return result;
+
+    left = access.as.access.right->type == GLMS_AST_TYPE_ARRAY
+	       ? glms_eval_access_index_for_write(eval, access, object, stack)
+	       : glms_eval_access_by_key_from(eval, access, object, stack);
+  } else {
+    left = glms_eval(eval, *ast.as.binop.left, stack);
+  }
+
   GLMSAST right = glms_eval(eval, *ast.as.binop.right, stack);
 
   GLMSAST *ptr_left = 0;
@@ -526,6 +933,11 @@ GLMSAST glms_eval_binop(GLMSEval *eval, GLMSAST ast, GLMSStack *stack) {
     r = *ptr_right;
   }
 
+  if (glms_eval_is_assign_op(ast.as.binop.op) &&
+      ast.as.binop.op != GLMS_TOKEN_TYPE_EQUALS &&
+      !glms_eval_can_write(eval, ptr_left))
+    return left;
+
   GLMSASTOperatorOverload overload =
       glms_ast_get_op_overload(l, ast.as.binop.op, eval->env);
 
@@ -683,7 +1095,7 @@ GLMSAST glms_eval_block_switch(GLMSEval *eval, GLMSAST ast, GLMSStack *stack) {
   for (int64_t i = 0; i < body->children->length; i++) {
     GLMSAST *child = body->children->items[i];
     if (child->type != GLMS_AST_TYPE_BLOCK)
-      GLMS_WARNING_RETURN(ast, stderr, "Invalid switch body item.\n");
+      GLMS_ERROR_RETURN(ast, stderr, "Invalid switch body item.\n");
     if (!child->as.block.expr || !child->as.block.body)
       continue;
 
@@ -698,9 +1110,9 @@ GLMSAST glms_eval_block_switch(GLMSEval *eval, GLMSAST ast, GLMSStack *stack) {
 }
 
 GLMSAST glms_eval_ternary(GLMSEval *eval, GLMSAST ast, GLMSStack *stack) {
-  if (!ast.as.ternary.condition) GLMS_WARNING_RETURN(ast, stderr, "Conditionless ternary.");
-  if (!ast.as.ternary.expr1) GLMS_WARNING_RETURN(ast, stderr, "Missing expr1 in ternary.");
-  if (!ast.as.ternary.expr2) GLMS_WARNING_RETURN(ast, stderr, "Missing expr2 in ternary.");
+  if (!ast.as.ternary.condition) GLMS_ERROR_RETURN(ast, stderr, "Conditionless ternary.");
+  if (!ast.as.ternary.expr1) GLMS_ERROR_RETURN(ast, stderr, "Missing expr1 in ternary.");
+  if (!ast.as.ternary.expr2) GLMS_ERROR_RETURN(ast, stderr, "Missing expr2 in ternary.");
   
   GLMSAST condition = glms_eval(eval, *ast.as.ternary.condition, stack);
 
@@ -733,8 +1145,56 @@ GLMSAST glms_eval_block(GLMSEval *eval, GLMSAST ast, GLMSStack *stack) {
   return ast;
 }
 
-GLMSAST glms_eval_access_by_key(GLMSEval *eval, GLMSAST ast, GLMSStack *stack) {
-  GLMSAST left = glms_eval(eval, *ast.as.access.left, stack);
+// Every access site remembers the slot of the last shape it saw,
+// so repeated accesses on objects of the same shape skip the lookup.
+static GLMSAST *glms_eval_access_cached(GLMSEval *eval, GLMSAST *site,
+					GLMSAST *L) {
+  if (!site || !glms_ast_has_props(L))
+    return 0;
+  if (L->json != 0 || L->type == GLMS_AST_TYPE_STACK)
+    return 0;
+
+  if (site->cached_shape == L->shape)
+    return L->slots[site->cached_slot];
+
+  const char *key = glms_ast_get_string_value(site);
+  int64_t slot = glms_shape_lookup(L->shape, key);
+
+  if (slot < 0)
+    return 0;
+
+  // sites parsed by a frozen env may be read by several threads at once,
+  // they keep what they cached before it was frozen. Dictionary shapes
+  // are freed with their node, so they are never cached.
+  if ((site->env_ref != 0 && site->env_ref->frozen) || L->shape->dictionary)
+    return L->slots[slot];
+
+  site->cached_shape = L->shape;
+  site->cached_slot = slot;
+
+  return L->slots[slot];
+}
+
+// Instances of types registered with glms_env_register_struct_layout
+// keep their fields in host memory behind `ptr`.
+static GLMSStructLayout *glms_eval_get_struct_layout(GLMSEval *eval,
+						     GLMSAST *L) {
+  if (!L->ptr || L->type != GLMS_AST_TYPE_STRUCT)
+    return 0;
+  if (L->value_type)
+    return L->value_type->struct_layout;
+
+  GLMSAST *t = glms_env_get_type_for(eval->env, L);
+  if (!t || !t->struct_layout)
+    return 0;
+
+  L->value_type = t;
+
+  return t->struct_layout;
+}
+
+static GLMSAST glms_eval_access_by_key_from(GLMSEval *eval, GLMSAST ast,
+					    GLMSAST left, GLMSStack *stack) {
   GLMSAST right = *ast.as.access.right;
 
   GLMSAST *ptr = glms_ast_get_ptr(left);
@@ -748,9 +1208,25 @@ GLMSAST glms_eval_access_by_key(GLMSEval *eval, GLMSAST ast, GLMSStack *stack) {
     }
   }
 
-  const char *key = glms_ast_get_string_value(&right);
+  GLMSStructLayout *layout =
+      right.type == GLMS_AST_TYPE_ID ? glms_eval_get_struct_layout(eval, L) : 0;
 
-  GLMSAST *value = glms_ast_access_by_key(L, key, eval->env);
+  if (layout != 0) {
+    GLMSAST field = {0};
+    int64_t slot = glms_struct_layout_lookup(layout, ast.as.access.right,
+					     glms_ast_get_string_value(&right));
+
+    if (glms_struct_layout_read(layout, slot, L->ptr, &field))
+      return field;
+  }
+
+  GLMSAST *site = ast.as.access.right;
+  GLMSAST *value = glms_eval_access_cached(eval, site, L);
+
+  if (!value) {
+    const char *key = glms_ast_get_string_value(&right);
+    value = glms_ast_access_by_key(L, key, eval->env);
+  }
 
   GLMSAST *vptr = value ? glms_ast_get_ptr(*value) : 0;
 
@@ -781,30 +1257,20 @@ GLMSAST glms_eval_access_by_key(GLMSEval *eval, GLMSAST ast, GLMSStack *stack) {
   return (GLMSAST){.type = GLMS_AST_TYPE_UNDEFINED};
 }
 
-GLMSAST glms_eval_access(GLMSEval *eval, GLMSAST ast, GLMSStack *stack) {
-  GLMSAST right = *ast.as.access.right;
-
-  if (right.type != GLMS_AST_TYPE_ARRAY) {
-    return glms_eval_access_by_key(eval, ast, stack);
-  }
+GLMSAST glms_eval_access_by_key(GLMSEval *eval, GLMSAST ast, GLMSStack *stack) {
+  GLMSAST left = glms_eval(eval, *ast.as.access.left, stack);
+  return glms_eval_access_by_key_from(eval, ast, left, stack);
+}
 
-  right = glms_eval(eval, *ast.as.access.right, stack);
+static int64_t glms_eval_access_get_index(GLMSEval *eval, GLMSAST ast,
+					  GLMSStack *stack) {
+  GLMSAST right = glms_eval(eval, *ast.as.access.right, stack);
 
   GLMSAST *ptr = glms_ast_get_ptr(right);
 
   if (ptr)
     right = *ptr;
 
-  GLMSAST left = glms_eval(eval, *ast.as.access.left, stack);
-
-  GLMSAST *leftptr = glms_ast_get_ptr(left);
-
-  if (leftptr)
-    left = *leftptr;
-
-  if (left.type == GLMS_AST_TYPE_UNDEFINED) {
-    GLMS_WARNING_RETURN(ast, stderr, "cannot index undefined.\n");
-  }
   GLMSAST *right_value = right.children != 0 && right.children->length > 0
 			     ? right.children->items[0]
 			     : 0;
@@ -817,21 +1283,90 @@ GLMSAST glms_eval_access(GLMSEval *eval, GLMSAST ast, GLMSStack *stack) {
   GLMSAST accessor =
       right_value ? glms_eval(eval, *right_value, stack) : (GLMSAST){0};
 
-  int64_t idx = (int64_t)glms_ast_number(accessor);
+  return (int64_t)glms_ast_number(accessor);
+}
+
+static GLMSAST glms_eval_access_index_from(GLMSEval *eval, GLMSAST ast,
+					   GLMSAST left, GLMSStack *stack) {
+  int64_t idx = glms_eval_access_get_index(eval, ast, stack);
+
+  GLMSAST *leftptr = glms_ast_get_ptr(left);
+
+  if (leftptr)
+    left = *leftptr;
+
+  GLMSAST *container = leftptr ? leftptr : &left;
 
-  GLMSAST *v = glms_ast_access_by_index(&left, idx, eval->env);
+  if (left.type == GLMS_AST_TYPE_UNDEFINED) {
+    GLMS_ERROR_RETURN(ast, stderr, "cannot index undefined.\n");
+  }
+
+  if (container->type == GLMS_AST_TYPE_TYPED_ARRAY) {
+    GLMSAST element = {0};
+    if (!glms_typed_array_get(container, idx, &element))
+      return (GLMSAST){.type = GLMS_AST_TYPE_UNDEFINED};
+    return element;
+  }
 
+  GLMSAST *v = glms_ast_access_by_index(container, idx, eval->env);
   if (!v)
     return ast;
 
+  // elements carrying their own storage can be written through,
+  // so they must not stay shared with other copies of the array.
+  // Containers of other envs are read as they are, see
+  // glms_eval_can_unshare.
+  if ((v->children != 0 || glms_ast_has_props(v)) &&
+      glms_ast_is_shared(container) &&
+      glms_eval_can_unshare(eval, container)) {
+    glms_ast_make_unique(container, eval->env);
+    v = glms_ast_access_by_index(container, idx, eval->env);
+
+    if (!v)
+      return ast;
+  }
+
   GLMSAST result = glms_eval(eval, *v, stack);
   return result;
 }
 
+// The element itself, so that assigning to it writes into the array.
+// A shared list is copied first, other copies keep their values.
+static GLMSAST glms_eval_access_index_for_write(GLMSEval *eval, GLMSAST ast,
+						GLMSAST left, GLMSStack *stack) {
+  GLMSAST *container = glms_ast_get_ptr(left);
+
+  if (!container || container->type != GLMS_AST_TYPE_ARRAY)
+    return glms_eval_access_index_from(eval, ast, left, stack);
+
+  int64_t idx = glms_eval_access_get_index(eval, ast, stack);
+
+  if (glms_ast_is_shared(container) && glms_eval_can_unshare(eval, container))
+    glms_ast_make_unique(container, eval->env);
+
+  GLMSAST *v = glms_ast_access_by_index(container, idx, eval->env);
+  if (!v)
+    return ast;
+
+  return (GLMSAST){.type = GLMS_AST_TYPE_STACK_PTR, .as.stackptr.ptr = v};
+}
+
+GLMSAST glms_eval_access(GLMSEval *eval, GLMSAST ast, GLMSStack *stack) {
+  GLMSAST right = *ast.as.access.right;
+
+  if (right.type != GLMS_AST_TYPE_ARRAY) {
+    return glms_eval_access_by_key(eval, ast, stack);
+  }
+
+  GLMSAST left = glms_eval(eval, *ast.as.access.left, stack);
+
+  return glms_eval_access_index_from(eval, ast, left, stack);
+}
+
 GLMSAST glms_eval_function(GLMSEval *eval, GLMSAST ast, GLMSStack *stack) {
   // ast->as.func.id = glms_eval(eval, ast->as.func.id, stack);
 
-  if (ast.fptr)
+  if (ast.fptr || ast.native)
     return ast;
 
   const char *fname = glms_ast_get_name(&ast);
@@ -856,7 +1391,7 @@ GLMSAST glms_eval_typedef(GLMSEval *eval, GLMSAST ast, GLMSStack *stack) {
   const char *fname = glms_ast_get_name(id);
 
   if (!fname)
-    GLMS_WARNING_RETURN(ast, stderr, "Expected a name to exist.\n");
+    GLMS_ERROR_RETURN(ast, stderr, "Expected a name to exist.\n");
 
   if (!glms_stack_get(stack, fname)) {
     glms_stack_push(stack, fname, glms_ast_copy(factor, eval->env));
@@ -866,20 +1401,15 @@ GLMSAST glms_eval_typedef(GLMSEval *eval, GLMSAST ast, GLMSStack *stack) {
 }
 
 GLMSAST glms_eval_struct(GLMSEval *eval, GLMSAST ast, GLMSStack *stack) {
-  if (ast.props.initialized == false)
+  if (!glms_ast_has_props(&ast))
     return ast;
 
   GLMSAST *new_ast = glms_ast_copy(ast, eval->env);
 
-  HashyIterator it = {0};
-  while (hashy_map_iterate(&ast.props, &it)) {
-    if (!it.bucket->is_set)
-      continue;
-    if (!it.bucket->value)
-      continue;
-
-    const char *key = it.bucket->key.value;
-    GLMSAST *value = (GLMSAST *)it.bucket->value;
+  GLMSASTPropIterator it = {0};
+  while (glms_ast_iterate_props(&ast, &it)) {
+    const char *key = it.key;
+    GLMSAST *value = it.value;
 
     GLMSAST eval_value = glms_eval(eval, *value, stack);
     glms_ast_object_set_property(new_ast, key,
@@ -892,37 +1422,6 @@ GLMSAST glms_eval_struct(GLMSEval *eval, GLMSAST ast, GLMSStack *stack) {
   return ptr_ast;
 }
 
-GLMSAST glms_eval_import_extension(GLMSEval *eval, GLMSAST ast,
-				   GLMSStack *stack, const char *path) {
-  GLMSAST result = (GLMSAST){.type = GLMS_AST_TYPE_UNDEFINED};
-
-  if (!glms_file_exists(path))
-    GLMS_WARNING_RETURN(result, stderr, "No such file `%s`\n", path);
-
-  GLMSExtensionEntryFunc func =
-      glms_load_symbol_function(path, "glms_extension_entry");
-
-  if (!func)
-    GLMS_WARNING_RETURN(result, stderr, "Could not load `%s`\n", path);
-
-  GLMSEnv *import_env = NEW(GLMSEnv); // TODO: free this
-  glms_env_init(import_env, 0, path, eval->env->config);
-  func(import_env);
-  // func(eval->env);
-
-  GLMSAST *result_ast = glms_env_new_ast(eval->env, GLMS_AST_TYPE_STACK, false);
-  result_ast->as.stack.env = import_env;
-
-  const char *id_name =
-      glms_string_view_get_value(&ast.as.import.id->as.id.value);
-
-  glms_stack_push(stack, id_name, result_ast);
-
-  return (GLMSAST){.type = GLMS_AST_TYPE_STACK_PTR,
-		   .as.stackptr.ptr = result_ast};
-  //*out = (GLMSAST){ .type = GLMS_AST_TYPE_BOOL, .as.boolean = true };
-}
-
 GLMSAST glms_eval_import(GLMSEval *eval, GLMSAST ast, GLMSStack *stack) {
   const char *path = glms_string_view_get_value(&ast.as.import.value);
   if (!path)
@@ -932,8 +1431,8 @@ GLMSAST glms_eval_import(GLMSEval *eval, GLMSAST ast, GLMSStack *stack) {
       glms_file_exists(path) ? path : glms_env_get_path_for(eval->env, path);
 
   if (!glms_file_exists(abspath)) {
-    GLMS_WARNING_RETURN((GLMSAST){.type = GLMS_AST_TYPE_UNDEFINED}, stderr,
-			"No such file `%s`.\n", path);
+    GLMS_ERROR_RETURN((GLMSAST){.type = GLMS_AST_TYPE_UNDEFINED}, stderr,
+		      "No such file `%s`.\n", path);
   }
 
   GLMSAST* old_result = hashy_map_get(&eval->visited_paths, abspath);
@@ -946,18 +1445,31 @@ GLMSAST glms_eval_import(GLMSEval *eval, GLMSAST ast, GLMSStack *stack) {
 		   .as.stackptr.ptr = old_result};
     }
   }
-  
 
-  if (strstr(abspath, ".so") != 0)
-    return glms_eval_import_extension(eval, ast, stack, abspath);
+  GLMSModule *module = glms_module_acquire(abspath, eval->env->config);
 
-  char *source = glms_get_file_contents(abspath);
-  GLMSEnv *import_env = NEW(GLMSEnv);
-  glms_env_init(import_env, source, abspath, eval->env->config);
-  glms_env_exec(import_env);
+  if (!module)
+    return (GLMSAST){.type = GLMS_AST_TYPE_UNDEFINED};
+
+  // the same module can be reached through different relative paths.
+  GLMSModuleInstance *instance =
+      (GLMSModuleInstance *)hashy_map_get(&eval->modules, module->path);
+
+  if (instance != 0) {
+    glms_module_release(module);
+  } else {
+    instance = glms_module_instantiate(module, eval->env->config);
+
+    if (!instance) {
+      glms_module_release(module);
+      return (GLMSAST){.type = GLMS_AST_TYPE_UNDEFINED};
+    }
+
+    hashy_map_set(&eval->modules, module->path, instance);
+  }
 
   GLMSAST *result_ast = glms_env_new_ast(eval->env, GLMS_AST_TYPE_STACK, false);
-  result_ast->as.stack.env = import_env;
+  result_ast->as.stack.env = &instance->env;
 
   hashy_map_set(&eval->visited_paths, abspath, result_ast);
 
@@ -979,8 +1491,8 @@ GLMSAST glms_eval_include(GLMSEval *eval, GLMSAST ast, GLMSStack *stack) {
       glms_file_exists(path) ? path : glms_env_get_path_for(eval->env, path);
 
   if (!glms_file_exists(abspath)) {
-    GLMS_WARNING_RETURN((GLMSAST){.type = GLMS_AST_TYPE_UNDEFINED}, stderr,
-			"No such file `%s`.\n", path);
+    GLMS_ERROR_RETURN((GLMSAST){.type = GLMS_AST_TYPE_UNDEFINED}, stderr,
+		      "No such file `%s`.\n", path);
   }
 
   char *source = glms_get_file_contents(abspath);
@@ -993,13 +1505,26 @@ GLMSAST glms_eval_include(GLMSEval *eval, GLMSAST ast, GLMSStack *stack) {
 		   .as.stackptr.ptr = result_ast};
 }
 
+// The parsed node is left alone, so it can be evaluated again (and by
+// other envs). The joined string is owned by a node of this env.
 GLMSAST glms_eval_string(GLMSEval *eval, GLMSAST ast, GLMSStack *stack) {
-  glms_eval_construct_string(eval, &ast, stack);
+  char *str = glms_eval_join_string(eval, &ast, stack);
+  if (str == 0) return ast;
+
+  GLMSAST *owner = glms_env_new_ast(eval->env, GLMS_AST_TYPE_STRING, true);
+  owner->as.string.heap = str;
+
+  ast.as.string.heap = str;
+  ast.children = 0;
+
   return ast;
 }
 
 
 GLMSAST glms_eval(GLMSEval *eval, GLMSAST ast, GLMSStack *stack) {
+  if (eval->continuation != 0)
+    glms_continuation_tick(eval->continuation);
+
   GLMSAST *t = glms_eval_get_type(eval, stack, &ast);
 
   if (t) {
@@ -1074,9 +1599,9 @@ bool glms_eval_expect(GLMSEval *eval, GLMSStack *stack, GLMSASTType *types,
     return true;
 
   if (args == 0 || (args->length != nr_types))
-    GLMS_WARNING_RETURN(false, stderr,
-			"Expected `%d` arguments but got `%ld`.\n", nr_types,
-			args ? args->length : 0);
+    GLMS_ERROR_RETURN(false, stderr,
+		      "Expected `%d` arguments but got `%ld`.\n", nr_types,
+		      args ? args->length : 0);
 
   for (int i = 0; i < nr_types; i++) {
     GLMSAST arg = args->items[i];
@@ -1085,7 +1610,7 @@ bool glms_eval_expect(GLMSEval *eval, GLMSStack *stack, GLMSASTType *types,
       arg = *ptr;
 
     if (arg.type != types[i]) {
-      GLMS_WARNING_RETURN(
+      GLMS_ERROR_RETURN(
 	  false, stderr, "Expected `%s` at arg `%d` but got `%s`.\n",
 	  GLMS_AST_TYPE_STR[types[i]], i, GLMS_AST_TYPE_STR[arg.type]);
     }
@@ -0,0 +1,4 @@
+#include <glms/macros.h>
+
+__thread long glms_warnings_raised = 0;
+__thread long glms_errors_raised = 0;
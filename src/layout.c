@@ -0,0 +1,81 @@
+#include <glms/env.h>
+#include <glms/layout.h>
+#include <glms/macros.h>
+#include <string.h>
+
+GLMSStructLayout* glms_struct_layout_new(GLMSStructField* fields,
+                                         int64_t fields_length) {
+  if (!fields || fields_length <= 0) return 0;
+
+  GLMSStructLayout* layout = NEW(GLMSStructLayout);
+  if (!layout) GLMS_WARNING_RETURN(0, stderr, "Could not allocate layout.\n");
+
+  layout->fields =
+      (GLMSStructField*)calloc(fields_length, sizeof(GLMSStructField));
+  layout->fields_length = fields_length;
+  layout->shape = glms_shape_root();
+
+  for (int64_t i = 0; i < fields_length; i++) {
+    layout->fields[i] = fields[i];
+    layout->fields[i].name = strdup(fields[i].name);
+    layout->shape = glms_shape_add(layout->shape, fields[i].name);
+  }
+
+  return layout;
+}
+
+void glms_struct_layout_free(GLMSStructLayout* layout) {
+  if (!layout) return;
+
+  if (layout->fields != 0) {
+    for (int64_t i = 0; i < layout->fields_length; i++) {
+      free((char*)layout->fields[i].name);
+    }
+    free(layout->fields);
+    layout->fields = 0;
+  }
+
+  glms_shape_free(layout->shape);
+  free(layout);
+}
+
+int64_t glms_struct_layout_lookup(GLMSStructLayout* layout, GLMSAST* site,
+                                  const char* key) {
+  if (!layout) return -1;
+
+  if (site != 0 && site->cached_shape == layout->shape)
+    return site->cached_slot;
+
+  int64_t slot = glms_shape_lookup(layout->shape, key);
+
+  if (slot < 0 || site == 0 || layout->shape->dictionary) return slot;
+
+  // like glms_eval_access_cached, sites of a frozen env may be read by
+  // several threads at once and keep what they cached before.
+  if (site->env_ref != 0 && site->env_ref->frozen) return slot;
+
+  site->cached_shape = layout->shape;
+  site->cached_slot = slot;
+
+  return slot;
+}
+
+int glms_struct_layout_read(GLMSStructLayout* layout, int64_t slot, void* ptr,
+                            GLMSAST* out) {
+  if (!layout || !ptr || !out) return 0;
+  if (slot < 0 || slot >= layout->fields_length) return 0;
+
+  GLMSStructField field = layout->fields[slot];
+
+  return glms_ast_read_memory(field.type, (char*)ptr + field.offset, out);
+}
+
+int glms_struct_layout_write(GLMSStructLayout* layout, int64_t slot, void* ptr,
+                             GLMSAST value) {
+  if (!layout || !ptr) return 0;
+  if (slot < 0 || slot >= layout->fields_length) return 0;
+
+  GLMSStructField field = layout->fields[slot];
+
+  return glms_ast_write_memory(field.type, (char*)ptr + field.offset, value);
+}
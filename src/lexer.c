@@ -185,6 +185,7 @@ static void glms_lexer_parse_special_id(GLMSLexer* lexer, GLMSToken* out) {
 }
 
 static int glms_lexer_parse_id(GLMSLexer* lexer, GLMSToken* out) {
+  out->value.frozen = false;
   out->value.length = 0;
   out->value.ptr = &lexer->source[lexer->i];
 
@@ -196,11 +197,13 @@ static int glms_lexer_parse_id(GLMSLexer* lexer, GLMSToken* out) {
   out->type = GLMS_TOKEN_TYPE_ID;
 
   glms_lexer_parse_special_id(lexer, out);
+  glms_string_view_freeze(&out->value);
 
   return 1;
 }
 
 static int glms_lexer_parse_string(GLMSLexer* lexer, GLMSToken* out) {
+  out->value.frozen = false;
   out->value.length = 0;
   glms_lexer_advance(lexer);
   out->value.ptr = &lexer->source[lexer->i];
@@ -218,11 +221,13 @@ static int glms_lexer_parse_string(GLMSLexer* lexer, GLMSToken* out) {
 
   glms_lexer_advance(lexer);
   out->type = GLMS_TOKEN_TYPE_STRING;
+  glms_string_view_freeze(&out->value);
 
   return 1;
 }
 
 static int glms_lexer_parse_template_string(GLMSLexer* lexer, GLMSToken* out) {
+  out->value.frozen = false;
   out->value.length = 0;
   glms_lexer_advance(lexer);
   out->value.ptr = &lexer->source[lexer->i];
@@ -240,11 +245,13 @@ static int glms_lexer_parse_template_string(GLMSLexer* lexer, GLMSToken* out) {
 
   glms_lexer_advance(lexer);
   out->type = GLMS_TOKEN_TYPE_TEMPLATE_STRING;
+  glms_string_view_freeze(&out->value);
 
   return 1;
 }
 
 static int glms_lexer_parse_number(GLMSLexer* lexer, GLMSToken* out) {
+  out->value.frozen = false;
   out->value.length = 0;
   out->value.ptr = &lexer->source[lexer->i];
 
@@ -267,6 +274,8 @@ static int glms_lexer_parse_number(GLMSLexer* lexer, GLMSToken* out) {
     out->type = GLMS_TOKEN_TYPE_FLOAT;
   }
 
+  glms_string_view_freeze(&out->value);
+
   return 1;
 }
 
@@ -282,6 +291,7 @@ int glms_lexer_next(GLMSLexer* lexer, GLMSToken* out) {
   out->c = 0;
   out->value.ptr = 0;
   out->value.length = 0;
+  out->value.frozen = false;
   out->type = GLMS_TOKEN_TYPE_EOF;
 
   while (GLMS_LEXER_HAS_COMMENT || GLMS_LEXER_HAS_BLOCK_COMMENT || GLMS_LEXER_HAS_WHITESPACE) {
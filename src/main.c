@@ -5,6 +5,7 @@
 #include <hashy/hashy.h>
 #include <stdio.h>
 #include <string.h>
+#include <time.h>
 #include <glms/string_builder.h>
 
 #include "glms/emit/emit.h"
@@ -92,6 +93,46 @@ static int glms_interactive(GLMSConfig cfg) {
   return 0;
 }
 
+static int64_t glms_now_usec() {
+  struct timespec ts = {0};
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+// glms_e --batch list.txt [--jobs N]
+static int glms_batch(CLIArgs* cli, GLMSConfig cfg) {
+  const char* list_path = cli_args_get_string(cli, "--batch");
+  const char* jobs_str = cli_args_get_string(cli, "--jobs");
+  int64_t jobs = jobs_str ? atoll(jobs_str) : 0;
+
+  char** paths = 0;
+  int64_t length = 0;
+  if (!glms_batch_read_list(list_path, &paths, &length)) return 1;
+
+  GLMSBatchResult* results = (GLMSBatchResult*)calloc(MAX(length, 1), sizeof(GLMSBatchResult));
+
+  int64_t start = glms_now_usec();
+  int64_t failed = glms_batch_run((const char**)paths, length, jobs, cfg, results);
+  int64_t wall = glms_now_usec() - start;
+
+  int64_t total = 0;
+
+  for (int64_t i = 0; i < length; i++) {
+    printf("%10.2f ms  %s  %s\n", results[i].usec / 1000.0, results[i].ok ? "ok  " : "FAIL", paths[i]);
+    total += results[i].usec;
+  }
+
+  printf("%ld scripts, %ld failed, %.2f ms wall, %.2f ms in scripts, %ld jobs\n",
+         length, failed, wall / 1000.0, total / 1000.0,
+         MIN(glms_parallel_get_threads(jobs), MAX(length, 1)));
+
+  glms_module_registry_clear();
+  glms_batch_free_list(paths, length);
+  free(results);
+
+  return failed > 0;
+}
+
 int main(int argc, char* argv[]) {
   GLMSConfig cfg = {0};
   if (argc < 2) return glms_interactive(cfg);
@@ -109,6 +150,10 @@ int main(int argc, char* argv[]) {
   } else if (cli_args_has(&cli, "--version")) {
     printf("GLMS Version %s\n", GLMS_VERSION_STRING);
     return 0;
+  } else if (cli_args_get_string(&cli, "--batch") != 0) {
+    int status = glms_batch(&cli, cfg);
+    cli_args_destroy(&cli);
+    return status;
   }
 
   char* source = glms_get_file_contents(argv[1]);
@@ -126,6 +171,7 @@ int main(int argc, char* argv[]) {
   glms_env_init(&env, source, argv[1], cfg);
   glms_env_exec(&env);
   glms_env_clear(&env);
+  glms_module_registry_clear();
 
   free(source);
   source = 0;
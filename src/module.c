@@ -0,0 +1,554 @@
+#include <dlfcn.h>
+#include <glms/io.h>
+#include <glms/macros.h>
+#include <glms/module.h>
+#include <glms/parallel.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "hashy/hashy.h"
+
+static HashyMap glms_module_registry = {0};
+
+// parsed by glms_module_prefetch but not yet executed.
+static HashyMap glms_module_prefetched = {0};
+
+// envs on different threads may import the same files. Only held while
+// the maps are used, modules load without it, see glms_module_acquire.
+static pthread_mutex_t glms_module_registry_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void glms_module_registry_lock_acquire() {
+  pthread_mutex_lock(&glms_module_registry_lock);
+}
+
+static bool glms_module_get_mtime(const char* path, struct timespec* out) {
+  struct stat st = {0};
+  if (stat(path, &st) != 0) return false;
+  *out = st.st_mtim;
+  return true;
+}
+
+static bool glms_module_is_current(GLMSModule* module,
+                                   struct timespec mtime) {
+  return module->mtime.tv_sec == mtime.tv_sec &&
+         module->mtime.tv_nsec == mtime.tv_nsec;
+}
+
+static void glms_module_free(GLMSModule* module) {
+  if (!module) return;
+
+  // the env can hold function pointers into the extension,
+  // so it has to go before the handle is closed.
+  if (module->env != 0) {
+    if (module->env->initialized) glms_env_clear(module->env);
+    free(module->env);
+    module->env = 0;
+  }
+
+  if (module->handle != 0) {
+    dlclose(module->handle);
+    module->handle = 0;
+  }
+
+  if (module->source != 0) {
+    free(module->source);
+    module->source = 0;
+  }
+
+  if (module->path != 0) {
+    free(module->path);
+    module->path = 0;
+  }
+
+  pthread_cond_destroy(&module->loaded);
+  free(module);
+}
+
+static int glms_module_load_extension(GLMSModule* module, GLMSConfig cfg) {
+  module->handle = dlopen(module->path, RTLD_LAZY);
+
+  if (!module->handle)
+    GLMS_ERROR_RETURN(0, stderr, "%s\n", dlerror());
+
+  dlerror();
+
+  GLMSExtensionEntryFunc func = 0;
+  *(void**)(&func) = dlsym(module->handle, "glms_extension_entry");
+
+  const char* error = dlerror();
+  if (error != 0 || !func)
+    GLMS_ERROR_RETURN(0, stderr, "Could not load `%s`: %s\n", module->path,
+                      error ? error : "no entry");
+
+  glms_env_init(module->env, 0, module->path, cfg);
+  func(module->env);
+
+  return 1;
+}
+
+static int glms_module_read_script(GLMSModule* module, GLMSConfig cfg) {
+  module->source = glms_get_file_contents(module->path);
+
+  if (!module->source)
+    GLMS_ERROR_RETURN(0, stderr, "Could not read `%s`.\n", module->path);
+
+  glms_env_init(module->env, module->source, module->path, cfg);
+
+  return 1;
+}
+
+// the script is only parsed here, importers execute it themselves.
+static int glms_module_load_script(GLMSModule* module, GLMSConfig cfg) {
+  // prefetched modules are already read and parsed.
+  if (!module->env->initialized && !glms_module_read_script(module, cfg))
+    return 0;
+
+  GLMSEnv* env = module->env;
+
+  if (env->root == 0) {
+    env->use_arena = false;
+    env->root = glms_parser_parse(&env->parser);
+
+    // the registry is not locked while a module loads,
+    // so its own imports can be read ahead as well.
+    glms_module_prefetch(env, env->root, cfg.import_threads);
+  }
+
+  return env->root != 0;
+}
+
+// a prefetched module was parsed with the prefetching env's config.
+static bool glms_module_can_use_prefetched(GLMSModule* module,
+                                           struct timespec mtime,
+                                           GLMSConfig cfg) {
+  GLMSConfig* parsed = &module->env->config;
+
+  return glms_module_is_current(module, mtime) && cfg.memo_ast == 0 &&
+         parsed->use_heap_strings == cfg.use_heap_strings &&
+         parsed->emit.mode == cfg.emit.mode;
+}
+
+static GLMSModule* glms_module_new(const char* path, struct timespec mtime) {
+  GLMSModule* module = NEW(GLMSModule);
+  if (!module) GLMS_WARNING_RETURN(0, stderr, "Could not allocate module.\n");
+
+  module->path = strdup(path);
+  module->mtime = mtime;
+  module->env = NEW(GLMSEnv);
+  pthread_cond_init(&module->loaded, 0);
+
+  return module;
+}
+
+// Returns the module registered for `path`, or a new one for the caller
+// to load (`load` is then set), which other importers wait for.
+static GLMSModule* glms_module_acquire_locked(const char* path,
+                                              struct timespec mtime,
+                                              GLMSConfig cfg, bool* load) {
+  if (!glms_module_registry.initialized) {
+    hashy_map_init(&glms_module_registry,
+                   (HashyConfig){.capacity = GLMS_MODULE_REGISTRY_CAPACITY});
+  }
+
+  GLMSModule* module = (GLMSModule*)hashy_map_get(&glms_module_registry, path);
+
+  // waiters hold a reference, so a load failing on the other thread
+  // can not free the module under them.
+  while (module != 0 && module->loading) {
+    module->refs++;
+    pthread_cond_wait(&module->loaded, &glms_module_registry_lock);
+    module->refs--;
+
+    GLMSModule* current =
+        (GLMSModule*)hashy_map_get(&glms_module_registry, path);
+    if (current != module && module->refs <= 0 && module->stale)
+      glms_module_free(module);
+
+    module = current;
+  }
+
+  if (module != 0) {
+    if (glms_module_is_current(module, mtime)) {
+      module->refs++;
+      return module;
+    }
+
+    // the file changed, envs still using the old module keep it
+    // alive until they release it.
+    hashy_map_unset(&glms_module_registry, path);
+    module->stale = true;
+    if (module->refs <= 0) glms_module_free(module);
+  }
+
+  module = (GLMSModule*)hashy_map_get(&glms_module_prefetched, path);
+
+  if (module != 0) {
+    hashy_map_unset(&glms_module_prefetched, path);
+
+    if (!glms_module_can_use_prefetched(module, mtime, cfg)) {
+      glms_module_free(module);
+      module = 0;
+    }
+  }
+
+  if (module == 0) module = glms_module_new(path, mtime);
+  if (!module) return 0;
+
+  module->loading = true;
+  module->refs = 1;
+  hashy_map_set(&glms_module_registry, module->path, module);
+  *load = true;
+
+  return module;
+}
+
+// modules load without the registry lock, so an import never waits for
+// anything but the module it imports (and the modules that one imports).
+GLMSModule* glms_module_acquire(const char* path, GLMSConfig cfg) {
+  if (!path) return 0;
+
+  char canonical[PATH_MAX];
+  if (!realpath(path, canonical))
+    GLMS_ERROR_RETURN(0, stderr, "No such file `%s`.\n", path);
+
+  struct timespec mtime = {0};
+  if (!glms_module_get_mtime(canonical, &mtime))
+    GLMS_WARNING_RETURN(0, stderr, "Could not stat `%s`.\n", canonical);
+
+  bool load = false;
+
+  glms_module_registry_lock_acquire();
+  GLMSModule* module = glms_module_acquire_locked(canonical, mtime, cfg, &load);
+  pthread_mutex_unlock(&glms_module_registry_lock);
+
+  if (!module || !load) return module;
+
+  // modules outlive the env that first imported them,
+  // so they only share an allocator supplied through the config.
+  int ok = strstr(canonical, ".so") != 0
+               ? glms_module_load_extension(module, cfg)
+               : glms_module_load_script(module, cfg);
+
+  // importers on other threads only read the module from here on.
+  if (ok) glms_env_freeze(module->env);
+
+  glms_module_registry_lock_acquire();
+
+  module->loading = false;
+  pthread_cond_broadcast(&module->loaded);
+
+  if (!ok) {
+    if (hashy_map_get(&glms_module_registry, module->path) == module)
+      hashy_map_unset(&glms_module_registry, module->path);
+
+    module->stale = true;
+    module->refs--;
+    if (module->refs <= 0) glms_module_free(module);
+    module = 0;
+  }
+
+  pthread_mutex_unlock(&glms_module_registry_lock);
+
+  return module;
+}
+
+void glms_module_release(GLMSModule* module) {
+  if (!module) return;
+
+  glms_module_registry_lock_acquire();
+
+  module->refs--;
+
+  if (module->refs <= 0 && module->stale) glms_module_free(module);
+
+  pthread_mutex_unlock(&glms_module_registry_lock);
+}
+
+GLMSModuleInstance* glms_module_instantiate(GLMSModule* module,
+                                            GLMSConfig cfg) {
+  if (!module || !module->env) return 0;
+
+  GLMSModuleInstance* instance = NEW(GLMSModuleInstance);
+  if (!instance)
+    GLMS_WARNING_RETURN(0, stderr, "Could not allocate module instance.\n");
+
+  GLMSEnv* env = &instance->env;
+  instance->module = module;
+
+  env->parent = module->env;
+  env->has_builtins = true;
+  env->imported = true;
+  glms_env_init(env, module->source, module->path, cfg);
+
+  if (module->env->root != 0) glms_env_exec_root(env, module->env->root);
+
+  return instance;
+}
+
+void glms_module_instance_free(GLMSModuleInstance* instance) {
+  if (!instance) return;
+
+  // the instance may hold pointers into the module, like an extension's
+  // functions, so it goes first.
+  if (instance->env.initialized) glms_env_clear(&instance->env);
+  glms_module_release(instance->module);
+
+  free(instance);
+}
+
+static void glms_module_prefetched_clear_locked() {
+  if (!glms_module_prefetched.initialized) return;
+
+  HashyIterator it = {0};
+
+  while (hashy_map_iterate(&glms_module_prefetched, &it)) {
+    if (!it.bucket->is_set) continue;
+    if (!it.bucket->value) continue;
+
+    glms_module_free((GLMSModule*)it.bucket->value);
+  }
+
+  hashy_map_clear(&glms_module_prefetched);
+}
+
+static int glms_module_registry_clear_locked() {
+  glms_module_prefetched_clear_locked();
+
+  if (!glms_module_registry.initialized) return 0;
+
+  HashyIterator it = {0};
+
+  while (hashy_map_iterate(&glms_module_registry, &it)) {
+    if (!it.bucket->is_set) continue;
+    if (!it.bucket->value) continue;
+
+    GLMSModule* module = (GLMSModule*)it.bucket->value;
+    module->stale = true;
+
+    if (module->refs <= 0) glms_module_free(module);
+  }
+
+  hashy_map_clear(&glms_module_registry);
+
+  return 1;
+}
+
+int glms_module_registry_clear() {
+  glms_module_registry_lock_acquire();
+  int ok = glms_module_registry_clear_locked();
+  pthread_mutex_unlock(&glms_module_registry_lock);
+
+  return ok;
+}
+
+// The import graph, discovered while it is being parsed. Every path
+// is only queued once, workers take the next one in line.
+typedef struct {
+  pthread_mutex_t lock;
+  pthread_cond_t changed;
+  GLMSConfig cfg;
+  HashyMap seen;
+  char** paths;
+  int64_t length;
+  int64_t next;
+  int64_t busy;
+  int64_t parsed;
+} GLMSModulePrefetch;
+
+static void glms_module_prefetch_add(GLMSModulePrefetch* prefetch,
+                                     const char* path) {
+  char canonical[PATH_MAX];
+  if (!realpath(path, canonical)) return;
+
+  // extensions are cheap to load, and are left to glms_module_acquire.
+  if (strstr(canonical, ".so") != 0) return;
+
+  pthread_mutex_lock(&prefetch->lock);
+
+  if (!hashy_map_get(&prefetch->seen, canonical)) {
+    hashy_map_set(&prefetch->seen, canonical, prefetch);
+
+    prefetch->paths = (char**)realloc(
+        prefetch->paths, (prefetch->length + 1) * sizeof(char*));
+    prefetch->paths[prefetch->length++] = strdup(canonical);
+
+    pthread_cond_signal(&prefetch->changed);
+  }
+
+  pthread_mutex_unlock(&prefetch->lock);
+}
+
+// imports are resolved the same way as in glms_eval_import.
+static void glms_module_prefetch_scan(GLMSModulePrefetch* prefetch,
+                                      GLMSEnv* env, GLMSAST* ast) {
+  if (!ast) return;
+
+  switch (ast->type) {
+    case GLMS_AST_TYPE_IMPORT: {
+      const char* path = glms_string_view_get_value(&ast->as.import.value);
+      if (!path) return;
+
+      glms_module_prefetch_add(prefetch, glms_file_exists(path)
+                                             ? path
+                                             : glms_env_get_path_for(env, path));
+      return;
+    }; break;
+    case GLMS_AST_TYPE_FUNC: {
+      glms_module_prefetch_scan(prefetch, env, ast->as.func.body);
+    }; break;
+    case GLMS_AST_TYPE_FOR: {
+      glms_module_prefetch_scan(prefetch, env, ast->as.forloop.body);
+    }; break;
+    case GLMS_AST_TYPE_BLOCK: {
+      glms_module_prefetch_scan(prefetch, env, ast->as.block.body);
+      glms_module_prefetch_scan(prefetch, env, ast->as.block.next);
+    }; break;
+    default: {
+    }; break;
+  }
+
+  if (ast->children == 0) return;
+
+  for (int64_t i = 0; i < ast->children->length; i++) {
+    glms_module_prefetch_scan(prefetch, env, ast->children->items[i]);
+  }
+}
+
+static bool glms_module_is_loaded(const char* path, struct timespec mtime) {
+  glms_module_registry_lock_acquire();
+
+  GLMSModule* module =
+      (GLMSModule*)hashy_map_get(&glms_module_registry, path);
+  if (!module)
+    module = (GLMSModule*)hashy_map_get(&glms_module_prefetched, path);
+
+  bool loaded = module != 0 && glms_module_is_current(module, mtime);
+
+  pthread_mutex_unlock(&glms_module_registry_lock);
+
+  return loaded;
+}
+
+static void glms_module_prefetch_parse(GLMSModulePrefetch* prefetch,
+                                       const char* path) {
+  struct timespec mtime = {0};
+  if (!glms_module_get_mtime(path, &mtime)) return;
+  if (glms_module_is_loaded(path, mtime)) return;
+
+  GLMSModule* module = glms_module_new(path, mtime);
+  if (!module) return;
+
+  module->prefetched = true;
+
+  if (!glms_module_read_script(module, prefetch->cfg)) {
+    glms_module_free(module);
+    return;
+  }
+
+  GLMSEnv* env = module->env;
+  env->use_arena = false;
+  env->root = glms_parser_parse(&env->parser);
+
+  // scanned before anyone else can execute the module.
+  glms_module_prefetch_scan(prefetch, env, env->root);
+
+  glms_module_registry_lock_acquire();
+
+  if (!glms_module_prefetched.initialized) {
+    hashy_map_init(&glms_module_prefetched,
+                   (HashyConfig){.capacity = GLMS_MODULE_REGISTRY_CAPACITY});
+  }
+
+  if (hashy_map_get(&glms_module_prefetched, module->path) != 0) {
+    glms_module_free(module);
+    module = 0;
+  } else {
+    hashy_map_set(&glms_module_prefetched, module->path, module);
+  }
+
+  pthread_mutex_unlock(&glms_module_registry_lock);
+
+  if (module != 0) __atomic_add_fetch(&prefetch->parsed, 1, __ATOMIC_RELAXED);
+}
+
+static void* glms_module_prefetch_worker(void* ptr) {
+  GLMSModulePrefetch* prefetch = (GLMSModulePrefetch*)ptr;
+
+  pthread_mutex_lock(&prefetch->lock);
+
+  while (true) {
+    // an empty queue is only final once nobody can add to it.
+    while (prefetch->next >= prefetch->length && prefetch->busy > 0) {
+      pthread_cond_wait(&prefetch->changed, &prefetch->lock);
+    }
+
+    if (prefetch->next >= prefetch->length) break;
+
+    const char* path = prefetch->paths[prefetch->next++];
+    prefetch->busy++;
+
+    pthread_mutex_unlock(&prefetch->lock);
+    glms_module_prefetch_parse(prefetch, path);
+    pthread_mutex_lock(&prefetch->lock);
+
+    prefetch->busy--;
+    pthread_cond_broadcast(&prefetch->changed);
+  }
+
+  pthread_cond_broadcast(&prefetch->changed);
+  pthread_mutex_unlock(&prefetch->lock);
+
+  return 0;
+}
+
+int64_t glms_module_prefetch(GLMSEnv* env, GLMSAST* root, int64_t threads) {
+  if (!env || !root) return 0;
+
+  // a shared allocator is not safe to use from several threads.
+  if (env->config.memo_ast != 0) return 0;
+
+  // only when asked for, every exec would start its own threads otherwise.
+  if (threads == 0) return 0;
+
+  threads = glms_parallel_get_threads(threads);
+  if (threads <= 1) return 0;
+
+  GLMSModulePrefetch prefetch = {.cfg = env->config};
+  pthread_mutex_init(&prefetch.lock, 0);
+  pthread_cond_init(&prefetch.changed, 0);
+  hashy_map_init(&prefetch.seen,
+                 (HashyConfig){.capacity = GLMS_MODULE_REGISTRY_CAPACITY});
+
+  glms_module_prefetch_scan(&prefetch, env, root);
+
+  if (prefetch.length > 0) {
+    threads = MIN(threads, prefetch.length);
+    pthread_t* workers = (pthread_t*)calloc(threads, sizeof(pthread_t));
+
+    // the calling thread is the first worker.
+    for (int64_t i = 1; i < threads; i++) {
+      pthread_create(&workers[i], 0, glms_module_prefetch_worker, &prefetch);
+    }
+
+    glms_module_prefetch_worker(&prefetch);
+
+    for (int64_t i = 1; i < threads; i++) {
+      pthread_join(workers[i], 0);
+    }
+
+    free(workers);
+  }
+
+  for (int64_t i = 0; i < prefetch.length; i++) free(prefetch.paths[i]);
+  if (prefetch.paths) free(prefetch.paths);
+
+  hashy_map_clear(&prefetch.seen);
+  hashy_map_destroy(&prefetch.seen);
+  pthread_mutex_destroy(&prefetch.lock);
+  pthread_cond_destroy(&prefetch.changed);
+
+  return prefetch.parsed;
+}
@@ -3,7 +3,10 @@
 #include "glms/ast_type.h"
 #include "glms/env.h"
 #include "glms/eval.h"
+#include "glms/macros.h"
 #include <glms/modules/array.h>
+#include <glms/parallel.h>
+#include <string.h>
 
 // typedef char* (*GLMSASTToString)(struct GLMS_AST_STRUCT *ast, GLMSAllocator alloc);
 
@@ -128,6 +131,9 @@ int glms_array_fptr_sort(GLMSEval *eval, GLMSAST *ast, GLMSASTBuffer *args,
     return 1;
   }
 
+  // the copy shares its elements with `ast` until we start swapping.
+  glms_ast_make_unique(new_array, eval->env);
+
   GLMSAST func = args->items[0];
 
   int64_t n = ast->children->length; 
@@ -163,10 +169,11 @@ int glms_array_fptr_push(GLMSEval *eval, GLMSAST *ast, GLMSASTBuffer *args,
                          GLMSStack *stack, GLMSAST *out) {
 
   if (!args || args->length <= 0) return 0;
+  if (!glms_eval_can_write(eval, ast)) return 0;
 
   for (int64_t i = 0; i < args->length; i++) {
     GLMSAST arg = args->items[i];
-    GLMSAST* copy = glms_ast_copy(arg, eval->env);
+    GLMSAST* copy = glms_eval_copy_for(eval, ast, arg);
     glms_ast_push(ast, copy);
   }
 
@@ -208,6 +215,325 @@ int glms_array_fptr_includes(GLMSEval *eval, GLMSAST *ast, GLMSASTBuffer *args,
   return 1;
 }
 
+typedef struct {
+  GLMSAST *array;
+  GLMSAST func;
+  GLMSAST acc;
+  int64_t length;
+  int64_t chunk;
+  // the env each chunk was evaluated in.
+  GLMSEnv **envs;
+  GLMSAST *results;
+  bool *keep;
+  GLMSAST *out;
+  GLMSAST **items;
+  GLMSAST **tmp;
+  int64_t width;
+} GLMSArrayParallel;
+
+// parses the optional `chunk` and `threads` arguments following `first`.
+static int64_t glms_array_parallel_init(GLMSEval *eval, GLMSAST *ast,
+                                        GLMSASTBuffer *args, GLMSStack *stack,
+                                        int64_t first, GLMSArrayParallel *p) {
+  int64_t threads = 0;
+
+  *p = (GLMSArrayParallel){
+    .array = ast,
+    .func = args->items[0],
+    .length = ast->children ? ast->children->length : 0,
+    .chunk = GLMS_ARRAY_PARALLEL_CHUNK
+  };
+
+  if (args->length > first) {
+    GLMSAST chunk = glms_eval(eval, args->items[first], stack);
+    if (chunk.type == GLMS_AST_TYPE_NUMBER && glms_ast_number(chunk) >= 1)
+      p->chunk = (int64_t)glms_ast_number(chunk);
+  }
+
+  if (args->length > first + 1) {
+    GLMSAST arg = glms_eval(eval, args->items[first + 1], stack);
+    if (arg.type == GLMS_AST_TYPE_NUMBER) threads = (int64_t)glms_ast_number(arg);
+  }
+
+  return threads;
+}
+
+static int64_t glms_array_parallel_chunks(GLMSArrayParallel *p) {
+  return (p->length + p->chunk - 1) / p->chunk;
+}
+
+static GLMSAST glms_array_parallel_call(GLMSEval *eval, GLMSStack *stack,
+                                        GLMSAST *func, GLMSAST *items,
+                                        int64_t length) {
+  GLMSASTBuffer call_args = (GLMSASTBuffer){
+    .initialized = true,
+    .items = items,
+    .length = length
+  };
+
+  return glms_eval(eval, glms_eval_call_func(eval, stack, func, call_args), stack);
+}
+
+static bool glms_array_parallel_check(GLMSEval *eval, GLMSStack *stack,
+                                      GLMSASTBuffer *args, int64_t min) {
+  if (!args || args->length < min)
+    GLMS_ERROR_RETURN(false, stderr, "Expected at least `%ld` arguments.\n", min);
+
+  GLMSAST *ptr = glms_ast_get_ptr(args->items[0]);
+  GLMSAST func = ptr ? *ptr : args->items[0];
+
+  if (func.type != GLMS_AST_TYPE_FUNC)
+    GLMS_ERROR_RETURN(false, stderr, "Expected `%s` at arg `0` but got `%s`.\n",
+                      GLMS_AST_TYPE_STR[GLMS_AST_TYPE_FUNC], GLMS_AST_TYPE_STR[func.type]);
+
+  return true;
+}
+
+static int glms_array_map_chunk(GLMSEval *eval, GLMSStack *stack,
+                                int64_t task, void *user_ptr) {
+  GLMSArrayParallel *p = (GLMSArrayParallel *)user_ptr;
+  int64_t end = MIN((task + 1) * p->chunk, p->length);
+
+  p->envs[task] = eval->env;
+
+  for (int64_t i = task * p->chunk; i < end; i++) {
+    p->results[i] = glms_array_parallel_call(eval, stack, &p->func,
+                                             p->array->children->items[i], 1);
+  }
+
+  return 1;
+}
+
+static int glms_array_map_merge(GLMSEval *eval, GLMSStack *stack,
+                                int64_t task, void *user_ptr) {
+  GLMSArrayParallel *p = (GLMSArrayParallel *)user_ptr;
+  int64_t end = MIN((task + 1) * p->chunk, p->length);
+
+  for (int64_t i = task * p->chunk; i < end; i++) {
+    glms_ast_push(p->out, glms_parallel_adopt(eval->env, p->envs[task], p->results[i]));
+  }
+
+  return 1;
+}
+
+int glms_array_fptr_parallel_map(GLMSEval *eval, GLMSAST *ast, GLMSASTBuffer *args,
+                                 GLMSStack *stack, GLMSAST *out) {
+  if (!glms_array_parallel_check(eval, stack, args, 1)) return 0;
+
+  GLMSArrayParallel p = {0};
+  int64_t threads = glms_array_parallel_init(eval, ast, args, stack, 1, &p);
+  int64_t chunks = glms_array_parallel_chunks(&p);
+
+  p.out = glms_env_new_ast(eval->env, GLMS_AST_TYPE_ARRAY, true);
+  p.envs = (GLMSEnv **)calloc(chunks + 1, sizeof(GLMSEnv *));
+  p.results = (GLMSAST *)calloc(p.length + 1, sizeof(GLMSAST));
+
+  glms_parallel_run(eval, stack, threads, chunks, glms_array_map_chunk,
+                    glms_array_map_merge, &p);
+
+  free(p.envs);
+  free(p.results);
+
+  *out = (GLMSAST){ .type = GLMS_AST_TYPE_STACK_PTR, .as.stackptr.ptr = p.out };
+
+  return 1;
+}
+
+static int glms_array_filter_chunk(GLMSEval *eval, GLMSStack *stack,
+                                   int64_t task, void *user_ptr) {
+  GLMSArrayParallel *p = (GLMSArrayParallel *)user_ptr;
+  int64_t end = MIN((task + 1) * p->chunk, p->length);
+
+  for (int64_t i = task * p->chunk; i < end; i++) {
+    GLMSAST result = glms_array_parallel_call(eval, stack, &p->func,
+                                              p->array->children->items[i], 1);
+    p->keep[i] = glms_ast_is_truthy(result);
+  }
+
+  return 1;
+}
+
+int glms_array_fptr_parallel_filter(GLMSEval *eval, GLMSAST *ast, GLMSASTBuffer *args,
+                                    GLMSStack *stack, GLMSAST *out) {
+  if (!glms_array_parallel_check(eval, stack, args, 1)) return 0;
+
+  GLMSArrayParallel p = {0};
+  int64_t threads = glms_array_parallel_init(eval, ast, args, stack, 1, &p);
+
+  p.out = glms_env_new_ast(eval->env, GLMS_AST_TYPE_ARRAY, true);
+  p.keep = (bool *)calloc(p.length + 1, sizeof(bool));
+
+  glms_parallel_run(eval, stack, threads, glms_array_parallel_chunks(&p),
+                    glms_array_filter_chunk, 0, &p);
+
+  for (int64_t i = 0; i < p.length; i++) {
+    if (p.keep[i]) glms_ast_push(p.out, ast->children->items[i]);
+  }
+
+  free(p.keep);
+
+  *out = (GLMSAST){ .type = GLMS_AST_TYPE_STACK_PTR, .as.stackptr.ptr = p.out };
+
+  return 1;
+}
+
+static int glms_array_reduce_chunk(GLMSEval *eval, GLMSStack *stack,
+                                   int64_t task, void *user_ptr) {
+  GLMSArrayParallel *p = (GLMSArrayParallel *)user_ptr;
+  int64_t start = task * p->chunk;
+  int64_t end = MIN(start + p->chunk, p->length);
+
+  p->envs[task] = eval->env;
+
+  GLMSAST acc = *p->array->children->items[start];
+
+  for (int64_t i = start + 1; i < end; i++) {
+    acc = glms_array_parallel_call(
+        eval, stack, &p->func,
+        (GLMSAST[]){ acc, *p->array->children->items[i] }, 2);
+  }
+
+  p->results[task] = acc;
+
+  return 1;
+}
+
+static int glms_array_reduce_merge(GLMSEval *eval, GLMSStack *stack,
+                                   int64_t task, void *user_ptr) {
+  GLMSArrayParallel *p = (GLMSArrayParallel *)user_ptr;
+  GLMSAST *value = glms_parallel_adopt(eval->env, p->envs[task], p->results[task]);
+
+  if (!value) return 0;
+
+  p->acc = glms_array_parallel_call(eval, stack, &p->func,
+                                    (GLMSAST[]){ p->acc, *value }, 2);
+
+  return 1;
+}
+
+int glms_array_fptr_parallel_reduce(GLMSEval *eval, GLMSAST *ast, GLMSASTBuffer *args,
+                                    GLMSStack *stack, GLMSAST *out) {
+  if (!glms_array_parallel_check(eval, stack, args, 2)) return 0;
+
+  GLMSArrayParallel p = {0};
+  int64_t threads = glms_array_parallel_init(eval, ast, args, stack, 2, &p);
+  int64_t chunks = glms_array_parallel_chunks(&p);
+
+  p.acc = args->items[1];
+  p.envs = (GLMSEnv **)calloc(chunks + 1, sizeof(GLMSEnv *));
+  p.results = (GLMSAST *)calloc(chunks + 1, sizeof(GLMSAST));
+
+  glms_parallel_run(eval, stack, threads, chunks, glms_array_reduce_chunk,
+                    glms_array_reduce_merge, &p);
+
+  free(p.envs);
+  free(p.results);
+
+  *out = p.acc;
+
+  return 1;
+}
+
+// `func(a, b)` being truthy means `a` goes after `b`, like in sort.
+static void glms_array_merge_runs(GLMSEval *eval, GLMSStack *stack,
+                                  GLMSAST *func, GLMSAST **src, GLMSAST **dest,
+                                  int64_t lo, int64_t mid, int64_t hi) {
+  int64_t i = lo;
+  int64_t j = mid;
+  int64_t k = lo;
+
+  while (i < mid && j < hi) {
+    GLMSAST result = glms_array_parallel_call(
+        eval, stack, func, (GLMSAST[]){ *src[i], *src[j] }, 2);
+
+    dest[k++] = glms_ast_is_truthy(result) ? src[j++] : src[i++];
+  }
+
+  while (i < mid) dest[k++] = src[i++];
+  while (j < hi) dest[k++] = src[j++];
+}
+
+static int glms_array_sort_chunk(GLMSEval *eval, GLMSStack *stack,
+                                 int64_t task, void *user_ptr) {
+  GLMSArrayParallel *p = (GLMSArrayParallel *)user_ptr;
+  int64_t start = task * p->chunk;
+  int64_t end = MIN(start + p->chunk, p->length);
+
+  GLMSAST **src = p->items;
+  GLMSAST **dest = p->tmp;
+
+  for (int64_t width = 1; width < end - start; width *= 2) {
+    for (int64_t lo = start; lo < end; lo += width * 2) {
+      int64_t mid = MIN(lo + width, end);
+      int64_t hi = MIN(lo + width * 2, end);
+      glms_array_merge_runs(eval, stack, &p->func, src, dest, lo, mid, hi);
+    }
+
+    GLMSAST **swap = src;
+    src = dest;
+    dest = swap;
+  }
+
+  if (src != p->items) {
+    memcpy(&p->items[start], &src[start], (end - start) * sizeof(GLMSAST *));
+  }
+
+  return 1;
+}
+
+static int glms_array_sort_round(GLMSEval *eval, GLMSStack *stack,
+                                 int64_t task, void *user_ptr) {
+  GLMSArrayParallel *p = (GLMSArrayParallel *)user_ptr;
+  int64_t lo = task * p->width * 2;
+  int64_t mid = MIN(lo + p->width, p->length);
+  int64_t hi = MIN(lo + p->width * 2, p->length);
+
+  glms_array_merge_runs(eval, stack, &p->func, p->items, p->tmp, lo, mid, hi);
+
+  return 1;
+}
+
+// sorts chunks on their own, then merges pairs of runs until one is left.
+int glms_array_fptr_parallel_sort(GLMSEval *eval, GLMSAST *ast, GLMSASTBuffer *args,
+                                  GLMSStack *stack, GLMSAST *out) {
+  if (!glms_array_parallel_check(eval, stack, args, 1)) return 0;
+
+  GLMSArrayParallel p = {0};
+  int64_t threads = glms_array_parallel_init(eval, ast, args, stack, 1, &p);
+
+  GLMSAST *new_array = glms_env_new_ast(eval->env, GLMS_AST_TYPE_ARRAY, true);
+
+  if (p.length > 0) {
+    p.items = (GLMSAST **)calloc(p.length, sizeof(GLMSAST *));
+    p.tmp = (GLMSAST **)calloc(p.length, sizeof(GLMSAST *));
+    memcpy(p.items, ast->children->items, p.length * sizeof(GLMSAST *));
+
+    glms_parallel_run(eval, stack, threads, glms_array_parallel_chunks(&p),
+                      glms_array_sort_chunk, 0, &p);
+
+    for (p.width = p.chunk; p.width < p.length; p.width *= 2) {
+      int64_t runs = (p.length + p.width * 2 - 1) / (p.width * 2);
+
+      glms_parallel_run(eval, stack, threads, runs, glms_array_sort_round, 0, &p);
+
+      GLMSAST **swap = p.items;
+      p.items = p.tmp;
+      p.tmp = swap;
+    }
+
+    for (int64_t i = 0; i < p.length; i++) {
+      glms_ast_push(new_array, glms_ast_copy(*p.items[i], eval->env));
+    }
+
+    free(p.items);
+    free(p.tmp);
+  }
+
+  *out = (GLMSAST){ .type = GLMS_AST_TYPE_STACK_PTR, .as.stackptr.ptr = new_array };
+
+  return 1;
+}
+
 void glms_array_constructor(GLMSEval *eval, GLMSStack *stack,
                                   GLMSASTBuffer *args, GLMSAST *self) {
 
@@ -215,17 +541,52 @@ void glms_array_constructor(GLMSEval *eval, GLMSStack *stack,
   self->type = GLMS_AST_TYPE_ARRAY;
   self->constructor = glms_array_constructor;
   self->to_string = glms_array_to_string;
-  glms_ast_register_function(eval->env, self, "map", glms_array_fptr_map);
-  glms_ast_register_function(eval->env, self, "filter", glms_array_fptr_filter);
-  glms_ast_register_function(eval->env, self, "sort", glms_array_fptr_sort);
-  glms_ast_register_function(eval->env, self, "push", glms_array_fptr_push);
-  glms_ast_register_function(eval->env, self, "length", glms_array_fptr_length);
-  glms_ast_register_function(eval->env, self, "count", glms_array_fptr_length);
-  glms_ast_register_function(eval->env, self, "includes", glms_array_fptr_includes);
 }
 
 void glms_array_type(GLMSEnv *env) {
   GLMSAST* t = glms_env_new_ast(env, GLMS_AST_TYPE_ARRAY, false);
   glms_env_register_type(env, "array", t, glms_array_constructor, 0, glms_array_to_string, 0);
   glms_env_register_type(env, GLMS_AST_TYPE_STR[GLMS_AST_TYPE_ARRAY], t, glms_array_constructor, 0, glms_array_to_string, 0);
+
+  glms_ast_register_function(env, t, "map", glms_array_fptr_map);
+  glms_ast_register_function(env, t, "filter", glms_array_fptr_filter);
+  glms_ast_register_function(env, t, "sort", glms_array_fptr_sort);
+  glms_ast_register_function(env, t, "push", glms_array_fptr_push);
+  glms_ast_register_function(env, t, "length", glms_array_fptr_length);
+  glms_ast_register_function(env, t, "count", glms_array_fptr_length);
+  glms_ast_register_function(env, t, "includes", glms_array_fptr_includes);
+  glms_ast_register_function(env, t, "parallelMap", glms_array_fptr_parallel_map);
+  glms_ast_register_function(env, t, "parallelFilter", glms_array_fptr_parallel_filter);
+  glms_ast_register_function(env, t, "parallelReduce", glms_array_fptr_parallel_reduce);
+  glms_ast_register_function(env, t, "parallelSort", glms_array_fptr_parallel_sort);
+
+  GLMSType options[] = {
+    (GLMSType){ GLMS_AST_TYPE_NUMBER, .valuename = "chunk" },
+    (GLMSType){ GLMS_AST_TYPE_NUMBER, .valuename = "threads" }
+  };
+
+  const char *names[] = { "parallelMap", "parallelFilter", "parallelSort" };
+
+  for (int i = 0; i < 3; i++) {
+    glms_env_register_function_signature(
+      env,
+      t,
+      names[i],
+      (GLMSFunctionSignature){
+        .return_type = (GLMSType){ GLMS_AST_TYPE_ARRAY },
+        .args = (GLMSType[]){ (GLMSType){ GLMS_AST_TYPE_FUNC }, options[0], options[1] },
+        .args_length = 3
+      }
+    );
+  }
+
+  glms_env_register_function_signature(
+    env,
+    t,
+    "parallelReduce",
+    (GLMSFunctionSignature){
+      .args = (GLMSType[]){ (GLMSType){ GLMS_AST_TYPE_FUNC }, (GLMSType){ GLMS_AST_TYPE_UNDEFINED, .valuename = "initial" }, options[0], options[1] },
+      .args_length = 4
+    }
+  );
 }
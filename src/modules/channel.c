@@ -0,0 +1,174 @@
+#include "glms/ast.h"
+#include "glms/ast_type.h"
+#include "glms/env.h"
+#include "glms/eval.h"
+#include "glms/macros.h"
+#include <glms/modules/channel.h>
+
+// takes over a reference to `channel`.
+static void glms_channel_hold(GLMSEnv *env, GLMSChannel *channel) {
+  env->channels = (GLMSChannel **)realloc(
+      env->channels, (env->channels_length + 1) * sizeof(GLMSChannel *));
+  env->channels[env->channels_length++] = channel;
+}
+
+char *glms_channel_to_string(GLMSAST *ast, GLMSAllocator alloc, GLMSEnv *env) {
+  char tmp[64];
+  sprintf(tmp, "Channel<%ld>",
+          glms_channel_get_capacity((GLMSChannel *)ast->ptr));
+
+  return alloc.strdup(alloc.user_ptr, tmp);
+}
+
+GLMSChannel *glms_channel_from_ast(GLMSAST ast) {
+  GLMSAST *ptr = glms_ast_get_ptr(ast);
+  if (ptr) ast = *ptr;
+
+  if (ast.constructor != glms_channel_constructor) return 0;
+
+  return (GLMSChannel *)ast.ptr;
+}
+
+GLMSAST *glms_channel_new_ast(GLMSEnv *env, GLMSChannel *channel) {
+  if (!env || !channel) return 0;
+
+  glms_channel_hold(env, glms_channel_retain(channel));
+
+  // usually registered by the host, like other values it hands to scripts.
+  GLMSAST *ast = glms_env_new_ast(env, GLMS_AST_TYPE_STRUCT, false);
+  ast->ptr = channel;
+  glms_channel_constructor(&env->eval, &env->stack, 0, ast);
+
+  return ast;
+}
+
+// the elements of an array literal are not evaluated yet.
+static GLMSAST glms_channel_eval_value(GLMSEval *eval, GLMSStack *stack,
+                                       GLMSAST value) {
+  value = glms_eval(eval, value, stack);
+
+  GLMSAST *ptr = glms_ast_get_ptr(value);
+  GLMSAST *array = ptr ? ptr : &value;
+
+  if (array->type != GLMS_AST_TYPE_ARRAY || !array->children) return value;
+
+  GLMSAST *evaluated = glms_env_new_ast(eval->env, GLMS_AST_TYPE_ARRAY, true);
+
+  for (int64_t i = 0; i < array->children->length; i++) {
+    GLMSAST item = glms_channel_eval_value(eval, stack, *array->children->items[i]);
+    GLMSAST *item_ptr = glms_ast_get_ptr(item);
+    glms_ast_push(evaluated, item_ptr ? item_ptr : glms_ast_copy(item, eval->env));
+  }
+
+  return (GLMSAST){.type = GLMS_AST_TYPE_STACK_PTR, .as.stackptr.ptr = evaluated};
+}
+
+int glms_channel_fptr_send(GLMSEval *eval, GLMSAST *ast, GLMSASTBuffer *args,
+                           GLMSStack *stack, GLMSAST *out) {
+  if (!ast->ptr) GLMS_WARNING_RETURN(0, stderr, "ptr == null.\n");
+  if (!args || args->length <= 0)
+    GLMS_ERROR_RETURN(0, stderr, "Expected a value.\n");
+
+  int ok = glms_channel_send((GLMSChannel *)ast->ptr,
+                             glms_channel_eval_value(eval, stack, args->items[0]));
+
+  *out = (GLMSAST){.type = GLMS_AST_TYPE_BOOL, .as.boolean = ok != 0};
+
+  return 1;
+}
+
+int glms_channel_fptr_recv(GLMSEval *eval, GLMSAST *ast, GLMSASTBuffer *args,
+                           GLMSStack *stack, GLMSAST *out) {
+  if (!ast->ptr) GLMS_WARNING_RETURN(0, stderr, "ptr == null.\n");
+
+  GLMSAST *value = glms_channel_recv((GLMSChannel *)ast->ptr, eval->env);
+
+  // typed variables can not hold null, so scripts can pass what to
+  // return instead once the channel is done.
+  if (!value && args != 0 && args->length > 0) {
+    *out = glms_eval(eval, args->items[0], stack);
+    return 1;
+  }
+
+  if (!value) {
+    *out = (GLMSAST){.type = GLMS_AST_TYPE_NULL};
+    return 1;
+  }
+
+  *out = (GLMSAST){.type = GLMS_AST_TYPE_STACK_PTR, .as.stackptr.ptr = value};
+
+  return 1;
+}
+
+int glms_channel_fptr_close(GLMSEval *eval, GLMSAST *ast, GLMSASTBuffer *args,
+                            GLMSStack *stack, GLMSAST *out) {
+  if (!ast->ptr) GLMS_WARNING_RETURN(0, stderr, "ptr == null.\n");
+
+  glms_channel_close((GLMSChannel *)ast->ptr);
+
+  *out = (GLMSAST){.type = GLMS_AST_TYPE_STACK_PTR, .as.stackptr.ptr = ast};
+
+  return 1;
+}
+
+void glms_channel_constructor(GLMSEval *eval, GLMSStack *stack,
+                              GLMSASTBuffer *args, GLMSAST *self) {
+  self->type = GLMS_AST_TYPE_STRUCT;
+  self->constructor = glms_channel_constructor;
+
+  // methods live on the registered "channel" type.
+  if (!self->value_type) {
+    GLMSAST *t = glms_env_lookup_type(eval->env, "channel");
+    self->value_type = t != self ? t : 0;
+  }
+
+  if (!args || args->length <= 0) return;
+
+  GLMSAST capacity = glms_eval(eval, args->items[0], stack);
+  if (capacity.type != GLMS_AST_TYPE_NUMBER)
+    GLMS_ERROR_RETURN(, stderr, "Expected a capacity.\n");
+
+  GLMSChannel *channel = glms_channel_new((int64_t)capacity.as.number.value);
+  if (!channel) return;
+
+  glms_channel_hold(eval->env, channel);
+  self->ptr = channel;
+}
+
+void glms_channel_type(GLMSEnv *env) {
+  GLMSAST *t = glms_env_new_ast(env, GLMS_AST_TYPE_STRUCT, false);
+  t->constructor = glms_channel_constructor;
+  glms_env_register_type(env, "channel", t, glms_channel_constructor, 0,
+                         glms_channel_to_string, 0);
+
+  glms_ast_register_function(env, t, "send", glms_channel_fptr_send);
+  glms_env_register_function_signature(
+      env, t, "send",
+      (GLMSFunctionSignature){
+          .return_type = (GLMSType){GLMS_AST_TYPE_BOOL},
+          .args = (GLMSType[]){(GLMSType){GLMS_AST_TYPE_UNDEFINED,
+                                          .valuename = "value"}},
+          .args_length = 1,
+          .description = "Waits while the channel is full, false once it "
+                         "is closed."});
+
+  glms_ast_register_function(env, t, "recv", glms_channel_fptr_recv);
+  glms_env_register_function_signature(
+      env, t, "recv",
+      (GLMSFunctionSignature){
+          .return_type = (GLMSType){GLMS_AST_TYPE_UNDEFINED},
+          .args = (GLMSType[]){(GLMSType){GLMS_AST_TYPE_UNDEFINED,
+                                          .valuename = "otherwise"}},
+          .args_length = 1,
+          .description = "Waits for a value. Once the channel is closed and "
+                         "empty, returns `otherwise` (or null)."});
+
+  glms_ast_register_function(env, t, "close", glms_channel_fptr_close);
+  glms_env_register_function_signature(
+      env, t, "close",
+      (GLMSFunctionSignature){
+          .return_type = (GLMSType){.typename = "channel"},
+          .args_length = 0,
+          .description = "Values can no longer be sent, the ones already "
+                         "sent can still be received."});
+}
@@ -5,9 +5,12 @@
 #include "glms/env.h"
 #include "glms/eval.h"
 #include "glms/type.h"
+#include <glms/async.h>
 #include <glms/modules/fetch.h>
+#include <glms/modules/future.h>
 #include <curl/curl.h>
 #include <glms/macros.h>
+#include <pthread.h>
 
 typedef struct {
   char* data;
@@ -48,60 +51,263 @@ void glms_response_destructor(GLMSAST *ast) {
   ast->ptr = 0;
 }
 
-static size_t writefunc(void *ptr, size_t size, size_t nmemb, GLMSFetchResponse *response)
+static size_t writefunc(void *ptr, size_t size, size_t nmemb, GLMSFuture *future)
 {
-    size_t new_len = response->len + size*nmemb;
-    response->data = realloc(response->data, new_len+1);
+    size_t new_len = future->length + size*nmemb;
+    future->data = realloc(future->data, new_len+1);
 
-    if (response->data == NULL)
+    if (future->data == NULL)
     {
       GLMS_WARNING_RETURN(0, stderr, "failed to realloc response response.\n");
     }
 
-    memcpy(response->data+response->len, ptr, size*nmemb);
-    response->data[new_len] = '\0';
-    response->len = new_len;
+    memcpy(future->data+future->length, ptr, size*nmemb);
+    future->data[new_len] = '\0';
+    future->length = new_len;
 
     return size*nmemb;
 }
 
-int glms_fptr_fetch(GLMSEval *eval, GLMSAST *ast, GLMSASTBuffer *args,
-                    GLMSStack *stack, GLMSAST *out) {
+// A transfer, owned by the fetch loop until it is done.
+typedef struct GLMS_FETCH_REQUEST_STRUCT {
+  GLMSFuture* future;
+  CURL* curl;
+  struct GLMS_FETCH_REQUEST_STRUCT* next;
+} GLMSFetchRequest;
 
+// Every request goes through one curl multi handle on its own thread,
+// so transfers overlap and share connections and DNS lookups.
+typedef struct {
+  pthread_mutex_t lock;
+  CURLM* multi;
+  CURLSH* share;
+  GLMSFetchRequest* head;
+  GLMSFetchRequest* tail;
+  int64_t active;
+  int64_t max_active;
+} GLMSFetchLoop;
+
+static GLMSFetchLoop glms_fetch_loop = {
+  .lock = PTHREAD_MUTEX_INITIALIZER,
+  .max_active = GLMS_FETCH_MAX_CONCURRENT
+};
+
+static pthread_once_t glms_fetch_loop_once = PTHREAD_ONCE_INIT;
+
+// the multi handle, and the share, are only used on the loop's thread.
+static void glms_fetch_loop_add(GLMSFetchLoop* loop) {
+  pthread_mutex_lock(&loop->lock);
+
+  while (loop->head != 0 && loop->active < loop->max_active) {
+    GLMSFetchRequest* request = loop->head;
+    loop->head = request->next;
+    if (!loop->head) loop->tail = 0;
+    request->next = 0;
+
+    curl_easy_setopt(request->curl, CURLOPT_SHARE, loop->share);
+    curl_multi_add_handle(loop->multi, request->curl);
+    loop->active++;
+  }
 
-  if (!glms_eval_expect(eval, stack, (GLMSASTType[]){ GLMS_AST_TYPE_STRING }, 1, args)) return 0;
-  CURL *curl;
-  CURLcode res;
+  pthread_mutex_unlock(&loop->lock);
+}
 
-  curl = curl_easy_init();
+static void glms_fetch_loop_finish(GLMSFetchLoop* loop, CURLMsg* msg) {
+  GLMSFetchRequest* request = 0;
+  curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char**)&request);
+  if (!request) return;
 
-  if (!curl) GLMS_WARNING_RETURN(0, stderr, "Failed to initialize curl.\n");
+  bool ok = msg->data.result == CURLE_OK;
+
+  long http_code = 0;
+  curl_easy_getinfo(request->curl, CURLINFO_RESPONSE_CODE, &http_code);
+  request->future->status = http_code;
+
+  curl_multi_remove_handle(loop->multi, request->curl);
+  curl_easy_cleanup(request->curl);
+
+  pthread_mutex_lock(&loop->lock);
+  loop->active--;
+  pthread_mutex_unlock(&loop->lock);
+
+  glms_future_finish(request->future, ok);
+  free(request);
+}
+
+static void* glms_fetch_loop_main(void* ptr) {
+  GLMSFetchLoop* loop = (GLMSFetchLoop*)ptr;
+
+  while (true) {
+    glms_fetch_loop_add(loop);
+
+    int running = 0;
+    curl_multi_perform(loop->multi, &running);
+
+    CURLMsg* msg = 0;
+    int left = 0;
+    bool finished = false;
+
+    while ((msg = curl_multi_info_read(loop->multi, &left)) != 0) {
+      if (msg->msg != CURLMSG_DONE) continue;
+      glms_fetch_loop_finish(loop, msg);
+      finished = true;
+    }
+
+    // queued requests can take the place of finished ones right away.
+    if (finished) continue;
+
+    // new requests wake this up through curl_multi_wakeup.
+    curl_multi_poll(loop->multi, 0, 0, 1000, 0);
+  }
+
+  return 0;
+}
 
-  const char* path = glms_ast_get_string_value(&args->items[0]);
+// the loop runs for as long as the process does.
+static void glms_fetch_loop_start() {
+  GLMSFetchLoop* loop = &glms_fetch_loop;
 
+  curl_global_init(CURL_GLOBAL_DEFAULT);
+
+  loop->multi = curl_multi_init();
+  loop->share = curl_share_init();
+  curl_share_setopt(loop->share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+  curl_share_setopt(loop->share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+
+  pthread_t thread;
+  pthread_create(&thread, 0, glms_fetch_loop_main, loop);
+  pthread_detach(thread);
+}
+
+void glms_fetch_set_max_concurrent(int64_t max) {
+  GLMSFetchLoop* loop = &glms_fetch_loop;
+
+  pthread_mutex_lock(&loop->lock);
+  loop->max_active = MAX(max, 1);
+  pthread_mutex_unlock(&loop->lock);
+
+  if (loop->multi != 0) curl_multi_wakeup(loop->multi);
+}
+
+static GLMSAST* glms_fetch_resolve(GLMSEnv* env, GLMSFuture* future) {
   GLMSFetchResponse* response = NEW(GLMSFetchResponse);
+  response->data = future->data;
+  response->len = future->length;
+  response->code = future->status;
+  future->data = 0;
+  future->length = 0;
+
+  GLMSAST* new_ast = glms_env_new_ast(env, GLMS_AST_TYPE_STRUCT, true);
+  new_ast->ptr = response;
+  glms_response_constructor(&env->eval, &env->stack, 0, new_ast);
+
+  return new_ast;
+}
+
+static GLMSFuture* glms_fetch_request(GLMSEnv* env, const char* url) {
+  if (!url) GLMS_ERROR_RETURN(0, stderr, "Expected a URL.\n");
+
+  pthread_once(&glms_fetch_loop_once, glms_fetch_loop_start);
+
+  GLMSFuture* future = glms_future_new(env, 0, glms_fetch_resolve);
+  if (!future) return 0;
+
+  future->path = strdup(url);
+  glms_future_begin(future);
+
+  CURL* curl = curl_easy_init();
 
-  curl_easy_setopt(curl, CURLOPT_URL, path);
+  if (!curl) {
+    GLMS_WARNING(stderr, "Failed to initialize curl.\n");
+    glms_future_finish(future, false);
+    return future;
+  }
+
+  GLMSFetchRequest* request = NEW(GLMSFetchRequest);
+  request->future = future;
+  request->curl = curl;
+
+  curl_easy_setopt(curl, CURLOPT_URL, future->path);
   curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writefunc);
-  curl_easy_setopt(curl, CURLOPT_WRITEDATA, response);
-  curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1);
-  curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "");
-  res = curl_easy_perform(curl);
+  curl_easy_setopt(curl, CURLOPT_WRITEDATA, future);
+  curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+  curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+  curl_easy_setopt(curl, CURLOPT_PRIVATE, request);
 
-  long http_code = 0;
-  curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
-  response->code = http_code;
-  curl_easy_cleanup(curl);
+  GLMSFetchLoop* loop = &glms_fetch_loop;
 
+  pthread_mutex_lock(&loop->lock);
+  if (loop->tail) loop->tail->next = request;
+  loop->tail = request;
+  if (!loop->head) loop->head = request;
+  pthread_mutex_unlock(&loop->lock);
 
-  GLMSAST* new_ast = glms_env_new_ast(eval->env, GLMS_AST_TYPE_STRUCT, true);
-  new_ast->ptr = response;
+  curl_multi_wakeup(loop->multi);
+
+  return future;
+}
+
+int glms_fptr_fetch(GLMSEval *eval, GLMSAST *ast, GLMSASTBuffer *args,
+                    GLMSStack *stack, GLMSAST *out) {
+
+
+  if (!glms_eval_expect(eval, stack, (GLMSASTType[]){ GLMS_AST_TYPE_STRING }, 1, args)) return 0;
+
+  GLMSFuture* future = glms_fetch_request(eval->env, glms_ast_get_string_value(&args->items[0]));
+  if (!future) return 0;
+
+  // still goes through the loop, to reuse its connections.
+  GLMSAST* new_ast = glms_future_await(future);
 
   *out = (GLMSAST){ .type = GLMS_AST_TYPE_STACK_PTR, .as.stackptr.ptr = new_ast };
 
   return 1;
 }
 
+int glms_fptr_fetch_async(GLMSEval *eval, GLMSAST *ast, GLMSASTBuffer *args,
+                          GLMSStack *stack, GLMSAST *out) {
+
+  if (!glms_eval_expect(eval, stack, (GLMSASTType[]){ GLMS_AST_TYPE_STRING }, 1, args)) return 0;
+
+  GLMSFuture* future = glms_fetch_request(eval->env, glms_ast_get_string_value(&args->items[0]));
+  if (!future) return 0;
+
+  *out = (GLMSAST){ .type = GLMS_AST_TYPE_STACK_PTR, .as.stackptr.ptr = glms_future_new_ast(eval->env, future) };
+
+  return 1;
+}
+
+int glms_fptr_fetch_all(GLMSEval *eval, GLMSAST *ast, GLMSASTBuffer *args,
+                        GLMSStack *stack, GLMSAST *out) {
+
+  if (!glms_eval_expect(eval, stack, (GLMSASTType[]){ GLMS_AST_TYPE_ARRAY }, 1, args)) return 0;
+
+  GLMSAST* ptr = glms_ast_get_ptr(args->items[0]);
+  GLMSAST* array = ptr ? ptr : &args->items[0];
+  int64_t length = array->children ? array->children->length : 0;
+
+  GLMSFuture** parts = (GLMSFuture**)calloc(MAX(length, 1), sizeof(GLMSFuture*));
+
+  for (int64_t i = 0; i < length; i++) {
+    GLMSAST url = glms_eval(eval, *array->children->items[i], stack);
+    parts[i] = glms_fetch_request(eval->env, glms_ast_get_string_value(&url));
+
+    if (!parts[i]) {
+      free(parts);
+      GLMS_ERROR_RETURN(0, stderr, "Expected a URL at index `%ld`.\n", i);
+    }
+  }
+
+  GLMSFuture* future = glms_future_all(eval->env, parts, length);
+  free(parts);
+
+  if (!future) return 0;
+
+  *out = (GLMSAST){ .type = GLMS_AST_TYPE_STACK_PTR, .as.stackptr.ptr = glms_future_new_ast(eval->env, future) };
+
+  return 1;
+}
+
 int glms_response_fptr_text(GLMSEval *eval, GLMSAST *ast, GLMSASTBuffer *args,
                             GLMSStack *stack, GLMSAST *out) {
   if (!ast->ptr) GLMS_WARNING_RETURN(0, stderr, "ptr == null.\n");
@@ -159,11 +365,12 @@ void glms_response_constructor(GLMSEval *eval, GLMSStack *stack,
                                GLMSASTBuffer *args, GLMSAST *self) {
 
   self->constructor = glms_response_constructor;
-  glms_ast_register_function(eval->env, self, "text", glms_response_fptr_text);
-  glms_ast_register_function(eval->env, self, "json", glms_response_fptr_json);
-  glms_ast_register_function(eval->env, self, "data", glms_response_fptr_json);
-  glms_ast_register_function(eval->env, self, "status", glms_response_fptr_status);
-  
+
+  // methods live on the registered "response" type.
+  if (!self->value_type) {
+    GLMSAST *t = glms_env_lookup_type(eval->env, "response");
+    self->value_type = t != self ? t : 0;
+  }
 }
 
 void glms_fetch(GLMSEnv *env) {
@@ -172,6 +379,31 @@ void glms_fetch(GLMSEnv *env) {
   t->constructor = glms_response_constructor;
   glms_env_register_type(env, "response", t, glms_response_constructor, 0, glms_response_to_string, glms_response_destructor);
 
+  glms_ast_register_function(env, t, "text", glms_response_fptr_text);
+  glms_ast_register_function(env, t, "json", glms_response_fptr_json);
+  glms_ast_register_function(env, t, "data", glms_response_fptr_json);
+  glms_ast_register_function(env, t, "status", glms_response_fptr_status);
+
+  glms_env_register_function(env, "fetchAsync", glms_fptr_fetch_async);
+  glms_env_register_function_signature(env, 0, "fetchAsync", (GLMSFunctionSignature){
+      .return_type = (GLMSType){ .typename = "future" },
+      .args = (GLMSType[]) {
+	(GLMSType){ GLMS_AST_TYPE_STRING, .valuename = "URL" }
+      },
+      .args_length = 1,
+      .description = "Like fetch, but returns a future of the response."
+  });
+
+  glms_env_register_function(env, "fetchAll", glms_fptr_fetch_all);
+  glms_env_register_function_signature(env, 0, "fetchAll", (GLMSFunctionSignature){
+      .return_type = (GLMSType){ .typename = "future" },
+      .args = (GLMSType[]) {
+	(GLMSType){ GLMS_AST_TYPE_ARRAY, .valuename = "URLs" }
+      },
+      .args_length = 1,
+      .description = "Requests every URL at once, the future resolves to an array of responses in order."
+  });
+
   glms_env_register_function(env, "fetch", glms_fptr_fetch);
   glms_env_register_function_signature(env, 0, "fetch", (GLMSFunctionSignature){
       .return_type = (GLMSType){ .typename = "response" },
@@ -7,8 +7,10 @@
 #include "glms/macros.h"
 #include "glms/string_view.h"
 #include <glms/modules/file.h>
+#include <glms/modules/future.h>
 #include <glms/io.h>
 #include <stdio.h>
+#include <string.h>
 
 // typedef char* (*GLMSASTToString)(struct GLMS_AST_STRUCT *ast, GLMSAllocator alloc);
 
@@ -84,6 +86,87 @@ int glms_file_fptr_write(GLMSEval *eval, GLMSAST *ast, GLMSASTBuffer *args,
   return 1;
 }
 
+// paths are resolved like in `open`, before the work leaves this thread.
+static const char* glms_file_get_path(GLMSEval *eval, const char* filepath) {
+  if (filepath[0] != '/' && !glms_file_exists(filepath)) {
+    const char* nextpath = glms_env_get_path_for(eval->env, filepath);
+    if (nextpath != 0) filepath = nextpath;
+  }
+
+  return filepath;
+}
+
+static int glms_file_read_work(GLMSFuture* future) {
+  future->data = glms_get_file_contents(future->path);
+  future->length = future->data ? strlen(future->data) : 0;
+
+  return future->data != 0;
+}
+
+static GLMSAST* glms_file_read_resolve(GLMSEnv* env, GLMSFuture* future) {
+  if (!future->ok) GLMS_WARNING_RETURN(0, stderr, "Failed to read `%s`.\n", future->path);
+
+  return glms_env_new_ast_string(env, future->data, true);
+}
+
+static int glms_file_write_work(GLMSFuture* future) {
+  FILE* fp = fopen(future->path, "w");
+  if (!fp) return 0;
+
+  size_t written = fwrite(future->data, sizeof(char), future->length, fp);
+  fclose(fp);
+
+  return written == (size_t)future->length;
+}
+
+static GLMSAST* glms_file_write_resolve(GLMSEnv* env, GLMSFuture* future) {
+  if (!future->ok) GLMS_WARNING(stderr, "Failed to write `%s`.\n", future->path);
+
+  GLMSAST* ast = glms_env_new_ast(env, GLMS_AST_TYPE_BOOL, true);
+  ast->as.boolean = future->ok;
+  return ast;
+}
+
+int glms_file_fptr_read_async(GLMSEval *eval, GLMSAST *ast, GLMSASTBuffer *args,
+                              GLMSStack *stack, GLMSAST *out) {
+
+  if (!glms_eval_expect(eval, stack, (GLMSASTType[]){ GLMS_AST_TYPE_STRING }, 1, args)) return 0;
+
+  const char* filepath = glms_ast_get_string_value(&args->items[0]);
+  if (!filepath) GLMS_ERROR_RETURN(0, stderr, "Expected a path.\n");
+
+  GLMSFuture* future = glms_future_new(eval->env, glms_file_read_work, glms_file_read_resolve);
+  if (!future) return 0;
+
+  future->path = strdup(glms_file_get_path(eval, filepath));
+  glms_future_start(future);
+
+  *out = (GLMSAST){ .type = GLMS_AST_TYPE_STACK_PTR, .as.stackptr.ptr = glms_future_new_ast(eval->env, future) };
+
+  return 1;
+}
+
+int glms_file_fptr_write_async(GLMSEval *eval, GLMSAST *ast, GLMSASTBuffer *args,
+                               GLMSStack *stack, GLMSAST *out) {
+
+  if (!glms_eval_expect(eval, stack, (GLMSASTType[]){ GLMS_AST_TYPE_STRING, GLMS_AST_TYPE_STRING }, 2, args)) return 0;
+
+  const char* filepath = glms_ast_get_string_value(&args->items[0]);
+  const char* text = glms_ast_get_string_value(&args->items[1]);
+  if (!filepath) GLMS_ERROR_RETURN(0, stderr, "Expected a path.\n");
+
+  GLMSFuture* future = glms_future_new(eval->env, glms_file_write_work, glms_file_write_resolve);
+  if (!future) return 0;
+
+  future->path = strdup(glms_file_get_path(eval, filepath));
+  future->data = strdup(text ? text : "");
+  future->length = strlen(future->data);
+  glms_future_start(future);
+
+  *out = (GLMSAST){ .type = GLMS_AST_TYPE_STACK_PTR, .as.stackptr.ptr = glms_future_new_ast(eval->env, future) };
+
+  return 1;
+}
 
 int glms_file_iterator_next(GLMSEnv* env, GLMSAST *self, GLMSIterator *it, GLMSAST *out) {
   GLMSFileIteratorState* state = (GLMSFileIteratorState*)self->as.iterator.state;
@@ -175,15 +258,53 @@ void glms_file_constructor(GLMSEval *eval, GLMSStack *stack,
   self->type = GLMS_AST_TYPE_STRUCT;
   self->constructor = glms_file_constructor;
   //self->to_string = glms_file_to_string;
-  glms_ast_register_function(eval->env, self, "open", glms_file_fptr_open);
-  glms_ast_register_function(eval->env, self, "close", glms_file_fptr_close);
-  glms_ast_register_function(eval->env, self, "write", glms_file_fptr_write);
-  glms_ast_register_function(eval->env, self, "readLines", glms_file_fptr_read_lines);
-  glms_ast_register_function(eval->env, self, "read", glms_file_fptr_read);
+
+  // methods live on the registered "file" type.
+  if (!self->value_type) {
+    GLMSAST *t = glms_env_lookup_type(eval->env, "file");
+    self->value_type = t != self ? t : 0;
+  }
+}
+
+void glms_file_type(GLMSEnv *env) {
+  GLMSAST* t = glms_env_new_ast(env, GLMS_AST_TYPE_STRUCT, false);
+  glms_env_register_type(env, "file", t, glms_file_constructor, 0, 0/*glms_file_to_string*/, 0);
+
+  glms_ast_register_function(env, t, "open", glms_file_fptr_open);
+  glms_ast_register_function(env, t, "close", glms_file_fptr_close);
+  glms_ast_register_function(env, t, "write", glms_file_fptr_write);
+  glms_ast_register_function(env, t, "readLines", glms_file_fptr_read_lines);
+  glms_ast_register_function(env, t, "read", glms_file_fptr_read);
+  glms_ast_register_function(env, t, "readAsync", glms_file_fptr_read_async);
+  glms_ast_register_function(env, t, "writeAsync", glms_file_fptr_write_async);
+
+  glms_env_register_function_signature(
+    env,
+    t,
+    "readAsync",
+    (GLMSFunctionSignature){
+      .return_type = (GLMSType){ .typename = "future" },
+      .args = (GLMSType[]){ (GLMSType){ GLMS_AST_TYPE_STRING, .valuename = "filename" }},
+      .args_length = 1,
+      .description = "Reads the whole file on a background thread, the future resolves to its contents."
+    }
+  );
+
+  glms_env_register_function_signature(
+    env,
+    t,
+    "writeAsync",
+    (GLMSFunctionSignature){
+      .return_type = (GLMSType){ .typename = "future" },
+      .args = (GLMSType[]){ (GLMSType){ GLMS_AST_TYPE_STRING, .valuename = "filename" }, (GLMSType){ GLMS_AST_TYPE_STRING, .valuename = "text" }},
+      .args_length = 2,
+      .description = "Writes the file on a background thread, the future resolves to whether it succeeded."
+    }
+  );
 
   glms_env_register_function_signature(
-    eval->env,
-    self,
+    env,
+    t,
     "readLines",
     (GLMSFunctionSignature){
       .return_type = (GLMSType){ GLMS_AST_TYPE_ITERATOR },
@@ -192,8 +313,8 @@ void glms_file_constructor(GLMSEval *eval, GLMSStack *stack,
   );
 
   glms_env_register_function_signature(
-    eval->env,
-    self,
+    env,
+    t,
     "open",
     (GLMSFunctionSignature){
       .return_type = (GLMSType){ .typename = "file" },
@@ -203,8 +324,8 @@ void glms_file_constructor(GLMSEval *eval, GLMSStack *stack,
   );
 
   glms_env_register_function_signature(
-    eval->env,
-    self,
+    env,
+    t,
     "close",
     (GLMSFunctionSignature){
       .return_type = (GLMSType){ GLMS_AST_TYPE_BOOL },
@@ -213,8 +334,8 @@ void glms_file_constructor(GLMSEval *eval, GLMSStack *stack,
   );
 
   glms_env_register_function_signature(
-    eval->env,
-    self,
+    env,
+    t,
     "write",
     (GLMSFunctionSignature){
       .return_type = (GLMSType){ GLMS_AST_TYPE_BOOL },
@@ -223,7 +344,3 @@ void glms_file_constructor(GLMSEval *eval, GLMSStack *stack,
     }
   );
 }
-
-void glms_file_type(GLMSEnv *env) {
-  glms_env_register_type(env, "file", glms_env_new_ast(env, GLMS_AST_TYPE_STRUCT, false), glms_file_constructor, 0, 0/*glms_file_to_string*/, 0);
-}
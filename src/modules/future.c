@@ -0,0 +1,150 @@
+#include "glms/ast.h"
+#include "glms/ast_type.h"
+#include "glms/env.h"
+#include "glms/eval.h"
+#include "glms/macros.h"
+#include <glms/modules/future.h>
+
+char *glms_future_to_string(GLMSAST *ast, GLMSAllocator alloc, GLMSEnv *env) {
+  GLMSFuture *future = (GLMSFuture *)ast->ptr;
+
+  return alloc.strdup(alloc.user_ptr,
+                      future != 0 && future->state == GLMS_FUTURE_RESOLVED
+                          ? "Future<resolved>"
+                          : "Future<pending>");
+}
+
+GLMSFuture *glms_future_from_ast(GLMSAST ast) {
+  GLMSAST *ptr = glms_ast_get_ptr(ast);
+  if (ptr) ast = *ptr;
+
+  if (ast.constructor != glms_future_constructor) return 0;
+
+  return (GLMSFuture *)ast.ptr;
+}
+
+GLMSAST *glms_future_new_ast(GLMSEnv *env, GLMSFuture *future) {
+  GLMSAST *ast = glms_env_new_ast(env, GLMS_AST_TYPE_STRUCT, true);
+  ast->ptr = future;
+  // the value may be read for as long as the env lives.
+  if (future) future->held = true;
+  glms_future_constructor(&env->eval, &env->stack, 0, ast);
+
+  return ast;
+}
+
+int glms_future_fptr_then(GLMSEval *eval, GLMSAST *ast, GLMSASTBuffer *args,
+                          GLMSStack *stack, GLMSAST *out) {
+  if (!ast->ptr) GLMS_WARNING_RETURN(0, stderr, "ptr == null.\n");
+  if (!args || args->length <= 0)
+    GLMS_ERROR_RETURN(0, stderr, "Expected a function.\n");
+
+  GLMSAST *ptr = glms_ast_get_ptr(args->items[0]);
+  GLMSAST func = ptr ? *ptr : args->items[0];
+
+  if (func.type != GLMS_AST_TYPE_FUNC)
+    GLMS_ERROR_RETURN(0, stderr, "Expected `%s` at arg `0` but got `%s`.\n",
+                      GLMS_AST_TYPE_STR[GLMS_AST_TYPE_FUNC],
+                      GLMS_AST_TYPE_STR[func.type]);
+
+  glms_future_then((GLMSFuture *)ast->ptr, func);
+
+  *out = (GLMSAST){.type = GLMS_AST_TYPE_STACK_PTR, .as.stackptr.ptr = ast};
+
+  return 1;
+}
+
+int glms_future_fptr_await(GLMSEval *eval, GLMSAST *ast, GLMSASTBuffer *args,
+                           GLMSStack *stack, GLMSAST *out) {
+  if (!args || args->length <= 0)
+    GLMS_ERROR_RETURN(0, stderr, "Expected a future.\n");
+
+  GLMSFuture *future = glms_future_from_ast(args->items[0]);
+  if (!future) GLMS_ERROR_RETURN(0, stderr, "Expected a future.\n");
+
+  GLMSAST *value = glms_future_await(future);
+
+  *out = (GLMSAST){.type = GLMS_AST_TYPE_STACK_PTR, .as.stackptr.ptr = value};
+
+  return 1;
+}
+
+int glms_future_fptr_all(GLMSEval *eval, GLMSAST *ast, GLMSASTBuffer *args,
+                         GLMSStack *stack, GLMSAST *out) {
+  if (!glms_eval_expect(eval, stack, (GLMSASTType[]){GLMS_AST_TYPE_ARRAY}, 1,
+                        args))
+    return 0;
+
+  GLMSAST *ptr = glms_ast_get_ptr(args->items[0]);
+  GLMSAST *array = ptr ? ptr : &args->items[0];
+  int64_t length = array->children ? array->children->length : 0;
+
+  GLMSFuture **parts = (GLMSFuture **)calloc(MAX(length, 1), sizeof(GLMSFuture *));
+
+  for (int64_t i = 0; i < length; i++) {
+    parts[i] = glms_future_from_ast(
+        glms_eval(eval, *array->children->items[i], stack));
+
+    if (!parts[i] || parts[i]->env != eval->env) {
+      free(parts);
+      GLMS_ERROR_RETURN(0, stderr, "Expected a future at index `%ld`.\n", i);
+    }
+  }
+
+  GLMSFuture *future = glms_future_all(eval->env, parts, length);
+  free(parts);
+
+  if (!future) return 0;
+
+  *out = (GLMSAST){.type = GLMS_AST_TYPE_STACK_PTR,
+                   .as.stackptr.ptr = glms_future_new_ast(eval->env, future)};
+
+  return 1;
+}
+
+void glms_future_constructor(GLMSEval *eval, GLMSStack *stack,
+                             GLMSASTBuffer *args, GLMSAST *self) {
+  self->constructor = glms_future_constructor;
+
+  // methods live on the registered "future" type.
+  if (!self->value_type) {
+    GLMSAST *t = glms_env_lookup_type(eval->env, "future");
+    self->value_type = t != self ? t : 0;
+  }
+}
+
+void glms_future_type(GLMSEnv *env) {
+  GLMSAST *t = glms_env_new_ast(env, GLMS_AST_TYPE_STRUCT, false);
+  t->constructor = glms_future_constructor;
+  glms_env_register_type(env, "future", t, glms_future_constructor, 0,
+                         glms_future_to_string, 0);
+
+  glms_ast_register_function(env, t, "then", glms_future_fptr_then);
+  glms_env_register_function_signature(
+      env, t, "then",
+      (GLMSFunctionSignature){
+          .return_type = (GLMSType){.typename = "future"},
+          .args = (GLMSType[]){(GLMSType){GLMS_AST_TYPE_FUNC}},
+          .args_length = 1,
+          .description = "Calls func(value) once the future is resolved."});
+
+  glms_env_register_function(env, "await", glms_future_fptr_await);
+  glms_env_register_function_signature(
+      env, 0, "await",
+      (GLMSFunctionSignature){
+          .return_type = (GLMSType){GLMS_AST_TYPE_UNDEFINED},
+          .args = (GLMSType[]){(GLMSType){.typename = "future"}},
+          .args_length = 1,
+          .description = "Waits for the future and returns its value."});
+
+  glms_env_register_function(env, "all", glms_future_fptr_all);
+  glms_env_register_function_signature(
+      env, 0, "all",
+      (GLMSFunctionSignature){
+          .return_type = (GLMSType){.typename = "future"},
+          .args = (GLMSType[]){(GLMSType){GLMS_AST_TYPE_ARRAY,
+                                          .valuename = "futures"}},
+          .args_length = 1,
+          .description = "A future of the values of every future in the "
+                         "array, in order."});
+}
@@ -8,6 +8,7 @@
 #include <glms/modules/image.h>
 #include <glms/env.h>
 #include <glms/eval.h>
+#include <glms/parallel.h>
 #include <text/text.h>
 
 int glms_struct_image_fptr_get_pixel(GLMSEval *eval, GLMSAST *ast,
@@ -71,6 +72,7 @@ int glms_struct_image_fptr_make(GLMSEval *eval, GLMSAST *ast,
   }
 
   imgast->ptr = gimg;
+  glms_struct_image_constructor(eval, stack, 0, imgast);
 
   *out = (GLMSAST){ .type = GLMS_AST_TYPE_STACK_PTR, .as.stackptr.ptr = imgast };
 
@@ -131,17 +133,25 @@ int glms_struct_image_fptr_load(GLMSEval *eval, GLMSAST *ast,
 }
 
 
-int glms_struct_image_fptr_shade(GLMSEval *eval, GLMSAST *ast,
-                                      GLMSASTBuffer *args, GLMSStack *stack, GLMSAST* out) {
+typedef struct {
+  GIMG *gimg;
+  GLMSAST func;
+  int64_t columns;
+  GLMSEnv *scratch;
+} GLMSImageShade;
 
-  if (!args || args->length <= 0)
-    return 0;
-  if (!ast->ptr)
-    GLMS_WARNING_RETURN(0, stderr, "Image not initialized (ptr = null).\n");
+// evaluates one tile, rows top to bottom to follow the pixel buffer.
+static int glms_struct_image_shade_tile(GLMSEval *eval, GLMSStack *stack,
+                                        int64_t tile, void *user_ptr) {
+  GLMSImageShade *shade = (GLMSImageShade *)user_ptr;
+  GIMG *gimg = shade->gimg;
 
-  GIMG *gimg = (GIMG *)ast->ptr;
+  if (shade->scratch != 0) eval = &shade->scratch->eval;
 
-  GLMSAST arg0 = args->items[0];
+  int x0 = (tile % shade->columns) * GLMS_IMAGE_SHADE_TILE_SIZE;
+  int y0 = (tile / shade->columns) * GLMS_IMAGE_SHADE_TILE_SIZE;
+  int x1 = MIN(x0 + GLMS_IMAGE_SHADE_TILE_SIZE, gimg->width);
+  int y1 = MIN(y0 + GLMS_IMAGE_SHADE_TILE_SIZE, gimg->height);
 
   const char *signature[] = {"uv", "fragCoord", "resolution"};
 
@@ -152,19 +162,16 @@ int glms_struct_image_fptr_shade(GLMSEval *eval, GLMSAST *ast,
 
   GLMSAST *signature_values[] = {uv_ast, coord_ast, res_ast};
 
-  GLMSAST call_ast = (GLMSAST){ .type = GLMS_AST_TYPE_CALL };//glms_env_new_ast(eval->env, GLMS_AST_TYPE_CALL, false);
-  call_ast.as.call.func = &arg0;
-
-  //GLMSStack tmp_stack = {0};
-  // glms_stack_init(&tmp_stack);
-  // glms_stack_copy(*stack, &tmp_stack);
-
   for (int j = 0; j < 3; j++) {
     glms_stack_push(stack, signature[j], signature_values[j]);
   }
 
-  for (int x = 0; x < gimg->width; x++) {
-    for (int y = 0; y < gimg->height; y++) {
+  GLMSAST func = shade->func;
+  GLMSAST call_ast = (GLMSAST){ .type = GLMS_AST_TYPE_CALL };
+  call_ast.as.call.func = &func;
+
+  for (int y = y0; y < y1; y++) {
+    for (int x = x0; x < x1; x++) {
       float u = (float)x / (float)gimg->width;
       float v = (float)y / (float)gimg->height;
       uv_ast->as.v3 = VEC3(u, v, 0);
@@ -174,24 +181,66 @@ int glms_struct_image_fptr_shade(GLMSEval *eval, GLMSAST *ast,
 
       result = glms_eval(eval, result, stack);
 
-
       if (result.type == GLMS_AST_TYPE_VEC4) {
-	Vector4 translated = result.as.v4;
-	translated.x *= 255.0f;
-	translated.y *= 255.0f;
-	translated.z *= 255.0f;
-	translated.w *= 255.0f;
-        if (!gimg_set_pixel_vec4(gimg, x, y, translated)) {
-	  goto done;
-	}
+        Vector4 translated = result.as.v4;
+        translated.x *= 255.0f;
+        translated.y *= 255.0f;
+        translated.z *= 255.0f;
+        translated.w *= 255.0f;
+        if (!gimg_set_pixel_vec4(gimg, x, y, translated)) return 0;
       }
     }
   }
 
- done:
+  return 1;
+}
+
+int glms_struct_image_fptr_shade(GLMSEval *eval, GLMSAST *ast,
+                                      GLMSASTBuffer *args, GLMSStack *stack, GLMSAST* out) {
+
+  if (!args || args->length <= 0)
+    return 0;
+  if (!ast->ptr)
+    GLMS_WARNING_RETURN(0, stderr, "Image not initialized (ptr = null).\n");
+
+  GIMG *gimg = (GIMG *)ast->ptr;
+
+  // one thread unless asked for more, 0 means one per core.
+  int64_t threads = 1;
+  if (args->length > 1) {
+    GLMSAST arg1 = glms_eval(eval, args->items[1], stack);
+    if (arg1.type == GLMS_AST_TYPE_NUMBER) threads = (int64_t)glms_ast_number(arg1);
+  }
+
+  int64_t columns = (gimg->width + GLMS_IMAGE_SHADE_TILE_SIZE - 1) / GLMS_IMAGE_SHADE_TILE_SIZE;
+  int64_t rows = (gimg->height + GLMS_IMAGE_SHADE_TILE_SIZE - 1) / GLMS_IMAGE_SHADE_TILE_SIZE;
+
+  GLMSImageShade shade = { .gimg = gimg, .func = args->items[0], .columns = columns };
+
+  // on one thread the tiles run on the caller's env, which would keep
+  // every node they allocate. They get an env of their own instead,
+  // set up like a worker's and cleared once the image is shaded.
+  GLMSEnv scratch = {0};
+  bool serial = MIN(glms_parallel_get_threads(threads), columns * rows) <= 1;
+
+  if (serial) {
+    GLMSConfig cfg = eval->env->config;
+    cfg.memo_ast = 0;
+
+    scratch.parent = eval->env;
+    scratch.has_builtins = true;
+    glms_env_init(&scratch, 0, eval->env->entry_path, cfg);
+    scratch.use_arena = true;
+    scratch.isolated = true;
+    shade.scratch = &scratch;
+  }
+
+  bool ok = glms_parallel_run(eval, stack, threads, columns * rows,
+                              glms_struct_image_shade_tile, 0, &shade);
+
+  if (serial) glms_env_clear(&scratch);
 
-  // glms_stack_clear_trash(&tmp_stack);
-  //glms_stack_clear(&tmp_stack);
+  *out = (GLMSAST){ .type = GLMS_AST_TYPE_BOOL, .as.boolean = ok };
 
   return 1;
 }
@@ -200,27 +249,56 @@ void glms_struct_image_constructor(GLMSEval *eval, GLMSStack *stack,
                                        GLMSASTBuffer *args, GLMSAST *self) {
   if (!self) return;
   GLMSAST *ast = self;
-  ast->value_type = ast;
   ast->constructor = glms_struct_image_constructor;
- 
 
-  glms_ast_register_function(eval->env, ast, "getPixel",
+  // methods live on the registered "image" type, instances only carry the pixels.
+  if (!ast->value_type) {
+    GLMSAST *t = glms_env_lookup_type(eval->env, "image");
+    ast->value_type = t != ast ? t : 0;
+  }
+}
+
+void glms_struct_image_destructor(GLMSAST *ast) {
+  if (!ast)
+    return;
+
+  if (!ast->ptr)
+    return;
+
+  GIMG *gimg = (GIMG *)ast->ptr;
+
+  gimg_free(gimg, true);
+
+  ast->ptr = 0;
+}
+
+void glms_struct_image(GLMSEnv *env) {
+  GLMSAST *ast = glms_env_new_ast(env, GLMS_AST_TYPE_STRUCT, false);
+  ast->constructor = glms_struct_image_constructor;
+  //  ast->to_string = glms_struct_image_to_string;
+  //  ast->ptr = NEW(GIMG);
+
+  glms_env_register_type(env, "image", ast, glms_struct_image_constructor, 0,
+                         0,
+                         glms_struct_image_destructor);
+
+  glms_ast_register_function(env, ast, "getPixel",
                              glms_struct_image_fptr_get_pixel);
-  glms_ast_register_function(eval->env, ast, "setPixel",
+  glms_ast_register_function(env, ast, "setPixel",
                              glms_struct_image_fptr_set_pixel);
 
-  glms_ast_register_function(eval->env, ast, "load",
+  glms_ast_register_function(env, ast, "load",
                              glms_struct_image_fptr_load);
   
-  glms_ast_register_function(eval->env, ast, "make",
+  glms_ast_register_function(env, ast, "make",
                              glms_struct_image_fptr_make);
-  glms_ast_register_function(eval->env, ast, "save",
+  glms_ast_register_function(env, ast, "save",
                              glms_struct_image_fptr_save);
-  glms_ast_register_function(eval->env, ast, "shade",
+  glms_ast_register_function(env, ast, "shade",
                              glms_struct_image_fptr_shade);
 
   glms_env_register_function_signature(
-    eval->env,
+    env,
     ast,
     "load",
     (GLMSFunctionSignature){
@@ -231,18 +309,18 @@ void glms_struct_image_constructor(GLMSEval *eval, GLMSStack *stack,
   );
 
   glms_env_register_function_signature(
-    eval->env,
+    env,
     ast,
     "shade",
     (GLMSFunctionSignature){
       .return_type = (GLMSType){GLMS_AST_TYPE_BOOL},
-      .args = (GLMSType[]){ (GLMSType){ GLMS_AST_TYPE_FUNC } },
-      .args_length = 1
+      .args = (GLMSType[]){ (GLMSType){ GLMS_AST_TYPE_FUNC }, (GLMSType){ GLMS_AST_TYPE_NUMBER, .valuename = "threads" } },
+      .args_length = 2
     }
   );
 
   glms_env_register_function_signature(
-    eval->env,
+    env,
     ast,
     "make",
     (GLMSFunctionSignature){
@@ -253,7 +331,7 @@ void glms_struct_image_constructor(GLMSEval *eval, GLMSStack *stack,
   );
 
   glms_env_register_function_signature(
-    eval->env,
+    env,
     ast,
     "setPixel",
     (GLMSFunctionSignature){
@@ -264,7 +342,7 @@ void glms_struct_image_constructor(GLMSEval *eval, GLMSStack *stack,
   );
 
   glms_env_register_function_signature(
-    eval->env,
+    env,
     ast,
     "getPixel",
     (GLMSFunctionSignature){
@@ -275,7 +353,7 @@ void glms_struct_image_constructor(GLMSEval *eval, GLMSStack *stack,
   );
 
   glms_env_register_function_signature(
-    eval->env,
+    env,
     ast,
     "save",
     (GLMSFunctionSignature){
@@ -285,28 +363,3 @@ void glms_struct_image_constructor(GLMSEval *eval, GLMSStack *stack,
     }
   );
 }
-
-void glms_struct_image_destructor(GLMSAST *ast) {
-  if (!ast)
-    return;
-
-  if (!ast->ptr)
-    return;
-
-  GIMG *gimg = (GIMG *)ast->ptr;
-
-  gimg_free(gimg, true);
-
-  ast->ptr = 0;
-}
-
-void glms_struct_image(GLMSEnv *env) {
-  GLMSAST *ast = glms_env_new_ast(env, GLMS_AST_TYPE_STRUCT, false);
-  ast->constructor = glms_struct_image_constructor;
-  //  ast->to_string = glms_struct_image_to_string;
-  //  ast->ptr = NEW(GIMG);
-
-  glms_env_register_type(env, "image", ast, glms_struct_image_constructor, 0,
-                         0,
-                         glms_struct_image_destructor);
-}
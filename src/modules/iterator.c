@@ -30,9 +30,12 @@ void glms_iterator_constructor(GLMSEval *eval, GLMSStack *stack,
   self->type = GLMS_AST_TYPE_ITERATOR;
   self->constructor = glms_iterator_constructor;
   // self->to_string = glms_iterator_to_string;
-  glms_ast_register_function(eval->env, self, "next", glms_iterator_fptr_next);
 }
 
 void glms_iterator_type(GLMSEnv *env) {
-  glms_env_register_type(env, "iterator", glms_env_new_ast(env, GLMS_AST_TYPE_ITERATOR, false), glms_iterator_constructor, 0, 0, 0);
+  GLMSAST* t = glms_env_new_ast(env, GLMS_AST_TYPE_ITERATOR, false);
+  glms_env_register_type(env, "iterator", t, glms_iterator_constructor, 0, 0, 0);
+  glms_env_register_type(env, GLMS_AST_TYPE_STR[GLMS_AST_TYPE_ITERATOR], t, glms_iterator_constructor, 0, 0, 0);
+
+  glms_ast_register_function(env, t, "next", glms_iterator_fptr_next);
 }
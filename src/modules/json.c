@@ -53,10 +53,24 @@ void glms_json_constructor(GLMSEval *eval, GLMSStack *stack,
   self->constructed = true;
 
   self->constructor = glms_json_constructor;
-  glms_ast_register_function(eval->env, self, "parse", glms_json_fptr_parse);
-  glms_ast_register_function(eval->env, self, "stringify", glms_json_fptr_stringify);
 
-  glms_env_register_function_signature(eval->env, self, "parse", (GLMSFunctionSignature){
+  // methods live on the registered "json" type.
+  if (!self->value_type) {
+    GLMSAST *t = glms_env_lookup_type(eval->env, "json");
+    self->value_type = t != self ? t : 0;
+  }
+}
+
+void glms_json(GLMSEnv *env) {
+
+  GLMSAST* t = glms_env_new_ast(env, GLMS_AST_TYPE_STRUCT, false);
+  t->constructor = glms_json_constructor;
+  glms_env_register_type(env, "json", t, glms_json_constructor, 0, 0, 0);
+
+  glms_ast_register_function(env, t, "parse", glms_json_fptr_parse);
+  glms_ast_register_function(env, t, "stringify", glms_json_fptr_stringify);
+
+  glms_env_register_function_signature(env, t, "parse", (GLMSFunctionSignature){
       .return_type = (GLMSType){ GLMS_AST_TYPE_OBJECT },
       .args = (GLMSType[]) {
 	(GLMSType){ GLMS_AST_TYPE_STRING, .valuename = "jsonString" }
@@ -64,7 +78,7 @@ void glms_json_constructor(GLMSEval *eval, GLMSStack *stack,
       .args_length = 1
   });
 
-  glms_env_register_function_signature(eval->env, self, "stringify", (GLMSFunctionSignature){
+  glms_env_register_function_signature(env, t, "stringify", (GLMSFunctionSignature){
       .return_type = (GLMSType){ GLMS_AST_TYPE_STRING },
       .args = (GLMSType[]) {
 	(GLMSType){ GLMS_AST_TYPE_OBJECT }
@@ -72,10 +86,3 @@ void glms_json_constructor(GLMSEval *eval, GLMSStack *stack,
       .args_length = 1
   });
 }
-
-void glms_json(GLMSEnv *env) {
-
-  GLMSAST* t = glms_env_new_ast(env, GLMS_AST_TYPE_STRUCT, false);
-  t->constructor = glms_json_constructor;
-  glms_env_register_type(env, "json", t, glms_json_constructor, 0, 0, 0);
-}
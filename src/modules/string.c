@@ -91,12 +91,19 @@ void glms_string_constructor(GLMSEval *eval, GLMSStack *stack,
   self->to_string = 0;
 
   glms_ast_register_operator_overload(eval->env, self, GLMS_TOKEN_TYPE_ADD, glms_string_type_op_overload_add);
-  glms_ast_register_function(eval->env, self, "replace", glms_string_fptr_replace);
-  glms_ast_register_function(eval->env, self, "includes", glms_string_fptr_includes);
+}
+
+void glms_string_type(GLMSEnv *env) {
+  GLMSAST* t = glms_env_new_ast(env, GLMS_AST_TYPE_STRING, false);
+  glms_env_register_type(env, "string", t, glms_string_constructor, 0, 0, 0);
+  glms_env_register_type(env, GLMS_AST_TYPE_STR[GLMS_AST_TYPE_STRING], t, glms_string_constructor, 0, 0, 0);
+
+  glms_ast_register_function(env, t, "replace", glms_string_fptr_replace);
+  glms_ast_register_function(env, t, "includes", glms_string_fptr_includes);
 
   glms_env_register_function_signature(
-    eval->env,
-    self,
+    env,
+    t,
     "replace",
     (GLMSFunctionSignature){
       .return_type = (GLMSType){ GLMS_AST_TYPE_STRING },
@@ -106,8 +113,8 @@ void glms_string_constructor(GLMSEval *eval, GLMSStack *stack,
   );
 
   glms_env_register_function_signature(
-    eval->env,
-    self,
+    env,
+    t,
     "includes",
     (GLMSFunctionSignature){
       .return_type = (GLMSType){ GLMS_AST_TYPE_BOOL },
@@ -116,8 +123,3 @@ void glms_string_constructor(GLMSEval *eval, GLMSStack *stack,
     }
   );
 }
-
-void glms_string_type(GLMSEnv *env) {
-  glms_env_register_type(env, "string", glms_env_new_ast(env, GLMS_AST_TYPE_STRING, false), glms_string_constructor, 0, 0, 0);
-  glms_env_register_type(env, GLMS_AST_TYPE_STR[GLMS_AST_TYPE_STRING], glms_env_new_ast(env, GLMS_AST_TYPE_STRING, false), glms_string_constructor, 0, 0, 0);
-}
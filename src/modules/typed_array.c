@@ -0,0 +1,150 @@
+#include "glms/allocator.h"
+#include "glms/ast.h"
+#include "glms/ast_type.h"
+#include "glms/env.h"
+#include "glms/eval.h"
+#include "glms/macros.h"
+#include <glms/modules/typed_array.h>
+
+// Typed arrays are views into memory owned by the host,
+// elements are read and written in place and never copied into nodes.
+
+static void *glms_typed_array_get_element(GLMSAST *ast, int64_t index) {
+  if (!ast->as.typed_array.data) return 0;
+
+  if (index < 0 || index >= ast->as.typed_array.length)
+    GLMS_WARNING_RETURN(0, stderr, "index %ld out of bounds (%ld).\n", index,
+                        ast->as.typed_array.length);
+
+  return (char *)ast->as.typed_array.data + index * ast->as.typed_array.stride;
+}
+
+int glms_typed_array_get(GLMSAST *ast, int64_t index, GLMSAST *out) {
+  if (!ast || !out) return 0;
+
+  void *mem = glms_typed_array_get_element(ast, index);
+  if (!mem) return 0;
+
+  return glms_ast_read_memory(ast->as.typed_array.element_type, mem, out);
+}
+
+int glms_typed_array_set(GLMSAST *ast, int64_t index, GLMSAST value) {
+  if (!ast) return 0;
+
+  if (!ast->as.typed_array.writable)
+    GLMS_WARNING_RETURN(0, stderr, "typed array is read-only.\n");
+
+  void *mem = glms_typed_array_get_element(ast, index);
+  if (!mem) return 0;
+
+  return glms_ast_write_memory(ast->as.typed_array.element_type, mem, value);
+}
+
+char *glms_typed_array_to_string(GLMSAST *ast, GLMSAllocator alloc,
+                                 GLMSEnv *env) {
+  char *s = 0;
+  alloc.strcat(alloc.user_ptr, &s, "[");
+
+  for (int64_t i = 0; i < ast->as.typed_array.length; i++) {
+    GLMSAST value = {0};
+    if (!glms_typed_array_get(ast, i, &value)) break;
+
+    char *valuestr = glms_ast_to_string(value, alloc, env);
+    if (valuestr == 0) continue;
+    alloc.strcat(alloc.user_ptr, &s, valuestr);
+
+    if (i < ast->as.typed_array.length - 1) {
+      alloc.strcat(alloc.user_ptr, &s, ", ");
+    }
+  }
+
+  alloc.strcat(alloc.user_ptr, &s, "]");
+
+  return s;
+}
+
+int glms_typed_array_fptr_length(GLMSEval *eval, GLMSAST *ast,
+                                 GLMSASTBuffer *args, GLMSStack *stack,
+                                 GLMSAST *out) {
+  *out = (GLMSAST){.type = GLMS_AST_TYPE_NUMBER,
+                   .as.number.value = (float)ast->as.typed_array.length};
+  return 1;
+}
+
+int glms_typed_array_fptr_map(GLMSEval *eval, GLMSAST *ast,
+                              GLMSASTBuffer *args, GLMSStack *stack,
+                              GLMSAST *out) {
+  if (!glms_eval_expect(eval, stack, (GLMSASTType[]){GLMS_AST_TYPE_FUNC}, 1,
+                        args))
+    return 0;
+
+  GLMSAST *new_array = glms_env_new_ast(eval->env, GLMS_AST_TYPE_ARRAY, true);
+
+  GLMSAST func = args->items[0];
+
+  for (int64_t i = 0; i < ast->as.typed_array.length; i++) {
+    GLMSAST value = {0};
+    if (!glms_typed_array_get(ast, i, &value)) break;
+
+    GLMSASTBuffer call_args = (GLMSASTBuffer){
+        .initialized = true, .items = (GLMSAST[]){value}, .length = 1};
+
+    GLMSAST mapped = glms_eval(
+        eval, glms_eval_call_func(eval, stack, &func, call_args), stack);
+
+    glms_ast_push(new_array, glms_ast_copy(mapped, eval->env));
+  }
+
+  *out = (GLMSAST){.type = GLMS_AST_TYPE_STACK_PTR,
+                   .as.stackptr.ptr = new_array};
+
+  return 1;
+}
+
+int glms_typed_array_fptr_for_each(GLMSEval *eval, GLMSAST *ast,
+                                   GLMSASTBuffer *args, GLMSStack *stack,
+                                   GLMSAST *out) {
+  if (!glms_eval_expect(eval, stack, (GLMSASTType[]){GLMS_AST_TYPE_FUNC}, 1,
+                        args))
+    return 0;
+
+  GLMSAST func = args->items[0];
+
+  for (int64_t i = 0; i < ast->as.typed_array.length; i++) {
+    GLMSAST value = {0};
+    if (!glms_typed_array_get(ast, i, &value)) break;
+
+    GLMSASTBuffer call_args = (GLMSASTBuffer){
+        .initialized = true,
+        .items = (GLMSAST[]){value, (GLMSAST){.type = GLMS_AST_TYPE_NUMBER,
+                                              .as.number.value = (float)i}},
+        .length = 2};
+
+    glms_eval_call_func(eval, stack, &func, call_args);
+  }
+
+  return 1;
+}
+
+void glms_typed_array_constructor(GLMSEval *eval, GLMSStack *stack,
+                                  GLMSASTBuffer *args, GLMSAST *self) {
+  if (!self) return;
+  self->type = GLMS_AST_TYPE_TYPED_ARRAY;
+  self->constructor = glms_typed_array_constructor;
+  self->to_string = glms_typed_array_to_string;
+}
+
+void glms_typed_array_type(GLMSEnv *env) {
+  GLMSAST *t = glms_env_new_ast(env, GLMS_AST_TYPE_TYPED_ARRAY, false);
+  glms_env_register_type(env, "typedarray", t, glms_typed_array_constructor,
+                         0, glms_typed_array_to_string, 0);
+  glms_env_register_type(env, GLMS_AST_TYPE_STR[GLMS_AST_TYPE_TYPED_ARRAY], t,
+                         glms_typed_array_constructor, 0,
+                         glms_typed_array_to_string, 0);
+
+  glms_ast_register_function(env, t, "map", glms_typed_array_fptr_map);
+  glms_ast_register_function(env, t, "forEach",
+                             glms_typed_array_fptr_for_each);
+  glms_ast_register_function(env, t, "length", glms_typed_array_fptr_length);
+  glms_ast_register_function(env, t, "count", glms_typed_array_fptr_length);
+}
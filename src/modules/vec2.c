@@ -205,11 +205,13 @@ void glms_struct_vec2(GLMSEnv *env) {
   GLMSAST* t = glms_env_new_ast(env, GLMS_AST_TYPE_VEC2, false);
   glms_env_register_type(
       env, "vec2", t,
-      glms_struct_vec2_constructor, glms_struct_vec2_swizzle, 0, 0);
+      glms_struct_vec2_constructor, glms_struct_vec2_swizzle,
+      glms_struct_vec2_to_string, 0);
 
   glms_env_register_type(
       env, GLMS_AST_TYPE_STR[GLMS_AST_TYPE_VEC2], t,
-      glms_struct_vec2_constructor, glms_struct_vec2_swizzle, 0, 0);
+      glms_struct_vec2_constructor, glms_struct_vec2_swizzle,
+      glms_struct_vec2_to_string, 0);
   //  glms_env_register_struct(env, "vec2", (GLMSAST*[]){
   //    glms_env_new_ast_field(env, GLMS_TOKEN_TYPE_SPECIAL_NUMBER, "x"),
   //    glms_env_new_ast_field(env, GLMS_TOKEN_TYPE_SPECIAL_NUMBER, "y"),
@@ -211,9 +211,6 @@ void glms_struct_vec3_constructor(GLMSEval *eval, GLMSStack *stack,
     glms_ast_register_operator_overload(eval->env, ast, GLMS_TOKEN_TYPE_ADD,
                                       glms_struct_vec3_op_overload_add);
 
-  glms_ast_register_func_overload(eval->env, ast, "mix", glms_struct_vec3_func_overload_mix);
-  glms_ast_register_func_overload(eval->env, ast, "lerp", glms_struct_vec3_func_overload_mix);
-
   if (!args)
     return;
 
@@ -233,11 +230,16 @@ void glms_struct_vec3(GLMSEnv *env) {
   GLMSAST* t = glms_env_new_ast(env, GLMS_AST_TYPE_VEC3, false);
   glms_env_register_type(
       env, "vec3", t,
-      glms_struct_vec3_constructor, glms_struct_vec3_swizzle, 0, 0);
+      glms_struct_vec3_constructor, glms_struct_vec3_swizzle,
+      glms_struct_vec3_to_string, 0);
 
   glms_env_register_type(
       env, GLMS_AST_TYPE_STR[GLMS_AST_TYPE_VEC3], t,
-      glms_struct_vec3_constructor, glms_struct_vec3_swizzle, 0, 0);
+      glms_struct_vec3_constructor, glms_struct_vec3_swizzle,
+      glms_struct_vec3_to_string, 0);
+
+  glms_ast_register_func_overload(env, t, "mix", glms_struct_vec3_func_overload_mix);
+  glms_ast_register_func_overload(env, t, "lerp", glms_struct_vec3_func_overload_mix);
   //  glms_env_register_struct(env, "vec3", (GLMSAST*[]){
   //    glms_env_new_ast_field(env, GLMS_TOKEN_TYPE_SPECIAL_NUMBER, "x"),
   //    glms_env_new_ast_field(env, GLMS_TOKEN_TYPE_SPECIAL_NUMBER, "y"),
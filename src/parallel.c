@@ -0,0 +1,299 @@
+#include <glms/builtin.h>
+#include <glms/macros.h>
+#include <glms/parallel.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef struct {
+  GLMSParallelTask task;
+  void *user_ptr;
+  struct GLMS_PARALLEL_WORKER_STRUCT *workers;
+  int64_t threads;
+  bool stop;
+} GLMSParallelJob;
+
+// the tasks a worker has left, [begin, end).
+typedef struct {
+  pthread_mutex_t lock;
+  int64_t begin;
+  int64_t end;
+} GLMSParallelDeque;
+
+typedef struct GLMS_PARALLEL_WORKER_STRUCT {
+  GLMSParallelJob *job;
+  int64_t index;
+  pthread_t thread;
+  GLMSEnv env;
+  GLMSStack stack;
+  GLMSParallelDeque deque;
+  int64_t steals;
+  int64_t done_at;
+} GLMSParallelWorker;
+
+static GLMSParallelStats glms_parallel_stats = {0};
+
+static int64_t glms_parallel_now() {
+  struct timespec ts = {0};
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+int64_t glms_parallel_get_threads(int64_t threads) {
+  if (threads <= 0) threads = sysconf(_SC_NPROCESSORS_ONLN);
+  return threads > 0 ? threads : 1;
+}
+
+static bool glms_parallel_pop(GLMSParallelDeque *deque, int64_t *task) {
+  pthread_mutex_lock(&deque->lock);
+
+  bool found = deque->begin < deque->end;
+  if (found) *task = deque->begin++;
+
+  pthread_mutex_unlock(&deque->lock);
+
+  return found;
+}
+
+// takes the back half of another worker's tasks.
+static bool glms_parallel_steal(GLMSParallelWorker *worker, int64_t *task) {
+  GLMSParallelJob *job = worker->job;
+
+  for (int64_t i = 1; i < job->threads; i++) {
+    GLMSParallelDeque *victim =
+        &job->workers[(worker->index + i) % job->threads].deque;
+
+    pthread_mutex_lock(&victim->lock);
+
+    int64_t left = victim->end - victim->begin;
+    int64_t end = victim->end;
+    victim->end -= (left + 1) / 2;
+    int64_t begin = victim->end;
+
+    pthread_mutex_unlock(&victim->lock);
+
+    if (left <= 0) continue;
+
+    pthread_mutex_lock(&worker->deque.lock);
+    worker->deque.begin = begin + 1;
+    worker->deque.end = end;
+    pthread_mutex_unlock(&worker->deque.lock);
+
+    worker->steals++;
+    *task = begin;
+    return true;
+  }
+
+  return false;
+}
+
+// each worker starts on its own contiguous share of the tasks,
+// once that runs out it steals from the others.
+static void *glms_parallel_worker_main(void *ptr) {
+  GLMSParallelWorker *worker = (GLMSParallelWorker *)ptr;
+  GLMSParallelJob *job = worker->job;
+  int64_t task = 0;
+
+  while (!__atomic_load_n(&job->stop, __ATOMIC_ACQUIRE)) {
+    if (!glms_parallel_pop(&worker->deque, &task) &&
+        !glms_parallel_steal(worker, &task))
+      break;
+
+    if (!job->task(&worker->env.eval, &worker->stack, task, job->user_ptr)) {
+      __atomic_store_n(&job->stop, true, __ATOMIC_RELEASE);
+    }
+  }
+
+  worker->done_at = glms_parallel_now();
+
+  return 0;
+}
+
+void glms_parallel_get_stats(GLMSParallelStats *out) {
+  if (!out) return;
+
+  out->runs = __atomic_load_n(&glms_parallel_stats.runs, __ATOMIC_RELAXED);
+  out->tasks = __atomic_load_n(&glms_parallel_stats.tasks, __ATOMIC_RELAXED);
+  out->steals = __atomic_load_n(&glms_parallel_stats.steals, __ATOMIC_RELAXED);
+  out->idle_usec =
+      __atomic_load_n(&glms_parallel_stats.idle_usec, __ATOMIC_RELAXED);
+}
+
+void glms_parallel_reset_stats() {
+  __atomic_store_n(&glms_parallel_stats.runs, 0, __ATOMIC_RELAXED);
+  __atomic_store_n(&glms_parallel_stats.tasks, 0, __ATOMIC_RELAXED);
+  __atomic_store_n(&glms_parallel_stats.steals, 0, __ATOMIC_RELAXED);
+  __atomic_store_n(&glms_parallel_stats.idle_usec, 0, __ATOMIC_RELAXED);
+}
+
+static int glms_parallel_merge(GLMSEval *eval, GLMSStack *stack,
+                               int64_t tasks, GLMSParallelTask merge,
+                               void *user_ptr) {
+  int ok = 1;
+
+  for (int64_t i = 0; merge != 0 && i < tasks && ok; i++) {
+    ok = merge(eval, stack, i, user_ptr);
+  }
+
+  return ok;
+}
+
+static int glms_parallel_run_serial(GLMSEval *eval, GLMSStack *stack,
+                                    int64_t tasks, GLMSParallelTask task,
+                                    GLMSParallelTask merge, void *user_ptr) {
+  GLMSStack tmp_stack = {0};
+  glms_stack_init(&tmp_stack);
+  glms_stack_copy(*stack, &tmp_stack);
+
+  int ok = 1;
+
+  for (int64_t i = 0; i < tasks && ok; i++) {
+    ok = task(eval, &tmp_stack, i, user_ptr);
+  }
+
+  glms_stack_clear(&tmp_stack);
+
+  return ok && glms_parallel_merge(eval, stack, tasks, merge, user_ptr);
+}
+
+int glms_parallel_run(GLMSEval *eval, GLMSStack *stack, int64_t threads,
+                      int64_t tasks, GLMSParallelTask task,
+                      GLMSParallelTask merge, void *user_ptr) {
+  if (!eval || !eval->env || !stack || !task) return 0;
+  if (tasks <= 0) return 1;
+
+  threads = MIN(glms_parallel_get_threads(threads), tasks);
+
+  if (threads <= 1)
+    return glms_parallel_run_serial(eval, stack, tasks, task, merge, user_ptr);
+
+  GLMSEnv *env = eval->env;
+
+  // workers must find every module registered and every node they
+  // can reach already typed, see glms_env_freeze.
+  glms_builtin_load_modules();
+
+  HashyIterator it = {0};
+  while (hashy_map_iterate(&stack->locals, &it)) {
+    if (!it.bucket->is_set) continue;
+    if (!it.bucket->value) continue;
+
+    glms_env_apply_type(env, eval, stack, (GLMSAST *)it.bucket->value);
+  }
+
+  // workers read the nodes of every env up the chain, like those of a
+  // handle's scope and its env.
+  int64_t chain = 0;
+  for (GLMSEnv *e = env; e != 0; e = e->parent) chain++;
+
+  bool *frozen = (bool *)calloc(chain, sizeof(bool));
+  int64_t depth = 0;
+  for (GLMSEnv *e = env; e != 0; e = e->parent, depth++) {
+    frozen[depth] = e->frozen;
+    if (!e->frozen) glms_env_freeze(e);
+  }
+
+  GLMSParallelWorker *workers =
+      (GLMSParallelWorker *)calloc(threads, sizeof(GLMSParallelWorker));
+  GLMSParallelJob job = {.task = task,
+                         .user_ptr = user_ptr,
+                         .workers = workers,
+                         .threads = threads};
+
+  // a shared allocator is not safe to use from several threads.
+  GLMSConfig cfg = env->config;
+  cfg.memo_ast = 0;
+
+  for (int64_t i = 0; i < threads; i++) {
+    GLMSParallelWorker *worker = &workers[i];
+    worker->job = &job;
+    worker->index = i;
+    worker->deque.begin = tasks * i / threads;
+    worker->deque.end = tasks * (i + 1) / threads;
+    pthread_mutex_init(&worker->deque.lock, 0);
+    worker->env.parent = env;
+    worker->env.has_builtins = true;
+    glms_env_init(&worker->env, 0, env->entry_path, cfg);
+    worker->env.use_arena = true;
+    worker->env.isolated = true;
+    glms_stack_init(&worker->stack);
+    glms_stack_copy(*stack, &worker->stack);
+  }
+
+  // the calling thread is the first worker.
+  for (int64_t i = 1; i < threads; i++) {
+    pthread_create(&workers[i].thread, 0, glms_parallel_worker_main,
+                   &workers[i]);
+  }
+
+  glms_parallel_worker_main(&workers[0]);
+
+  for (int64_t i = 1; i < threads; i++) {
+    pthread_join(workers[i].thread, 0);
+  }
+
+  depth = 0;
+  for (GLMSEnv *e = env; e != 0; e = e->parent, depth++) {
+    e->frozen = frozen[depth];
+  }
+  free(frozen);
+
+  int64_t done_at = glms_parallel_now();
+  int64_t steals = 0;
+  int64_t idle_usec = 0;
+
+  for (int64_t i = 0; i < threads; i++) {
+    steals += workers[i].steals;
+    idle_usec += done_at - workers[i].done_at;
+  }
+
+  __atomic_add_fetch(&glms_parallel_stats.runs, 1, __ATOMIC_RELAXED);
+  __atomic_add_fetch(&glms_parallel_stats.tasks, tasks, __ATOMIC_RELAXED);
+  __atomic_add_fetch(&glms_parallel_stats.steals, steals, __ATOMIC_RELAXED);
+  __atomic_add_fetch(&glms_parallel_stats.idle_usec, idle_usec,
+                     __ATOMIC_RELAXED);
+
+  int ok = !job.stop &&
+           glms_parallel_merge(eval, stack, tasks, merge, user_ptr);
+
+  for (int64_t i = 0; i < threads; i++) {
+    glms_stack_clear(&workers[i].stack);
+    glms_env_clear(&workers[i].env);
+    pthread_mutex_destroy(&workers[i].deque.lock);
+  }
+
+  free(workers);
+
+  return ok;
+}
+
+GLMSAST *glms_parallel_adopt(GLMSEnv *env, GLMSEnv *from, GLMSAST value) {
+  if (!env) return 0;
+
+  GLMSAST *ptr = glms_ast_get_ptr(value);
+  if (ptr) value = *ptr;
+
+  GLMSAST *copy = glms_ast_copy(value, env);
+  if (!copy) return 0;
+
+  if (copy->env_ref == from) copy->env_ref = env;
+
+  // glms_ast_copy shares children and only copies one level of
+  // properties, both of which may still point into `from`.
+  if (copy->children != 0) {
+    GLMSASTList *children = copy->children;
+    GLMS_REFS_DEC(children->refs);
+    copy->children = 0;
+
+    for (int64_t i = 0; i < children->length; i++) {
+      glms_ast_push(copy, glms_parallel_adopt(env, from, *children->items[i]));
+    }
+  }
+
+  for (int64_t i = 0; i < copy->slots_capacity; i++) {
+    if (!value.slots[i]) continue;
+    copy->slots[i] = glms_parallel_adopt(env, from, *value.slots[i]);
+  }
+
+  return copy;
+}
@@ -44,9 +44,9 @@ int glms_parser_eat(GLMSParser *parser, GLMSTokenType token_type) {
     GLMS_WARNING_RETURN(0, stderr, "parser not initialized.\n");
 
   if (parser->token.type != token_type) {
-    GLMS_WARNING_RETURN(0, stderr, "Error at %s, Unexpected token `%s`\n",
-                        glms_env_get_position_info(parser->env),
-                        GLMS_TOKEN_TYPE_STR[parser->token.type]);
+    GLMS_ERROR_RETURN(0, stderr, "Error at %s, Unexpected token `%s`\n",
+                      glms_env_get_position_info(parser->env),
+                      GLMS_TOKEN_TYPE_STR[parser->token.type]);
   }
 
   if (!glms_lexer_next(&parser->env->lexer, &parser->token)) {
@@ -65,9 +65,9 @@ int glms_parser_eat(GLMSParser *parser, GLMSTokenType token_type) {
 }
 
 static GLMSAST *glms_parser_error(GLMSParser *parser) {
-  GLMS_WARNING(stderr, "Error at %s, Unexpected token `%s`\n",
-               glms_env_get_position_info(parser->env),
-               GLMS_TOKEN_TYPE_STR[parser->token.type]);
+  GLMS_ERROR(stderr, "Error at %s, Unexpected token `%s`\n",
+             glms_env_get_position_info(parser->env),
+             GLMS_TOKEN_TYPE_STR[parser->token.type]);
   parser->error = true;
 
   return glms_env_new_ast(parser->env, GLMS_AST_TYPE_EOF, false);
@@ -244,7 +244,7 @@ static int glms_extract_template_parts(GLMSEnv *env, const char *strval,
     if (next_part != 0) {
       GLMSEnv tmp_env = {0};
       GLMSConfig cfg = env->config;
-      cfg.memo_ast = &env->memo_ast;
+      cfg.memo_ast = glms_env_get_memo(env);
       cfg.use_heap_strings = true;
       glms_env_init(&tmp_env, next_part, env->entry_path, cfg);
       GLMSAST *parsed = glms_parser_parse_expr(&tmp_env.parser);
@@ -672,7 +672,8 @@ GLMSAST *glms_parser_parse_factor(GLMSParser *parser) {
 GLMSAST *glms_parser_parse_term(GLMSParser *parser) {
   GLMSAST *left = glms_parser_parse_factor(parser);
 
-  while (left && parser->token.type == GLMS_TOKEN_TYPE_DOT) {
+  while (left && (parser->token.type == GLMS_TOKEN_TYPE_DOT ||
+                  parser->token.type == GLMS_TOKEN_TYPE_LBRACKET)) {
     GLMSAST *access =
         glms_env_new_ast(parser->env, GLMS_AST_TYPE_ACCESS, false);
     access->as.access.left = left;
@@ -724,15 +725,6 @@ GLMSAST *glms_parser_parse_term(GLMSParser *parser) {
 GLMSAST *glms_parser_parse_expr(GLMSParser *parser) {
   GLMSAST *left = glms_parser_parse_term(parser);
 
-  while (parser->token.type == GLMS_TOKEN_TYPE_LBRACKET) {
-    GLMSAST *access =
-        glms_env_new_ast(parser->env, GLMS_AST_TYPE_ACCESS, false);
-    access->as.access.left = left;
-
-    access->as.access.right = glms_parser_parse_expr(parser);
-    left = access;
-  }
-
   while (parser->token.type == GLMS_TOKEN_TYPE_ADD ||
          parser->token.type == GLMS_TOKEN_TYPE_SUB ||
          parser->token.type == GLMS_TOKEN_TYPE_DIV_EQUALS ||
@@ -1109,7 +1101,7 @@ GLMSAST *glms_parser_lookup(GLMSParser *parser, const char *key) {
   if (!key || !parser)
     return 0;
 
-  GLMSAST *g = (GLMSAST *)hashy_map_get(&parser->env->globals, key);
+  GLMSAST *g = glms_env_lookup_global(parser->env, key);
 
   if (g)
     return g;
@@ -0,0 +1,390 @@
+#include <glms/builtin.h>
+#include <glms/macros.h>
+#include <glms/pool.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+struct GLMS_POOL_JOB_STRUCT {
+  struct GLMS_POOL_STRUCT *pool;
+  char *name;
+  GLMSAST *args;
+  int64_t args_length;
+
+  // copies of string arguments and of a string result.
+  char **strings;
+  int64_t strings_length;
+
+  GLMSPoolCallback callback;
+  void *user_ptr;
+
+  bool future;
+  bool done;
+  bool ok;
+  GLMSAST result;
+
+  struct GLMS_POOL_JOB_STRUCT *prev;
+  struct GLMS_POOL_JOB_STRUCT *next;
+};
+
+typedef GLMSPoolFuture GLMSPoolJob;
+
+// Each worker takes jobs from the front of its own queue and,
+// once that is empty, steals from the back of the others.
+typedef struct {
+  pthread_mutex_t lock;
+  GLMSPoolJob *head;
+  GLMSPoolJob *tail;
+} GLMSPoolQueue;
+
+typedef struct {
+  struct GLMS_POOL_STRUCT *pool;
+  int64_t index;
+  pthread_t thread;
+  GLMSEnv env;
+  GLMSPoolQueue queue;
+} GLMSPoolWorker;
+
+struct GLMS_POOL_STRUCT {
+  GLMSEnv *env;
+  GLMSEnvSnapshot *snapshot;
+
+  GLMSPoolWorker *workers;
+  int64_t threads;
+  int64_t next_worker;
+
+  pthread_mutex_t lock;
+  pthread_cond_t work;
+  pthread_cond_t done;
+  int64_t queued;
+  int64_t pending;
+  bool stopping;
+};
+
+static void glms_pool_job_free(GLMSPoolJob *job) {
+  if (!job) return;
+
+  for (int64_t i = 0; i < job->strings_length; i++) free(job->strings[i]);
+
+  if (job->strings) free(job->strings);
+  if (job->args) free(job->args);
+  if (job->name) free(job->name);
+  free(job);
+}
+
+// only values without env owned memory can move between threads.
+static bool glms_pool_copy_value(GLMSPoolJob *job, GLMSAST value,
+                                 GLMSAST *out) {
+  GLMSAST *ptr = glms_ast_get_ptr(value);
+  if (ptr) value = *ptr;
+
+  switch (value.type) {
+    case GLMS_AST_TYPE_NUMBER:
+    case GLMS_AST_TYPE_BOOL:
+    case GLMS_AST_TYPE_VEC2:
+    case GLMS_AST_TYPE_VEC3:
+    case GLMS_AST_TYPE_VEC4:
+    case GLMS_AST_TYPE_MAT3:
+    case GLMS_AST_TYPE_MAT4: {
+      *out = (GLMSAST){.type = value.type, .as = value.as};
+    }; break;
+    case GLMS_AST_TYPE_STRING: {
+      const char *str = glms_ast_get_string_value(&value);
+      char *copy = strdup(str ? str : "");
+
+      job->strings = (char **)realloc(
+          job->strings, (job->strings_length + 1) * sizeof(char *));
+      job->strings[job->strings_length++] = copy;
+
+      *out = (GLMSAST){.type = GLMS_AST_TYPE_STRING, .as.string.heap = copy};
+    }; break;
+    default: {
+      return false;
+    }; break;
+  }
+
+  return true;
+}
+
+static void glms_pool_queue_push(GLMSPoolQueue *queue, GLMSPoolJob *job) {
+  pthread_mutex_lock(&queue->lock);
+
+  job->prev = queue->tail;
+  job->next = 0;
+  if (queue->tail) queue->tail->next = job;
+  queue->tail = job;
+  if (!queue->head) queue->head = job;
+
+  pthread_mutex_unlock(&queue->lock);
+}
+
+static GLMSPoolJob *glms_pool_queue_pop(GLMSPoolQueue *queue, bool back) {
+  pthread_mutex_lock(&queue->lock);
+
+  GLMSPoolJob *job = back ? queue->tail : queue->head;
+
+  if (job) {
+    if (job->prev) job->prev->next = job->next;
+    if (job->next) job->next->prev = job->prev;
+    if (queue->head == job) queue->head = job->next;
+    if (queue->tail == job) queue->tail = job->prev;
+    job->prev = 0;
+    job->next = 0;
+  }
+
+  pthread_mutex_unlock(&queue->lock);
+
+  return job;
+}
+
+static GLMSPoolJob *glms_pool_take(GLMSPoolWorker *worker) {
+  GLMSPool *pool = worker->pool;
+  GLMSPoolJob *job = glms_pool_queue_pop(&worker->queue, false);
+
+  for (int64_t i = 1; !job && i < pool->threads; i++) {
+    GLMSPoolWorker *victim = &pool->workers[(worker->index + i) % pool->threads];
+    job = glms_pool_queue_pop(&victim->queue, true);
+  }
+
+  if (job) {
+    pthread_mutex_lock(&pool->lock);
+    pool->queued--;
+    pthread_mutex_unlock(&pool->lock);
+  }
+
+  return job;
+}
+
+static void glms_pool_run(GLMSPoolWorker *worker, GLMSPoolJob *job) {
+  GLMSPool *pool = worker->pool;
+  GLMSAST result = {0};
+
+  // resolved once per worker, each call releases what the last job
+  // allocated, see glms_env_call_handle.
+  GLMSFunctionHandle *handle = glms_env_get_function(&worker->env, job->name);
+
+  job->ok = handle != 0 &&
+            glms_env_call_handle(handle,
+                                 (GLMSASTBuffer){.initialized = true,
+                                                 .items = job->args,
+                                                 .length = job->args_length},
+                                 &result);
+
+  if (job->callback) job->callback(&worker->env, &result, job->user_ptr);
+
+  if (job->future && job->ok && !glms_pool_copy_value(job, result, &job->result))
+    job->result = (GLMSAST){.type = GLMS_AST_TYPE_UNDEFINED};
+
+  bool future = job->future;
+
+  pthread_mutex_lock(&pool->lock);
+  job->done = true;
+  pool->pending--;
+  pthread_cond_broadcast(&pool->done);
+  pthread_mutex_unlock(&pool->lock);
+
+  // futures are freed by whoever holds them.
+  if (!future) glms_pool_job_free(job);
+}
+
+static void *glms_pool_worker_main(void *ptr) {
+  GLMSPoolWorker *worker = (GLMSPoolWorker *)ptr;
+  GLMSPool *pool = worker->pool;
+
+  while (true) {
+    GLMSPoolJob *job = glms_pool_take(worker);
+
+    if (job) {
+      glms_pool_run(worker, job);
+      continue;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->queued <= 0 && !pool->stopping) {
+      pthread_cond_wait(&pool->work, &pool->lock);
+    }
+    bool stop = pool->stopping && pool->queued <= 0;
+    pthread_mutex_unlock(&pool->lock);
+
+    if (stop) break;
+  }
+
+  return 0;
+}
+
+GLMSPool *glms_pool_new(const char *source, const char *entry_path,
+                        int64_t threads, GLMSConfig cfg) {
+  if (!source) return 0;
+
+  if (threads <= 0) threads = sysconf(_SC_NPROCESSORS_ONLN);
+  if (threads <= 0) threads = 1;
+
+  GLMSPool *pool = NEW(GLMSPool);
+  if (!pool) GLMS_WARNING_RETURN(0, stderr, "Could not allocate pool.\n");
+
+  pool->env = NEW(GLMSEnv);
+  glms_env_init(pool->env, source, entry_path, cfg);
+  glms_env_exec(pool->env);
+  pool->snapshot = glms_env_snapshot(pool->env);
+
+  if (!pool->snapshot) {
+    glms_env_clear(pool->env);
+    free(pool->env);
+    free(pool);
+    GLMS_WARNING_RETURN(0, stderr, "Could not snapshot pool script.\n");
+  }
+
+  pthread_mutex_init(&pool->lock, 0);
+  pthread_cond_init(&pool->work, 0);
+  pthread_cond_init(&pool->done, 0);
+
+  pool->threads = threads;
+  pool->workers = (GLMSPoolWorker *)calloc(threads, sizeof(GLMSPoolWorker));
+
+  // forked up front, so workers never touch the snapshot while
+  // another one is still being set up.
+  for (int64_t i = 0; i < threads; i++) {
+    GLMSPoolWorker *worker = &pool->workers[i];
+    worker->pool = pool;
+    worker->index = i;
+    pthread_mutex_init(&worker->queue.lock, 0);
+    glms_env_fork(pool->snapshot, &worker->env, 0, entry_path);
+  }
+
+  for (int64_t i = 0; i < threads; i++) {
+    pthread_create(&pool->workers[i].thread, 0, glms_pool_worker_main,
+                   &pool->workers[i]);
+  }
+
+  return pool;
+}
+
+static GLMSPoolJob *glms_pool_push(GLMSPool *pool, const char *name,
+                                   GLMSASTBuffer args, bool future,
+                                   GLMSPoolCallback callback, void *user_ptr) {
+  if (!pool || !name) return 0;
+
+  GLMSPoolJob *job = NEW(GLMSPoolJob);
+  if (!job) GLMS_WARNING_RETURN(0, stderr, "Could not allocate job.\n");
+
+  job->pool = pool;
+  job->name = strdup(name);
+  job->future = future;
+  job->callback = callback;
+  job->user_ptr = user_ptr;
+
+  if (args.length > 0) {
+    job->args = (GLMSAST *)calloc(args.length, sizeof(GLMSAST));
+    job->args_length = args.length;
+
+    for (int64_t i = 0; i < args.length; i++) {
+      if (glms_pool_copy_value(job, args.items[i], &job->args[i])) continue;
+
+      glms_pool_job_free(job);
+      GLMS_WARNING_RETURN(0, stderr, "`%s` cannot be passed to a pool job.\n",
+                          GLMS_AST_TYPE_STR[args.items[i].type]);
+    }
+  }
+
+  int64_t index =
+      __atomic_fetch_add(&pool->next_worker, 1, __ATOMIC_RELAXED) %
+      pool->threads;
+  glms_pool_queue_push(&pool->workers[index].queue, job);
+
+  pthread_mutex_lock(&pool->lock);
+  pool->queued++;
+  pool->pending++;
+  pthread_cond_signal(&pool->work);
+  pthread_mutex_unlock(&pool->lock);
+
+  return job;
+}
+
+int glms_pool_submit(GLMSPool *pool, const char *name, GLMSASTBuffer args,
+                     GLMSPoolCallback callback, void *user_ptr) {
+  return glms_pool_push(pool, name, args, false, callback, user_ptr) != 0;
+}
+
+GLMSPoolFuture *glms_pool_submit_future(GLMSPool *pool, const char *name,
+                                        GLMSASTBuffer args) {
+  return glms_pool_push(pool, name, args, true, 0, 0);
+}
+
+int glms_pool_future_wait(GLMSPoolFuture *future, GLMSAST *out) {
+  if (!future) return 0;
+
+  GLMSPool *pool = future->pool;
+
+  pthread_mutex_lock(&pool->lock);
+  while (!future->done) {
+    pthread_cond_wait(&pool->done, &pool->lock);
+  }
+  pthread_mutex_unlock(&pool->lock);
+
+  if (out != 0) *out = future->result;
+
+  return future->ok;
+}
+
+bool glms_pool_future_is_done(GLMSPoolFuture *future) {
+  if (!future) return false;
+
+  pthread_mutex_lock(&future->pool->lock);
+  bool done = future->done;
+  pthread_mutex_unlock(&future->pool->lock);
+
+  return done;
+}
+
+void glms_pool_future_free(GLMSPoolFuture *future) {
+  if (!future) return;
+
+  glms_pool_future_wait(future, 0);
+  glms_pool_job_free(future);
+}
+
+void glms_pool_wait(GLMSPool *pool) {
+  if (!pool) return;
+
+  pthread_mutex_lock(&pool->lock);
+  while (pool->pending > 0) {
+    pthread_cond_wait(&pool->done, &pool->lock);
+  }
+  pthread_mutex_unlock(&pool->lock);
+}
+
+int64_t glms_pool_get_threads(GLMSPool *pool) {
+  return pool ? pool->threads : 0;
+}
+
+void glms_pool_free(GLMSPool *pool) {
+  if (!pool) return;
+
+  glms_pool_wait(pool);
+
+  pthread_mutex_lock(&pool->lock);
+  pool->stopping = true;
+  pthread_cond_broadcast(&pool->work);
+  pthread_mutex_unlock(&pool->lock);
+
+  for (int64_t i = 0; i < pool->threads; i++) {
+    pthread_join(pool->workers[i].thread, 0);
+  }
+
+  for (int64_t i = 0; i < pool->threads; i++) {
+    glms_env_clear(&pool->workers[i].env);
+    pthread_mutex_destroy(&pool->workers[i].queue.lock);
+  }
+
+  glms_env_snapshot_free(pool->snapshot);
+  glms_env_clear(pool->env);
+  free(pool->env);
+  free(pool->workers);
+
+  pthread_mutex_destroy(&pool->lock);
+  pthread_cond_destroy(&pool->work);
+  pthread_cond_destroy(&pool->done);
+
+  free(pool);
+}
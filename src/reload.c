@@ -0,0 +1,146 @@
+#include <ctype.h>
+#include <glms/lexer.h>
+#include <glms/macros.h>
+#include <glms/reload.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+static bool glms_reload_next_token(GLMSLexer *lexer, GLMSToken *token,
+                                   bool *more) {
+  if (!*more) return false;
+  token->type = GLMS_TOKEN_TYPE_EOF;
+  // the lexer reports the end of input together with the last token.
+  *more = glms_lexer_next(lexer, token);
+  return token->type != GLMS_TOKEN_TYPE_EOF;
+}
+
+static void glms_reload_push_chunk(const char *source, int64_t start,
+                                   int64_t end, char ***chunks,
+                                   int64_t *length) {
+  while (start < end && isspace(source[start])) start++;
+  while (end > start && isspace(source[end - 1])) end--;
+  if (end <= start) return;
+
+  char *chunk = (char *)calloc(end - start + 1, sizeof(char));
+  memcpy(chunk, &source[start], end - start);
+
+  *chunks = (char **)realloc(*chunks, (*length + 1) * sizeof(char *));
+  (*chunks)[(*length)++] = chunk;
+}
+
+int glms_reload_split(const char *source, char ***chunks, int64_t *length) {
+  if (!source || !chunks || !length) return 0;
+
+  *chunks = 0;
+  *length = 0;
+
+  GLMSLexer lexer = {0};
+  if (!glms_lexer_init(&lexer, source)) return 0;
+
+  GLMSToken token = {0};
+  int64_t depth = 0;
+  int64_t start = 0;
+  bool more = lexer.c != 0;
+
+  while (glms_reload_next_token(&lexer, &token, &more)) {
+    switch (token.type) {
+      case GLMS_TOKEN_TYPE_LBRACE:
+      case GLMS_TOKEN_TYPE_LPAREN:
+      case GLMS_TOKEN_TYPE_LBRACKET: depth++; continue;
+      case GLMS_TOKEN_TYPE_RPAREN:
+      case GLMS_TOKEN_TYPE_RBRACKET: depth--; continue;
+      case GLMS_TOKEN_TYPE_RBRACE: {
+        if (--depth != 0) continue;
+
+        // a block may still be followed by `;` or an `else`.
+        GLMSLexer peek = lexer;
+        bool peek_more = more;
+        GLMSToken next = {0};
+
+        if (glms_reload_next_token(&peek, &next, &peek_more)) {
+          if (next.type == GLMS_TOKEN_TYPE_SPECIAL_ELSE) continue;
+          if (next.type == GLMS_TOKEN_TYPE_SEMI) {
+            lexer = peek;
+            more = peek_more;
+          }
+        }
+      } break;
+      case GLMS_TOKEN_TYPE_SEMI: {
+        if (depth != 0) continue;
+      } break;
+      default: continue;
+    }
+
+    int64_t end = more ? lexer.i : lexer.length;
+    glms_reload_push_chunk(source, start, end, chunks, length);
+    start = end;
+  }
+
+  if (depth != 0) {
+    for (int64_t i = 0; i < *length; i++) free((*chunks)[i]);
+    if (*chunks) free(*chunks);
+    *chunks = 0;
+    *length = 0;
+    GLMS_WARNING_RETURN(0, stderr, "Unbalanced brackets in reloaded source.\n");
+  }
+
+  glms_reload_push_chunk(source, start, strlen(source), chunks, length);
+
+  return 1;
+}
+
+char *glms_reload_take(GLMSReload *reload, const char *chunk) {
+  if (!reload || !chunk) return 0;
+
+  for (int64_t i = 0; i < reload->chunks_length; i++) {
+    char *existing = reload->chunks[i];
+    if (existing == 0 || strcmp(existing, chunk) != 0) continue;
+
+    reload->chunks[i] = 0;
+    return existing;
+  }
+
+  return 0;
+}
+
+void glms_reload_replace(GLMSReload *reload, char **chunks, int64_t length) {
+  if (!reload) return;
+
+  for (int64_t i = 0; i < reload->chunks_length; i++) {
+    if (reload->chunks[i] == 0) continue;
+
+    reload->retired = (char **)realloc(
+        reload->retired, (reload->retired_length + 1) * sizeof(char *));
+    reload->retired[reload->retired_length++] = reload->chunks[i];
+  }
+
+  if (reload->chunks) free(reload->chunks);
+  reload->chunks = chunks;
+  reload->chunks_length = length;
+  reload->initialized = true;
+}
+
+bool glms_reload_get_mtime(const char *path, struct timespec *out) {
+  struct stat st = {0};
+  if (!path || stat(path, &st) != 0) return false;
+  *out = st.st_mtim;
+  return true;
+}
+
+void glms_reload_clear(GLMSReload *reload) {
+  if (!reload) return;
+
+  for (int64_t i = 0; i < reload->chunks_length; i++) {
+    if (reload->chunks[i]) free(reload->chunks[i]);
+  }
+
+  for (int64_t i = 0; i < reload->retired_length; i++) {
+    free(reload->retired[i]);
+  }
+
+  if (reload->chunks) free(reload->chunks);
+  if (reload->retired) free(reload->retired);
+
+  *reload = (GLMSReload){0};
+}
@@ -0,0 +1,211 @@
+#include <glms/macros.h>
+#include <glms/shape.h>
+#include <pthread.h>
+#include <string.h>
+
+static GLMSShape glms_shape_root_shape = {0};
+static pthread_mutex_t glms_shape_lock = PTHREAD_MUTEX_INITIALIZER;
+
+GLMSShape* glms_shape_root() { return &glms_shape_root_shape; }
+
+// slots of a dictionary shape are stored +1 in its table, so that
+// slot 0 is not mistaken for a missing key.
+static bool glms_shape_dictionary_push(GLMSShape* shape, const char* key) {
+  if (shape->length >= shape->keys_capacity) {
+    int64_t capacity = MAX(GLMS_SHAPE_TRANSITIONS_CAPACITY,
+                           shape->keys_capacity * 2);
+    const char** keys =
+        (const char**)realloc(shape->keys, capacity * sizeof(char*));
+    if (!keys) GLMS_WARNING_RETURN(false, stderr, "Could not grow keys.\n");
+
+    shape->keys = keys;
+    shape->keys_capacity = capacity;
+  }
+
+  char* copy = strdup(key);
+  if (!copy) GLMS_WARNING_RETURN(false, stderr, "Could not copy key.\n");
+
+  shape->keys[shape->length] = copy;
+  hashy_map_set(shape->table, copy, (void*)(intptr_t)(shape->length + 1));
+  shape->length++;
+
+  return true;
+}
+
+static GLMSShape* glms_shape_dictionary_new(GLMSShape* from) {
+  GLMSShape* shape = NEW(GLMSShape);
+  if (!shape) GLMS_WARNING_RETURN(0, stderr, "Could not allocate shape.\n");
+
+  shape->dictionary = true;
+  shape->table = NEW(HashyMap);
+
+  if (!shape->table) {
+    free(shape);
+    GLMS_WARNING_RETURN(0, stderr, "Could not allocate table.\n");
+  }
+
+  hashy_map_init(shape->table,
+                 (HashyConfig){.capacity = MAX(from->length * 2,
+                                               GLMS_SHAPE_LENGTH_MAX)});
+
+  for (int64_t i = 0; i < from->length; i++) {
+    if (!glms_shape_dictionary_push(shape, glms_shape_get_key(from, i))) {
+      glms_shape_free(shape);
+      return 0;
+    }
+  }
+
+  return shape;
+}
+
+static GLMSShape* glms_shape_add_locked(GLMSShape* shape, const char* key,
+                                        bool* full) {
+  if (!shape->transitions.initialized) {
+    hashy_map_init(&shape->transitions,
+                   (HashyConfig){.capacity = GLMS_SHAPE_TRANSITIONS_CAPACITY});
+  }
+
+  GLMSShape* next = (GLMSShape*)hashy_map_get(&shape->transitions, key);
+  if (next != 0) return next;
+
+  // keys that keep changing, like objects used as maps, would otherwise
+  // grow the tree for as long as the process runs.
+  if (shape->transitions_length >= GLMS_SHAPE_TRANSITIONS_MAX ||
+      shape->length >= GLMS_SHAPE_LENGTH_MAX) {
+    *full = true;
+    return 0;
+  }
+
+  next = NEW(GLMSShape);
+  if (!next) GLMS_WARNING_RETURN(0, stderr, "Could not allocate shape.\n");
+
+  next->parent = shape;
+  next->key = strdup(key);
+  next->slot = shape->length;
+  next->length = shape->length + 1;
+
+  hashy_map_set(&shape->transitions, key, next);
+  shape->transitions_length++;
+
+  return next;
+}
+
+GLMSShape* glms_shape_add(GLMSShape* shape, const char* key) {
+  if (!shape || !key) return 0;
+
+  if (shape->dictionary) {
+    return glms_shape_dictionary_push(shape, key) ? shape : 0;
+  }
+
+  bool full = false;
+
+  pthread_mutex_lock(&glms_shape_lock);
+  GLMSShape* next = glms_shape_add_locked(shape, key, &full);
+  pthread_mutex_unlock(&glms_shape_lock);
+
+  if (!full) return next;
+
+  next = glms_shape_dictionary_new(shape);
+  if (!next) return 0;
+
+  if (!glms_shape_dictionary_push(next, key)) {
+    glms_shape_free(next);
+    return 0;
+  }
+
+  return next;
+}
+
+GLMSShape* glms_shape_copy(GLMSShape* shape) {
+  if (!shape || !shape->dictionary) return shape;
+  return glms_shape_dictionary_new(shape);
+}
+
+void glms_shape_free(GLMSShape* shape) {
+  if (!shape || !shape->dictionary) return;
+
+  if (shape->table != 0) {
+    hashy_map_destroy(shape->table);
+    free(shape->table);
+  }
+
+  if (shape->keys != 0) {
+    for (int64_t i = 0; i < shape->length; i++) free((char*)shape->keys[i]);
+    free(shape->keys);
+  }
+
+  free(shape);
+}
+
+// lazily built lookups are published only once they are complete,
+// so readers never need the lock.
+static HashyMap* glms_shape_get_table(GLMSShape* shape) {
+  HashyMap* table = __atomic_load_n(&shape->table, __ATOMIC_ACQUIRE);
+  if (table) return table;
+
+  pthread_mutex_lock(&glms_shape_lock);
+
+  table = shape->table;
+
+  if (!table && (table = NEW(HashyMap))) {
+    hashy_map_init(table, (HashyConfig){.capacity = shape->length * 2});
+
+    for (GLMSShape* s = shape; s && s->parent; s = s->parent) {
+      hashy_map_set(table, s->key, s);
+    }
+
+    __atomic_store_n(&shape->table, table, __ATOMIC_RELEASE);
+  }
+
+  pthread_mutex_unlock(&glms_shape_lock);
+
+  return table;
+}
+
+int64_t glms_shape_lookup(GLMSShape* shape, const char* key) {
+  if (!shape || !key) return -1;
+
+  if (shape->dictionary) {
+    return (int64_t)(intptr_t)hashy_map_get(shape->table, key) - 1;
+  }
+
+  if (shape->length > GLMS_SHAPE_TABLE_THRESHOLD) {
+    HashyMap* table = glms_shape_get_table(shape);
+    if (!table) GLMS_WARNING_RETURN(-1, stderr, "Could not allocate table.\n");
+
+    GLMSShape* s = (GLMSShape*)hashy_map_get(table, key);
+    return s ? s->slot : -1;
+  }
+
+  for (GLMSShape* s = shape; s && s->parent; s = s->parent) {
+    if (strcmp(s->key, key) == 0) return s->slot;
+  }
+
+  return -1;
+}
+
+const char* glms_shape_get_key(GLMSShape* shape, int64_t slot) {
+  if (!shape || slot < 0 || slot >= shape->length) return 0;
+  if (shape->dictionary) return shape->keys[slot];
+
+  const char** keys = __atomic_load_n(&shape->keys, __ATOMIC_ACQUIRE);
+  if (keys) return keys[slot];
+
+  pthread_mutex_lock(&glms_shape_lock);
+
+  keys = shape->keys;
+
+  if (!keys && (keys = (const char**)calloc(shape->length, sizeof(char*)))) {
+    for (GLMSShape* s = shape; s && s->parent; s = s->parent) {
+      keys[s->slot] = s->key;
+    }
+
+    __atomic_store_n(&shape->keys, keys, __ATOMIC_RELEASE);
+  }
+
+  pthread_mutex_unlock(&glms_shape_lock);
+
+  if (!keys) GLMS_WARNING_RETURN(0, stderr, "Could not allocate keys.\n");
+
+  return keys[slot];
+}
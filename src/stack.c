@@ -1,6 +1,8 @@
 #include <glms/env.h>
 #include <glms/macros.h>
 #include <glms/stack.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "arena/arena.h"
 #include "glms/ast.h"
@@ -18,11 +20,28 @@ int glms_stack_init(GLMSStack* stack) {
   return 1;
 }
 
+static void glms_stack_record(GLMSStack* stack, const char* name) {
+  if (stack->journal_length >= stack->journal_capacity) {
+    int64_t capacity = MAX(stack->journal_capacity * 2, 16);
+    GLMSStackEntry* journal = (GLMSStackEntry*)realloc(
+        stack->journal, capacity * sizeof(GLMSStackEntry));
+    if (!journal) GLMS_WARNING_RETURN(, stderr, "Could not grow journal.\n");
+    stack->journal = journal;
+    stack->journal_capacity = capacity;
+  }
+
+  stack->journal[stack->journal_length++] = (GLMSStackEntry){
+      .name = strdup(name),
+      .previous = (GLMSAST*)hashy_map_get(&stack->locals, name)};
+}
+
 GLMSAST* glms_stack_push(GLMSStack* stack, const char* name, GLMSAST* ast) {
   if (!stack || !name || !ast) return 0;
   if (!stack->initialized)
     GLMS_WARNING_RETURN(0, stderr, "stack not initialized.\n");
 
+  if (stack->marked) glms_stack_record(stack, name);
+
   hashy_map_set(&stack->locals, name, ast);
 
   return ast;
@@ -43,6 +62,8 @@ GLMSAST* glms_stack_pop(GLMSStack* stack, const char* name) {
 
   if (!ast) return 0;
 
+  if (stack->marked) glms_stack_record(stack, name);
+
   hashy_map_unset(&stack->locals, name);
 
   return ast;
@@ -75,11 +96,58 @@ int glms_stack_copy(GLMSStack src, GLMSStack* dest) {
   return 1;
 }
 
+int glms_stack_mark(GLMSStack* stack) {
+  if (!stack) return 0;
+  if (!stack->initialized)
+    GLMS_WARNING_RETURN(0, stderr, "stack not initialized.\n");
+
+  glms_stack_reset(stack);
+  stack->marked = true;
+
+  return 1;
+}
+
+int glms_stack_reset(GLMSStack* stack) {
+  if (!stack) return 0;
+  if (!stack->initialized)
+    GLMS_WARNING_RETURN(0, stderr, "stack not initialized.\n");
+
+  // undone last to first, so a name pushed twice gets its first value back.
+  for (int64_t i = stack->journal_length - 1; i >= 0; i--) {
+    GLMSStackEntry entry = stack->journal[i];
+
+    if (entry.previous) {
+      hashy_map_set(&stack->locals, entry.name, entry.previous);
+    } else {
+      hashy_map_unset(&stack->locals, entry.name);
+    }
+
+    free(entry.name);
+  }
+
+  stack->journal_length = 0;
+  stack->return_flag = false;
+
+  return 1;
+}
+
 int glms_stack_clear(GLMSStack* stack) {
   if (!stack) return 0;
   if (!stack->initialized)
     GLMS_WARNING_RETURN(0, stderr, "stack not initialized.\n");
 
+  if (stack->marked) {
+    for (int64_t i = 0; i < stack->journal_length; i++) {
+      free(stack->journal[i].name);
+    }
+
+    if (stack->journal) free(stack->journal);
+    stack->journal = 0;
+    stack->journal_length = 0;
+    stack->journal_capacity = 0;
+    stack->marked = false;
+  }
+
   hashy_map_clear(&stack->locals);
   return 1;
 }
@@ -4,6 +4,7 @@
 
 const char* glms_string_view_get_value(GLMSStringView* view) {
   if (!view) return 0;
+  if (view->frozen) return view->tmp_buffer;
   if (view->length <= 0 || view->ptr == 0) return 0;
   if (view->length >= GLMS_STRING_VIEW_CAPACITY)
     GLMS_WARNING_RETURN(0, stderr, "string too large.\n");
@@ -12,3 +13,9 @@ const char* glms_string_view_get_value(GLMSStringView* view) {
          sizeof(char) * MIN(view->length, (GLMS_STRING_VIEW_CAPACITY - 1)));
   return view->tmp_buffer;
 }
+
+void glms_string_view_freeze(GLMSStringView* view) {
+  if (!view) return;
+  view->frozen = false;
+  view->frozen = glms_string_view_get_value(view) != 0;
+}
@@ -0,0 +1,37 @@
+function grow(array items) {
+  items.push(4);
+  return items.length();
+}
+
+array arr = [1, 2, 3];
+number inner = grow(arr);
+arr.push(5);
+number outer = arr.length();
+
+function set_first(array items) {
+  items[0] = 9;
+  items[1] += 5;
+  return items[0] + items[1];
+}
+
+array nums = [1, 2, 3];
+number written = set_first(nums);
+nums[2] = 4;
+
+function move(array items) {
+  items[0].x = 5;
+  return items[0].x;
+}
+
+object pos = { x: 1 };
+array positions = [];
+positions.push(pos);
+number moved = move(positions);
+number unmoved = positions[0].x;
+
+function clear_list(array items) {
+  items = [];
+  return items.length();
+}
+
+number cleared = clear_list(nums);
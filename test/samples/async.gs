@@ -0,0 +1,22 @@
+future helpers = file.readAsync("import_helpers.gs");
+future adder = file.readAsync("prefetch_b.gs");
+number called = 0;
+
+helpers.then((string text) => {
+  called += 1;
+});
+
+array both = await(all([helpers, adder]));
+string first = both[0];
+string second = both[1];
+
+// `out_path` is registered by the host.
+bool written = await(file.writeAsync(out_path, "written later"));
+string back = await(file.readAsync(out_path));
+
+future missing = file.readAsync("no_such_file.gs");
+number polled = 0;
+
+missing.then((string text) => {
+  polled += 1;
+});
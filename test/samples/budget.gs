@@ -0,0 +1,13 @@
+number total = 0;
+
+for (number i = 0; i < 200; i++) {
+  total += 1;
+}
+
+function count(number n) {
+  number c = 0;
+  for (number i = 0; i < n; i++) {
+    c += 1;
+  }
+  return c;
+}
@@ -0,0 +1,32 @@
+// `shared` is registered by the host.
+channel c = channel(4);
+
+c.send(3);
+c.send("hello");
+c.send([1, 2, 3]);
+object person = { name: "John", age: 33 };
+c.send(person);
+
+number n = c.recv();
+string s = c.recv();
+array a = c.recv();
+object o = c.recv();
+number count = a.length();
+string name = o.name;
+
+c.send(vec3(1, 2, 3));
+vec3 v = c.recv();
+vec3 doubled = v * 2;
+
+// typed arrays still point to the host's memory.
+c.send(shared);
+c.send(7);
+c.close();
+
+bool sent = c.send(8);
+array view = c.recv();
+view[0] = 5;
+
+// values sent before close are still received.
+number last = c.recv(0);
+number after = c.recv(-1);
@@ -0,0 +1,10 @@
+// `results` is registered by the host, and closed once every stage is done.
+number total = 0;
+number count = 0;
+array pair = results.recv([]);
+
+while (pair.length() > 0) {
+  total += pair[1];
+  count += 1;
+  pair = results.recv([]);
+}
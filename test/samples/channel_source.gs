@@ -0,0 +1,6 @@
+// `jobs` is registered by the host.
+for (number i = 1; i <= 200; i++) {
+  jobs.send(i);
+}
+
+jobs.close();
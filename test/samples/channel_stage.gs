@@ -0,0 +1,9 @@
+// `jobs` and `results` are registered by the host.
+number handled = 0;
+number job = jobs.recv(0);
+
+while (job > 0) {
+  results.send([job, job * 2]);
+  handled += 1;
+  job = jobs.recv(0);
+}
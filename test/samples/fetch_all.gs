@@ -0,0 +1,26 @@
+// `base_url` is registered by the host.
+response first = fetch(base_url + "/one");
+response second = fetch(base_url + "/two");
+number first_status = first.status();
+string first_text = first.text();
+string second_text = second.text();
+
+future later = fetchAsync(base_url + "/one");
+number called = 0;
+
+later.then((response r) => {
+  called += 1;
+});
+
+array all_responses = await(fetchAll([
+  base_url + "/one",
+  base_url + "/two",
+  base_url + "/three",
+  base_url + "/missing"
+]));
+
+response third = all_responses[2];
+response missing = all_responses[3];
+string third_text = third.text();
+number missing_status = missing.status();
+number count = all_responses.length();
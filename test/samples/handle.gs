@@ -0,0 +1,48 @@
+number total = 0;
+
+function add(number a, number b) {
+  return a + b;
+}
+
+function accumulate(number x) {
+  total += x;
+  return total;
+}
+
+function label(number x) {
+  return "entity";
+}
+
+function count(array items) {
+  number seen = items.length();
+  items.push(seen);
+  return items.length();
+}
+
+function sum(number n) {
+  number s = 0;
+  for (number i = 0; i < n; i++) {
+    s += i * 2;
+  }
+  return s;
+}
+
+array history = [];
+
+function record(number x) {
+  array pair = [];
+  pair.push(x);
+  pair.push(x + 1);
+  history.push(pair);
+  return history.length();
+}
+
+object settings = { scale: 3 };
+
+function scaled(number x) {
+  return x * settings.scale;
+}
+
+function same(number x) {
+  return x;
+}
@@ -0,0 +1,3 @@
+import "import_helpers.gs" as helpers;
+
+number value = helpers.add(5, 3);
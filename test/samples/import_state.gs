@@ -0,0 +1,6 @@
+import "module_state.gs" as state;
+
+number touched = 0;
+for (number i = 0; i < 20; i++) {
+  touched += state.touch(i);
+}
@@ -0,0 +1,10 @@
+player.health -= 10;
+player.position += vec3(1, 2, 3);
+player.alive = false;
+
+number health = player.health;
+vec3 position = player.position;
+
+for (number i = 0; i < 100; i++) {
+  player.score += 1;
+}
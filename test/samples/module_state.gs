@@ -0,0 +1,8 @@
+array seen = [];
+number calls = 0;
+
+number touch(number v) {
+  seen.push(v);
+  calls += 1;
+  return seen.length();
+}
@@ -0,0 +1,8 @@
+number a = madd(2, 3, 4);
+vec3 v = scale3(vec3(1, 2, 3), 2);
+number c = cos(0.0);
+mat4 m = transpose(identity());
+number e = madd(1, 2);
+number d2 = dot(vec2(1, 2), vec2(3, 4));
+number d4 = dot(vec4(1, 2, 3, 4), vec4(1, 1, 1, 1));
+vec4 n4 = normalize(vec4(0, 0, 0, 2));
@@ -0,0 +1,78 @@
+number offset = 1;
+
+array numbers = [];
+for (number i = 0; i < 300; i++) {
+  numbers.push((i * 37) % 101);
+}
+
+array mapped = numbers.parallelMap((number v) => v * 2 + offset, 16, 4);
+array mapped_serial = numbers.map((number v) => v * 2 + offset);
+
+function weigh(number v) {
+  array parts = [v, 1];
+  parts.push(offset);
+  return parts[0] + parts[2] + length(vec3(v, 0, 0));
+}
+
+array weighed = numbers.parallelMap(weigh, 16, 4);
+array weighed_serial = numbers.map(weigh);
+
+array evens = numbers.parallelFilter((number v) => (v % 2) == 0, 16, 4);
+array evens_serial = numbers.filter((number v) => (v % 2) == 0);
+
+number total = numbers.parallelReduce((number a, number b) => a + b, 0, 16, 4);
+number total_serial = 0;
+for (number i = 0; i < numbers.length(); i++) {
+  total_serial += numbers[i];
+}
+
+array sorted = numbers.parallelSort((number a, number b) => a > b, 16, 4);
+
+number mismatches = abs(sorted.length() - numbers.length());
+for (number i = 0; i < numbers.length(); i++) {
+  mismatches += abs(mapped[i] - mapped_serial[i]);
+  mismatches += abs(weighed[i] - weighed_serial[i]);
+}
+for (number i = 0; i < evens.length(); i++) {
+  mismatches += abs(evens[i] - evens_serial[i]);
+}
+
+number unsorted = 0;
+for (number i = 1; i < sorted.length(); i++) {
+  if (sorted[i - 1] > sorted[i]) {
+    unsorted += 1;
+  }
+}
+
+array words = ["c", "a", "b"];
+array labels = words.parallelMap((string w) => `label ${w}`, 1, 2);
+string first_label = labels[0];
+
+array grid = [];
+array points = [];
+array indices = [];
+for (number i = 0; i < 64; i++) {
+  array row = [];
+  row.push(i);
+  row.push(i * 2);
+  grid.push(row);
+  object p = { x: 0 };
+  p.x = i;
+  points.push(p);
+  indices.push(i);
+}
+
+// `rows` and `items` share their elements with `grid` and `points`,
+// the workers must read them without unsharing them.
+number grid_after = 0;
+function sumRows(array rows, array items) {
+  array sums = indices.parallelMap((number i) => rows[i][0] + rows[i][1] + items[i].x, 4, 4);
+  grid_after = rows[5][1] + items[5].x;
+  return sums;
+}
+
+array grid_sums = sumRows(grid, points);
+number grid_total = 0;
+for (number i = 0; i < grid_sums.length(); i++) {
+  grid_total += grid_sums[i];
+}
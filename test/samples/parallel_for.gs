@@ -0,0 +1,17 @@
+number offset = 1;
+number counter = 0;
+
+bool ok = parallelFor(0, out.length(), (number i) => {
+  number doubled = i * 2;
+  doubled += offset;
+  out[i] = doubled;
+}, 16, 4);
+
+// globals are read-only inside parallel tasks.
+parallelFor(0, 8, (number i) => {
+  counter += 1;
+}, 1, 2);
+
+object stats = parallelStats();
+number runs = stats.runs;
+number tasks = stats.tasks;
@@ -0,0 +1,11 @@
+function sum(number n) {
+  number total = 0;
+  for (number i = 0; i <= n; i++) {
+    total += i;
+  }
+  return total;
+}
+
+function greet(string name) {
+  return `hi ${name}`;
+}
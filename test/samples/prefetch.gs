@@ -0,0 +1,4 @@
+import "prefetch_a.gs" as scaler;
+import "prefetch_b.gs" as adder;
+
+number value = scaler.scale(adder.add(2, 3));
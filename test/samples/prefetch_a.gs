@@ -0,0 +1,5 @@
+import "prefetch_c.gs" as doubler;
+
+number scale(number v) {
+  return doubler.twice(v);
+}
@@ -0,0 +1,3 @@
+number add(number a, number b) {
+  return a + b;
+}
@@ -0,0 +1,3 @@
+number twice(number v) {
+  return v * 2;
+}
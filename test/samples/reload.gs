@@ -0,0 +1,12 @@
+number hits = 0;
+
+function score(number x) {
+  hits += 1;
+  return x * 2;
+}
+
+if (hits > 0) {
+  hits = 100;
+} else {
+  hits = 0;
+}
@@ -0,0 +1,14 @@
+number hits = 0;
+
+function score(number x) {
+  hits += 1;
+  return x * 3;
+}
+
+if (hits > 0) {
+  hits = 100;
+} else {
+  hits = 0;
+}
+
+number bonus = hits + 10;
@@ -0,0 +1,2 @@
+number before = 1;
+number broken = missing + 1;
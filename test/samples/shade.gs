@@ -0,0 +1,34 @@
+number w = 70;
+number h = 40;
+number scale = 0.5;
+
+function shader(vec3 uv, vec3 fragCoord, vec3 resolution) {
+  return vec4(uv.x * scale, uv.y, fragCoord.x / resolution.x, 1.0);
+}
+
+image serial = image.make(w, h);
+bool serial_ok = serial.shade(shader);
+
+function render(number threads) {
+  number green = 0.25;
+  image img = image.make(w, h);
+  img.shade((vec3 uv, vec3 fragCoord, vec3 resolution) => {
+    return vec4(uv.x * scale, uv.y, fragCoord.x / resolution.x, green * 4.0);
+  }, threads);
+  return img;
+}
+
+image threaded = render(4);
+
+number mismatches = 0;
+for (number y = 0; y < h; y++) {
+  for (number x = 0; x < w; x++) {
+    vec4 a = serial.getPixel(x, y);
+    vec4 b = threaded.getPixel(x, y);
+    mismatches += abs(a.x - b.x) + abs(a.y - b.y) + abs(a.z - b.z);
+  }
+}
+
+function reshade() {
+  return serial.shade(shader);
+}
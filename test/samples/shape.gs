@@ -0,0 +1,13 @@
+typedef struct {
+  number age;
+  string name;
+} Person;
+
+Person a = Person(33, "John Doe");
+Person b = Person(22, "Sarah Doe");
+
+number age = 0;
+
+for (number i = 0; i < 2; i++) {
+  age += b.age;
+}
@@ -0,0 +1,18 @@
+number scale = 3;
+
+function label(string name) {
+  string s = `item ${name}`;
+  return s;
+}
+
+function work(number n) {
+  number total = 0;
+  array items = [1, 2, 3];
+  for (number i = 0; i < n; i++) {
+    total += items[1] * scale;
+    label("x");
+  }
+  return total + random(0, 1) * 0;
+}
+
+number result = work(10);
@@ -0,0 +1,11 @@
+number counter = 1;
+array names = ["a", "b"];
+
+function add(number a, number b) {
+  return a + b;
+}
+
+function bump() {
+  counter = counter + 1;
+  return counter;
+}
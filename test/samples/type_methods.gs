@@ -0,0 +1,12 @@
+array a = [3, 1, 2];
+array b = [5, 4];
+
+b.push(6);
+
+number la = a.length();
+number lb = b.length();
+
+string s = "hello world";
+bool found = s.includes("world");
+
+vec3 v = mix(vec3(0.0), vec3(2.0), 0.5);
@@ -0,0 +1,21 @@
+for (number i = 0; i < positions.length(); i++) {
+  positions[i] += vec3(0, 1, 0);
+}
+
+weights[0] = 5;
+weights[1] *= 2;
+
+number total = 0;
+
+function accumulate(number w, number i) {
+  total += w;
+}
+
+weights.forEach(accumulate);
+
+array doubled = weights.map((number w) => w * 2);
+number last = doubled[2];
+
+number before = constants[0];
+constants[0] = 100;
+number after = constants[0];
@@ -0,0 +1,4 @@
+// failing to read a file is a warning, the script keeps running.
+future missing = file.readAsync("no_such_file.gs");
+await(missing);
+number after = 1;
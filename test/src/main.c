@@ -1,10 +1,19 @@
 #include "glms/ast.h"
 #include "glms/ast_type.h"
 #include <assert.h>
+#include <glms/builtin.h>
 #include <glms/glms.h>
 #include <glms/io.h>
 #include <glms/macros.h>
+#include <glms/modules/channel.h>
+#include <glms/modules/future.h>
+#include <glms/shape.h>
 #include <math.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <unistd.h>
 
 #define GLMS_ASSERT(expr)                                                      \
   {                                                                            \
@@ -78,6 +87,1712 @@ static void test_sample_array() {
   GLMS_TEST_END();
 }
 
+static void test_sample_array_copy() {
+  GLMS_TEST_BEGIN();
+  GLMSEnv env = {0};
+  GLMSAST *ast = glms_exec_file(&env, "test/samples/array_copy.gs");
+
+  GLMS_ASSERT(ast != 0);
+  GLMSAST *inner = glms_eval_lookup(&env.eval, &env.stack, "inner");
+  GLMS_ASSERT(inner != 0);
+  GLMS_ASSERT(GLMSAST_VALUE(inner) == 4);
+
+  GLMSAST *outer = glms_eval_lookup(&env.eval, &env.stack, "outer");
+  GLMS_ASSERT(outer != 0);
+  GLMS_ASSERT(GLMSAST_VALUE(outer) == 4);
+
+  GLMSAST *arr = glms_eval_lookup(&env.eval, &env.stack, "arr");
+  GLMS_ASSERT(arr != 0);
+  GLMS_ASSERT(glms_ast_is_shared(arr) == false);
+
+  GLMSAST *last = glms_ast_access_by_index(arr, 3, &env);
+  GLMS_ASSERT(last != 0);
+  GLMS_ASSERT(GLMSAST_VALUE(last) == 5);
+
+  // writes through an index only reach the copy they were made on.
+  GLMSAST *written = glms_eval_lookup(&env.eval, &env.stack, "written");
+  GLMS_ASSERT(written != 0);
+  GLMS_ASSERT(GLMSAST_VALUE(written) == 16);
+
+  GLMSAST *nums = glms_eval_lookup(&env.eval, &env.stack, "nums");
+  GLMS_ASSERT(nums != 0);
+  GLMSAST *num = glms_ast_access_by_index(nums, 0, &env);
+  GLMS_ASSERT(num != 0 && GLMSAST_VALUE(num) == 1);
+  num = glms_ast_access_by_index(nums, 1, &env);
+  GLMS_ASSERT(num != 0 && GLMSAST_VALUE(num) == 2);
+  num = glms_ast_access_by_index(nums, 2, &env);
+  GLMS_ASSERT(num != 0 && GLMSAST_VALUE(num) == 4);
+
+  GLMSAST *moved = glms_eval_lookup(&env.eval, &env.stack, "moved");
+  GLMS_ASSERT(moved != 0);
+  GLMS_ASSERT(GLMSAST_VALUE(moved) == 5);
+
+  GLMSAST *unmoved = glms_eval_lookup(&env.eval, &env.stack, "unmoved");
+  GLMS_ASSERT(unmoved != 0);
+  GLMS_ASSERT(GLMSAST_VALUE(unmoved) == 1);
+
+  // the copy overwritten with `[]` let go of the list.
+  GLMSAST *cleared = glms_eval_lookup(&env.eval, &env.stack, "cleared");
+  GLMS_ASSERT(cleared != 0);
+  GLMS_ASSERT(GLMSAST_VALUE(cleared) == 0);
+  GLMS_ASSERT(nums->children != 0 && nums->children->length == 3);
+  GLMS_ASSERT(glms_ast_is_shared(nums) == false);
+  GLMS_TEST_END();
+}
+
+static void test_sample_shape() {
+  GLMS_TEST_BEGIN();
+  GLMSEnv env = {0};
+  GLMSAST *ast = glms_exec_file(&env, "test/samples/shape.gs");
+
+  GLMS_ASSERT(ast != 0);
+  GLMSAST *a = glms_eval_lookup(&env.eval, &env.stack, "a");
+  GLMS_ASSERT(a != 0);
+  GLMSAST *b = glms_eval_lookup(&env.eval, &env.stack, "b");
+  GLMS_ASSERT(b != 0);
+  GLMS_ASSERT(a->shape != 0);
+  GLMS_ASSERT(a->shape == b->shape);
+
+  GLMSAST *name = glms_ast_access_by_key(a, "name", &env);
+  GLMS_ASSERT(name != 0);
+  GLMS_ASSERT(name->type == GLMS_AST_TYPE_STRING);
+  GLMS_ASSERT(strcmp(glms_ast_get_string_value(name), "John Doe") == 0);
+
+  GLMSAST *age = glms_eval_lookup(&env.eval, &env.stack, "age");
+  GLMS_ASSERT(age != 0);
+  GLMS_ASSERT(GLMSAST_VALUE(age) == 44);
+  GLMS_TEST_END();
+}
+
+static void test_shape_dictionary() {
+  GLMS_TEST_BEGIN();
+  GLMSEnv env = {0};
+  GLMSAST *ast = glms_exec_file(&env, "test/samples/shape.gs");
+  GLMS_ASSERT(ast != 0);
+
+  int64_t length = GLMS_SHAPE_LENGTH_MAX + 8;
+  char key[32];
+
+  GLMSAST *obj = glms_env_new_ast(&env, GLMS_AST_TYPE_OBJECT, false);
+  bool added = true;
+  for (int64_t i = 0; i < length; i++) {
+    snprintf(key, sizeof(key), "field_%ld", i);
+    GLMSAST *v = glms_env_new_ast_number(&env, i, false);
+    added = added && glms_ast_object_set_property(obj, key, v) != 0;
+  }
+  GLMS_ASSERT(added);
+
+  GLMS_ASSERT(obj->shape->dictionary);
+  GLMS_ASSERT(obj->shape->length == length);
+  GLMS_ASSERT(glms_ast_count_props(obj) == length);
+
+  GLMSAST *last = glms_ast_get_property(obj, "field_135");
+  GLMS_ASSERT(last != 0);
+  GLMS_ASSERT(GLMSAST_VALUE(last) == 135);
+  GLMS_ASSERT(glms_ast_get_property(obj, "field_136") == 0);
+
+  GLMSASTPropIterator it = {0};
+  int64_t index = 0;
+  bool ordered = true;
+  while (glms_ast_iterate_props(obj, &it)) {
+    snprintf(key, sizeof(key), "field_%ld", index++);
+    ordered = ordered && strcmp(it.key, key) == 0;
+  }
+  GLMS_ASSERT(ordered);
+  GLMS_ASSERT(index == length);
+
+  // a copy owns its own dictionary, keys added to it stay there.
+  GLMSAST *copy = glms_ast_copy(*obj, &env);
+  GLMS_ASSERT(copy->shape != obj->shape);
+  GLMS_ASSERT(glms_ast_object_set_property(
+                  copy, "extra", glms_env_new_ast_number(&env, 1, false)) != 0);
+  GLMS_ASSERT(glms_ast_get_property(copy, "extra") != 0);
+  GLMS_ASSERT(glms_ast_get_property(obj, "extra") == 0);
+
+  // objects used as maps stop adding transitions at the cap.
+  GLMSShape *base = glms_shape_add(glms_shape_root(), "test_shape_fanout");
+  bool found = true;
+  for (int64_t i = 0; i < GLMS_SHAPE_TRANSITIONS_MAX + 8; i++) {
+    snprintf(key, sizeof(key), "key_%ld", i);
+    GLMSShape *next = glms_shape_add(base, key);
+    found = found && next != 0 && glms_shape_lookup(next, key) == 1;
+    glms_shape_free(next);
+  }
+  GLMS_ASSERT(found);
+  GLMS_ASSERT(base->transitions_length == GLMS_SHAPE_TRANSITIONS_MAX);
+  GLMS_TEST_END();
+}
+
+static void test_sample_type_methods() {
+  GLMS_TEST_BEGIN();
+  GLMSEnv env = {0};
+  GLMSAST *ast = glms_exec_file(&env, "test/samples/type_methods.gs");
+
+  GLMS_ASSERT(ast != 0);
+  GLMSAST *a = glms_eval_lookup(&env.eval, &env.stack, "a");
+  GLMS_ASSERT(a != 0);
+  GLMS_ASSERT(glms_ast_has_props(a) == false);
+  GLMS_ASSERT(glms_ast_access_by_key(a, "push", &env) != 0);
+
+  GLMSAST *la = glms_eval_lookup(&env.eval, &env.stack, "la");
+  GLMS_ASSERT(la != 0);
+  GLMS_ASSERT(GLMSAST_VALUE(la) == 3);
+  GLMSAST *lb = glms_eval_lookup(&env.eval, &env.stack, "lb");
+  GLMS_ASSERT(lb != 0);
+  GLMS_ASSERT(GLMSAST_VALUE(lb) == 3);
+
+  GLMSAST *found = glms_eval_lookup(&env.eval, &env.stack, "found");
+  GLMS_ASSERT(found != 0);
+  GLMS_ASSERT(found->as.boolean == true);
+
+  GLMSAST *v = glms_eval_lookup(&env.eval, &env.stack, "v");
+  GLMS_ASSERT(v != 0);
+  GLMS_ASSERT(glms_ast_has_props(v) == false);
+  GLMS_ASSERT(fabs(v->as.v3.x - 1.0f) < 0.0001f);
+  GLMS_TEST_END();
+}
+
+static void test_sample_import() {
+  GLMS_TEST_BEGIN();
+  GLMSEnv env = {0};
+  GLMSAST *ast = glms_exec_file(&env, "test/samples/import.gs");
+
+  GLMS_ASSERT(ast != 0);
+  GLMSAST *helpers = glms_eval_lookup(&env.eval, &env.stack, "helpers");
+  GLMS_ASSERT(helpers != 0);
+  GLMS_ASSERT(helpers->type == GLMS_AST_TYPE_STACK);
+
+  GLMSAST *value = glms_eval_lookup(&env.eval, &env.stack, "value");
+  GLMS_ASSERT(value != 0);
+  GLMS_ASSERT(GLMSAST_VALUE(value) == 8);
+
+  GLMSEnv other = {0};
+  GLMS_ASSERT(glms_exec_file(&other, "test/samples/import.gs") != 0);
+  GLMSAST *other_helpers = glms_eval_lookup(&other.eval, &other.stack, "helpers");
+  GLMS_ASSERT(other_helpers != 0);
+  // the parsed module is shared, each env runs its own instance of it.
+  GLMS_ASSERT(other_helpers->as.stack.env != helpers->as.stack.env);
+  GLMS_ASSERT(other_helpers->as.stack.env->parent ==
+              helpers->as.stack.env->parent);
+
+  GLMSAST *other_value = glms_eval_lookup(&other.eval, &other.stack, "value");
+  GLMS_ASSERT(other_value != 0);
+  GLMS_ASSERT(GLMSAST_VALUE(other_value) == 8);
+  glms_env_clear(&other);
+
+  GLMS_TEST_END();
+  GLMS_ASSERT(glms_module_registry_clear() == 1);
+}
+
+static int64_t glms_count_prefetched(GLMSEnv *env) {
+  int64_t count = 0;
+  HashyIterator it = {0};
+
+  while (hashy_map_iterate(&env->eval.modules, &it)) {
+    if (!it.bucket->is_set) continue;
+    if (!it.bucket->value) continue;
+
+    count += ((GLMSModuleInstance *)it.bucket->value)->module->prefetched;
+  }
+
+  return count;
+}
+
+static void test_sample_module_state() {
+  GLMS_TEST_BEGIN();
+  GLMSEnv env = {0};
+  GLMSAST *ast = glms_exec_file(&env, "test/samples/import_state.gs");
+  GLMS_ASSERT(ast != 0);
+  GLMS_ASSERT(env.errors == 0);
+
+  GLMSAST *touched = glms_eval_lookup(&env.eval, &env.stack, "touched");
+  GLMS_ASSERT(touched != 0 && GLMSAST_VALUE(touched) == 210);
+
+  GLMSAST *state = glms_eval_lookup(&env.eval, &env.stack, "state");
+  GLMS_ASSERT(state != 0 && state->type == GLMS_AST_TYPE_STACK);
+  GLMSAST *calls = glms_env_lookup(state->as.stack.env, "calls");
+  GLMS_ASSERT(calls != 0 && GLMSAST_VALUE(calls) == 20);
+
+  // another importer starts from the module as it was loaded.
+  GLMSEnv other = {0};
+  GLMSAST *other_ast = glms_exec_file(&other, "test/samples/import_state.gs");
+  GLMS_ASSERT(other_ast != 0);
+  GLMSAST *other_touched =
+      glms_eval_lookup(&other.eval, &other.stack, "touched");
+  GLMS_ASSERT(other_touched != 0 && GLMSAST_VALUE(other_touched) == 210);
+  GLMS_ASSERT(GLMSAST_VALUE(calls) == 20);
+  glms_env_clear(&other);
+
+  GLMS_TEST_END();
+}
+
+static void *test_module_acquire_worker(void *ptr) {
+  return glms_module_acquire("test/samples/module_state.gs", (GLMSConfig){});
+}
+
+static void test_module_acquire_threads() {
+  GLMS_TEST_BEGIN();
+  GLMS_ASSERT(glms_module_registry_clear() == 1);
+
+  // every thread but the one loading the module waits for it.
+  pthread_t threads[4];
+  GLMSModule *modules[4] = {0};
+  for (int i = 0; i < 4; i++) {
+    pthread_create(&threads[i], 0, test_module_acquire_worker, 0);
+  }
+  for (int i = 0; i < 4; i++) {
+    pthread_join(threads[i], (void **)&modules[i]);
+  }
+
+  bool same = true;
+  for (int i = 0; i < 4; i++) {
+    same = same && modules[i] != 0 && modules[i] == modules[0];
+  }
+  GLMS_ASSERT(same);
+  GLMS_ASSERT(modules[0]->refs == 4);
+  GLMS_ASSERT(modules[0]->env->frozen);
+
+  for (int i = 0; i < 4; i++) glms_module_release(modules[i]);
+}
+
+static void test_sample_prefetch() {
+  GLMS_TEST_BEGIN();
+  GLMSEnv env = {0};
+  char *source = glms_get_file_contents("test/samples/prefetch.gs");
+  GLMS_ASSERT(source != 0);
+  glms_env_init(&env, source, "test/samples/prefetch.gs",
+                (GLMSConfig){.import_threads = 4});
+
+  GLMSAST *ast = glms_env_exec(&env);
+  GLMS_ASSERT(ast != 0);
+
+  GLMSAST *value = glms_eval_lookup(&env.eval, &env.stack, "value");
+  GLMS_ASSERT(value != 0);
+  GLMS_ASSERT(GLMSAST_VALUE(value) == 10);
+
+  int64_t prefetched = glms_count_prefetched(&env);
+  GLMS_ASSERT(prefetched == 2);
+
+  GLMSAST *scaler = glms_eval_lookup(&env.eval, &env.stack, "scaler");
+  GLMS_ASSERT(scaler != 0 && scaler->type == GLMS_AST_TYPE_STACK);
+
+  int64_t nested = glms_count_prefetched(scaler->as.stack.env);
+  GLMS_ASSERT(nested == 1);
+
+  GLMS_TEST_END();
+  GLMS_ASSERT(glms_module_registry_clear() == 1);
+
+  // nothing is read ahead unless a thread count is given.
+  GLMSEnv plain = {0};
+  glms_env_init(&plain, source, "test/samples/prefetch.gs", (GLMSConfig){0});
+  GLMS_ASSERT(glms_env_exec(&plain) != 0);
+
+  prefetched = glms_count_prefetched(&plain);
+  GLMS_ASSERT(prefetched == 0);
+
+  glms_env_clear(&plain);
+  GLMS_ASSERT(glms_module_registry_clear() == 1);
+}
+
+static void test_sample_async() {
+  GLMS_TEST_BEGIN();
+  GLMSEnv env = {0};
+  char *source = glms_get_file_contents("test/samples/async.gs");
+  GLMS_ASSERT(source != 0);
+  glms_env_init(&env, source, "test/samples/async.gs", (GLMSConfig){});
+
+  char out_path[] = "/tmp/glms_async_XXXXXX";
+  int fd = mkstemp(out_path);
+  GLMS_ASSERT(fd >= 0);
+  close(fd);
+
+  glms_env_register_any(&env, "out_path",
+                        glms_env_new_ast_string(&env, out_path, false));
+
+  GLMSAST *ast = glms_env_exec(&env);
+  GLMS_ASSERT(ast != 0);
+
+  char *helpers = glms_get_file_contents("test/samples/import_helpers.gs");
+  GLMSAST *first = glms_eval_lookup(&env.eval, &env.stack, "first");
+  GLMS_ASSERT(first != 0 && helpers != 0);
+  const char *first_value = glms_ast_get_string_value(first);
+  GLMS_ASSERT(first_value != 0 && strcmp(first_value, helpers) == 0);
+  free(helpers);
+
+  GLMSAST *called = glms_eval_lookup(&env.eval, &env.stack, "called");
+  GLMS_ASSERT(called != 0);
+  GLMS_ASSERT(GLMSAST_VALUE(called) == 1);
+
+  GLMSAST *written = glms_eval_lookup(&env.eval, &env.stack, "written");
+  GLMS_ASSERT(written != 0 && written->as.boolean == true);
+
+  GLMSAST *back = glms_eval_lookup(&env.eval, &env.stack, "back");
+  GLMS_ASSERT(back != 0);
+  const char *back_value = glms_ast_get_string_value(back);
+  GLMS_ASSERT(back_value != 0 && strcmp(back_value, "written later") == 0);
+
+  // `missing` was never awaited, it resolves once the host polls.
+  int64_t waiting = 1;
+  while (waiting > 0) waiting = glms_env_poll(&env);
+
+  GLMSAST *polled = glms_eval_lookup(&env.eval, &env.stack, "polled");
+  GLMS_ASSERT(polled != 0);
+  GLMS_ASSERT(GLMSAST_VALUE(polled) == 1);
+
+  unlink(out_path);
+
+  GLMS_TEST_END();
+}
+
+static int test_async_work(GLMSFuture *future) { return 1; }
+
+static void test_async_release() {
+  GLMS_TEST_BEGIN();
+  GLMSEnv env = {0};
+  glms_env_init(&env, "number x = 1;", 0, (GLMSConfig){0});
+
+  // like a host polling every frame, with futures nothing holds.
+  for (int64_t i = 0; i < 1000; i++) {
+    GLMSFuture *a = glms_future_new(&env, test_async_work, 0);
+    GLMSFuture *b = glms_future_new(&env, 0, 0);
+    glms_future_start(a);
+    glms_future_start(b);
+
+    int64_t waiting = 1;
+    while (waiting > 0) waiting = glms_env_poll(&env);
+  }
+
+  int64_t count = glms_async_count(&env);
+  GLMS_ASSERT(count == 0);
+
+  // the parts are kept until the future reading them settles.
+  GLMSFuture *parts[2] = {glms_future_new(&env, test_async_work, 0),
+                          glms_future_new(&env, 0, 0)};
+  GLMSFuture *all = glms_future_all(&env, parts, 2);
+  glms_future_start(parts[0]);
+  glms_future_start(parts[1]);
+
+  GLMSAST *value = glms_future_await(all);
+  GLMS_ASSERT(value != 0 && value->type == GLMS_AST_TYPE_ARRAY);
+  GLMS_ASSERT(value->children != 0 && value->children->length == 2);
+  count = glms_async_count(&env);
+  GLMS_ASSERT(count == 0);
+
+  // one with a script value stays, as the value may still be read.
+  GLMSFuture *held = glms_future_new(&env, 0, 0);
+  GLMSAST *ast = glms_future_new_ast(&env, held);
+  glms_future_start(held);
+  value = glms_future_await(held);
+  GLMS_ASSERT(value != 0);
+  count = glms_async_count(&env);
+  GLMS_ASSERT(count == 1);
+  GLMS_ASSERT(glms_future_from_ast(*ast) == held);
+  GLMS_ASSERT(held->state == GLMS_FUTURE_RESOLVED);
+
+  GLMS_TEST_END();
+}
+
+// A stand-in HTTP server for the fetch tests, on a port of 127.0.0.1.
+// Connections are kept alive until the client closes them.
+typedef struct {
+  int fd;
+  int port;
+  pthread_t thread;
+  int64_t connections;
+  int64_t requests;
+} GLMSTestServer;
+
+static GLMSTestServer glms_test_server = {0};
+
+static void glms_test_server_respond(int fd, const char *request) {
+  char path[64] = {0};
+  sscanf(request, "GET %63s", path);
+
+  const char *status = "200 OK";
+  char body[128] = {0};
+
+  if (strcmp(path, "/missing") == 0) {
+    status = "404 Not Found";
+    sprintf(body, "not found");
+  } else {
+    sprintf(body, "hello from %s", path + 1);
+  }
+
+  char response[256] = {0};
+  int length = snprintf(response, sizeof(response),
+                        "HTTP/1.1 %s\r\nContent-Type: text/plain\r\n"
+                        "Content-Length: %ld\r\n\r\n%s",
+                        status, strlen(body), body);
+  send(fd, response, length, MSG_NOSIGNAL);
+}
+
+static void *glms_test_server_connection(void *ptr) {
+  int fd = (int)(intptr_t)ptr;
+  char buffer[4096] = {0};
+  int64_t length = 0;
+
+  while (true) {
+    ssize_t n = recv(fd, buffer + length, sizeof(buffer) - length - 1, 0);
+    if (n <= 0) break;
+    length += n;
+    buffer[length] = 0;
+
+    char *end = 0;
+
+    while ((end = strstr(buffer, "\r\n\r\n")) != 0) {
+      __atomic_add_fetch(&glms_test_server.requests, 1, __ATOMIC_RELAXED);
+      glms_test_server_respond(fd, buffer);
+
+      int64_t used = (end + 4) - buffer;
+      memmove(buffer, buffer + used, length - used + 1);
+      length -= used;
+    }
+  }
+
+  close(fd);
+
+  return 0;
+}
+
+static void *glms_test_server_main(void *ptr) {
+  int server_fd = (int)(intptr_t)ptr;
+
+  while (true) {
+    int fd = accept(server_fd, 0, 0);
+    if (fd < 0) break;
+
+    __atomic_add_fetch(&glms_test_server.connections, 1, __ATOMIC_RELAXED);
+
+    pthread_t thread;
+    pthread_create(&thread, 0, glms_test_server_connection,
+                   (void *)(intptr_t)fd);
+    pthread_detach(thread);
+  }
+
+  return 0;
+}
+
+static bool glms_test_server_start() {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) return false;
+
+  struct sockaddr_in addr = {0};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = 0;
+
+  socklen_t addr_length = sizeof(addr);
+
+  if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+      listen(fd, 16) != 0 ||
+      getsockname(fd, (struct sockaddr *)&addr, &addr_length) != 0) {
+    close(fd);
+    return false;
+  }
+
+  glms_test_server.fd = fd;
+  glms_test_server.port = ntohs(addr.sin_port);
+
+  return pthread_create(&glms_test_server.thread, 0, glms_test_server_main,
+                        (void *)(intptr_t)fd) == 0;
+}
+
+static void glms_test_server_stop() {
+  shutdown(glms_test_server.fd, SHUT_RDWR);
+  pthread_join(glms_test_server.thread, 0);
+  close(glms_test_server.fd);
+}
+
+static void test_sample_fetch_all() {
+  GLMS_TEST_BEGIN();
+  GLMSEnv env = {0};
+  GLMS_ASSERT(glms_test_server_start());
+
+  char *source = glms_get_file_contents("test/samples/fetch_all.gs");
+  GLMS_ASSERT(source != 0);
+  glms_env_init(&env, source, "test/samples/fetch_all.gs", (GLMSConfig){});
+
+  char base_url[64] = {0};
+  sprintf(base_url, "http://127.0.0.1:%d", glms_test_server.port);
+  glms_env_register_any(&env, "base_url",
+                        glms_env_new_ast_string(&env, base_url, false));
+
+  GLMSAST *ast = glms_env_exec(&env);
+  GLMS_ASSERT(ast != 0);
+
+  GLMSAST *first_status = glms_eval_lookup(&env.eval, &env.stack, "first_status");
+  GLMS_ASSERT(first_status != 0);
+  GLMS_ASSERT(GLMSAST_VALUE(first_status) == 200);
+
+  GLMSAST *first_text = glms_eval_lookup(&env.eval, &env.stack, "first_text");
+  GLMS_ASSERT(first_text != 0);
+  const char *first_value = glms_ast_get_string_value(first_text);
+  GLMS_ASSERT(first_value != 0 && strcmp(first_value, "hello from one") == 0);
+
+  GLMSAST *second_text = glms_eval_lookup(&env.eval, &env.stack, "second_text");
+  GLMS_ASSERT(second_text != 0);
+  const char *second_value = glms_ast_get_string_value(second_text);
+  GLMS_ASSERT(second_value != 0 && strcmp(second_value, "hello from two") == 0);
+
+  GLMSAST *count = glms_eval_lookup(&env.eval, &env.stack, "count");
+  GLMS_ASSERT(count != 0);
+  GLMS_ASSERT(GLMSAST_VALUE(count) == 4);
+
+  GLMSAST *third_text = glms_eval_lookup(&env.eval, &env.stack, "third_text");
+  GLMS_ASSERT(third_text != 0);
+  const char *third_value = glms_ast_get_string_value(third_text);
+  GLMS_ASSERT(third_value != 0 && strcmp(third_value, "hello from three") == 0);
+
+  GLMSAST *missing_status = glms_eval_lookup(&env.eval, &env.stack, "missing_status");
+  GLMS_ASSERT(missing_status != 0);
+  GLMS_ASSERT(GLMSAST_VALUE(missing_status) == 404);
+
+  // `later` is not awaited, so it may only resolve once the host polls.
+  int64_t waiting = 1;
+  while (waiting > 0) waiting = glms_env_poll(&env);
+
+  GLMSAST *called = glms_eval_lookup(&env.eval, &env.stack, "called");
+  GLMS_ASSERT(called != 0);
+  GLMS_ASSERT(GLMSAST_VALUE(called) == 1);
+
+  // the two fetches in a row go over the same connection.
+  int64_t requests = __atomic_load_n(&glms_test_server.requests, __ATOMIC_RELAXED);
+  int64_t connections = __atomic_load_n(&glms_test_server.connections, __ATOMIC_RELAXED);
+  GLMS_ASSERT(requests == 7);
+  GLMS_ASSERT(connections < requests);
+
+  glms_test_server_stop();
+
+  GLMS_TEST_END();
+}
+
+static void test_sample_channel() {
+  GLMS_TEST_BEGIN();
+  GLMSEnv env = {0};
+  char *source = glms_get_file_contents("test/samples/channel.gs");
+  GLMS_ASSERT(source != 0);
+  glms_env_init(&env, source, "test/samples/channel.gs", (GLMSConfig){});
+
+  float shared[4] = {0};
+  glms_env_register_any(
+      &env, "shared",
+      glms_env_new_ast_typed_array(&env, GLMS_AST_TYPE_NUMBER, shared, 4, 0,
+                                   true));
+
+  GLMSAST *ast = glms_env_exec(&env);
+  GLMS_ASSERT(ast != 0);
+
+  GLMSAST *n = glms_eval_lookup(&env.eval, &env.stack, "n");
+  GLMS_ASSERT(n != 0);
+  GLMS_ASSERT(GLMSAST_VALUE(n) == 3);
+
+  GLMSAST *s = glms_eval_lookup(&env.eval, &env.stack, "s");
+  GLMS_ASSERT(s != 0);
+  const char *s_value = glms_ast_get_string_value(s);
+  GLMS_ASSERT(s_value != 0 && strcmp(s_value, "hello") == 0);
+
+  GLMSAST *count = glms_eval_lookup(&env.eval, &env.stack, "count");
+  GLMS_ASSERT(count != 0);
+  GLMS_ASSERT(GLMSAST_VALUE(count) == 3);
+
+  GLMSAST *name = glms_eval_lookup(&env.eval, &env.stack, "name");
+  GLMS_ASSERT(name != 0);
+  const char *name_value = glms_ast_get_string_value(name);
+  GLMS_ASSERT(name_value != 0 && strcmp(name_value, "John") == 0);
+
+  GLMSAST *doubled = glms_eval_lookup(&env.eval, &env.stack, "doubled");
+  GLMS_ASSERT(doubled != 0);
+  GLMS_ASSERT(doubled->as.v3.z == 6);
+
+  GLMS_ASSERT(shared[0] == 5);
+
+  GLMSAST *sent = glms_eval_lookup(&env.eval, &env.stack, "sent");
+  GLMS_ASSERT(sent != 0 && sent->as.boolean == false);
+
+  // values sent before close are still received.
+  GLMSAST *last = glms_eval_lookup(&env.eval, &env.stack, "last");
+  GLMS_ASSERT(last != 0);
+  GLMS_ASSERT(GLMSAST_VALUE(last) == 7);
+
+  GLMSAST *after = glms_eval_lookup(&env.eval, &env.stack, "after");
+  GLMS_ASSERT(after != 0);
+  GLMS_ASSERT(GLMSAST_VALUE(after) == -1);
+
+  GLMS_TEST_END();
+}
+
+#define GLMS_TEST_CHANNEL_STAGES 2
+
+typedef struct {
+  const char *path;
+  GLMSChannel *jobs;
+  GLMSChannel *results;
+  GLMSEnv env;
+} GLMSTestChannelStage;
+
+static void *test_channel_stage(void *ptr) {
+  GLMSTestChannelStage *stage = (GLMSTestChannelStage *)ptr;
+  GLMSEnv *env = &stage->env;
+
+  char *source = glms_get_file_contents(stage->path);
+  glms_env_init(env, source, stage->path, (GLMSConfig){});
+
+  if (stage->jobs)
+    glms_env_register_any(env, "jobs", glms_channel_new_ast(env, stage->jobs));
+  if (stage->results)
+    glms_env_register_any(env, "results",
+                          glms_channel_new_ast(env, stage->results));
+
+  glms_env_exec(env);
+
+  return 0;
+}
+
+static void test_channel_pipeline() {
+  GLMS_TEST_BEGIN();
+  glms_builtin_load_modules();
+
+
+  GLMSChannel *jobs = glms_channel_new(8);
+  GLMSChannel *results = glms_channel_new(8);
+  GLMS_ASSERT(jobs != 0 && results != 0);
+
+  GLMSTestChannelStage source = {.path = "test/samples/channel_source.gs",
+                                 .jobs = jobs};
+  GLMSTestChannelStage sink = {.path = "test/samples/channel_sink.gs",
+                               .results = results};
+  GLMSTestChannelStage stages[GLMS_TEST_CHANNEL_STAGES] = {0};
+
+  pthread_t source_thread;
+  pthread_t sink_thread;
+  pthread_t stage_threads[GLMS_TEST_CHANNEL_STAGES];
+
+  pthread_create(&sink_thread, 0, test_channel_stage, &sink);
+
+  for (int64_t i = 0; i < GLMS_TEST_CHANNEL_STAGES; i++) {
+    stages[i] = (GLMSTestChannelStage){.path = "test/samples/channel_stage.gs",
+                                       .jobs = jobs,
+                                       .results = results};
+    pthread_create(&stage_threads[i], 0, test_channel_stage, &stages[i]);
+  }
+
+  pthread_create(&source_thread, 0, test_channel_stage, &source);
+
+  pthread_join(source_thread, 0);
+
+  for (int64_t i = 0; i < GLMS_TEST_CHANNEL_STAGES; i++) {
+    pthread_join(stage_threads[i], 0);
+  }
+
+  // the sink stops once every stage is done.
+  glms_channel_close(results);
+  pthread_join(sink_thread, 0);
+
+  int64_t handled = 0;
+
+  for (int64_t i = 0; i < GLMS_TEST_CHANNEL_STAGES; i++) {
+    GLMSAST *value =
+        glms_eval_lookup(&stages[i].env.eval, &stages[i].env.stack, "handled");
+    GLMS_ASSERT(value != 0);
+    handled += (int64_t)GLMSAST_VALUE(value);
+  }
+
+  GLMS_ASSERT(handled == 200);
+
+  GLMSAST *count = glms_eval_lookup(&sink.env.eval, &sink.env.stack, "count");
+  GLMS_ASSERT(count != 0);
+  GLMS_ASSERT(GLMSAST_VALUE(count) == 200);
+
+  // 2 * (1 + 2 + ... + 200)
+  GLMSAST *total = glms_eval_lookup(&sink.env.eval, &sink.env.stack, "total");
+  GLMS_ASSERT(total != 0);
+  GLMS_ASSERT(GLMSAST_VALUE(total) == 40200);
+
+  glms_env_clear(&source.env);
+  glms_env_clear(&sink.env);
+
+  for (int64_t i = 0; i < GLMS_TEST_CHANNEL_STAGES; i++) {
+    glms_env_clear(&stages[i].env);
+  }
+
+  glms_channel_release(jobs);
+  glms_channel_release(results);
+}
+
+static void test_batch_run() {
+  GLMS_TEST_BEGIN();
+
+  char **paths = 0;
+  int64_t count = 0;
+  GLMS_ASSERT(glms_batch_read_list("test/samples/batch.txt", &paths, &count));
+  GLMS_ASSERT(count == 11);
+  GLMS_ASSERT(strcmp(paths[0], "test/samples/while.gs") == 0);
+
+  GLMSBatchResult results[11] = {0};
+  int64_t failed =
+      glms_batch_run((const char **)paths, count, 2, (GLMSConfig){}, results);
+
+  GLMS_ASSERT(failed == 2);
+
+  for (int64_t i = 0; i < count; i++) {
+    GLMS_ASSERT(strcmp(results[i].path, paths[i]) == 0);
+    bool fails = strstr(paths[i], "no_such_script") != 0 ||
+                 strstr(paths[i], "runtime_error") != 0;
+    GLMS_ASSERT(results[i].ok == !fails);
+  }
+
+  glms_batch_free_list(paths, count);
+
+  // the warning is counted, but not as an error.
+  GLMSEnv env = {0};
+  GLMSAST *ast = glms_exec_file(&env, "test/samples/warning_only.gs");
+  GLMS_ASSERT(ast != 0);
+  GLMS_ASSERT(env.warnings > 0);
+  GLMS_ASSERT(env.errors == 0);
+  GLMS_TEST_END();
+}
+
+static void test_sample_handle() {
+  GLMS_TEST_BEGIN();
+  GLMSEnv env = {0};
+  GLMSAST *ast = glms_exec_file(&env, "test/samples/handle.gs");
+  GLMS_ASSERT(ast != 0);
+
+  GLMSFunctionHandle *add = glms_env_get_function(&env, "add");
+  GLMS_ASSERT(add != 0);
+  GLMS_ASSERT(glms_env_get_function(&env, "add") == add);
+
+  GLMSASTBuffer args = {0};
+  glms_GLMSAST_buffer_init(&args);
+  glms_GLMSAST_buffer_push(&args, (GLMSAST){.type = GLMS_AST_TYPE_NUMBER});
+  glms_GLMSAST_buffer_push(&args, (GLMSAST){.type = GLMS_AST_TYPE_NUMBER});
+
+  GLMSAST result = {0};
+  for (int i = 0; i < 100; i++) {
+    args.items[0].as.number.value = (float)i;
+    args.items[1].as.number.value = 1.0f;
+    glms_env_call_handle(add, args, &result);
+  }
+  GLMS_ASSERT(glms_ast_number(result) == 100);
+
+  GLMSFunctionHandle *accumulate = glms_env_get_function(&env, "accumulate");
+  GLMS_ASSERT(accumulate != 0);
+
+  args.items[0].as.number.value = 2.0f;
+  for (int i = 0; i < 3; i++) {
+    glms_env_call_handle(accumulate, args, &result);
+  }
+  GLMS_ASSERT(glms_ast_number(result) == 6);
+
+  GLMSAST *total = glms_eval_lookup(&env.eval, &env.stack, "total");
+  GLMS_ASSERT(total != 0);
+  GLMS_ASSERT(GLMSAST_VALUE(total) == 6);
+
+  GLMS_ASSERT(glms_env_get_function(&env, "missing") == 0);
+
+  // every call starts from the same frame, and gets its own copy of the array.
+  GLMSFunctionHandle *count = glms_env_get_function(&env, "count");
+  GLMS_ASSERT(count != 0);
+
+  GLMSAST *items = glms_env_new_ast(&env, GLMS_AST_TYPE_ARRAY, true);
+  glms_ast_push(items, glms_env_new_ast_number(&env, 1, true));
+
+  GLMSASTBuffer array_args = {0};
+  glms_GLMSAST_buffer_init(&array_args);
+  glms_GLMSAST_buffer_push(&array_args, (GLMSAST){.type = GLMS_AST_TYPE_STACK_PTR,
+                                                  .as.stackptr.ptr = items});
+
+  for (int i = 0; i < 100; i++) {
+    glms_env_call_handle(count, array_args, &result);
+  }
+  GLMS_ASSERT(glms_ast_number(result) == 2);
+  GLMS_ASSERT(items->children->length == 1);
+  GLMS_ASSERT(glms_stack_get(&count->frame, "seen") == 0);
+  GLMS_ASSERT(glms_stack_get(&count->frame, "items") == 0);
+  GLMS_ASSERT(glms_stack_get(&count->frame, "return") == 0);
+
+  // what a call allocates is released by the next one.
+  GLMSFunctionHandle *sum = glms_env_get_function(&env, "sum");
+  GLMS_ASSERT(sum != 0);
+
+  GLMSASTBuffer sum_args = {0};
+  glms_GLMSAST_buffer_init(&sum_args);
+  glms_GLMSAST_buffer_push(&sum_args, (GLMSAST){.type = GLMS_AST_TYPE_NUMBER,
+                                                .as.number.value = 20});
+
+  glms_env_call_handle(sum, sum_args, &result);
+  int64_t env_pages = env.arena_ast.pages;
+  int64_t scope_pages = sum->scope.arena_ast.pages;
+
+  for (int i = 0; i < 5000; i++) {
+    glms_env_call_handle(sum, sum_args, &result);
+  }
+  GLMS_ASSERT(glms_ast_number(result) == 380);
+  GLMS_ASSERT(env.arena_ast.pages == env_pages);
+  GLMS_ASSERT(sum->scope.arena_ast.pages == scope_pages);
+
+  // an array stored in a global outlives the call that made it.
+  GLMSFunctionHandle *record = glms_env_get_function(&env, "record");
+  GLMS_ASSERT(record != 0);
+
+  for (int i = 0; i < 3; i++) {
+    args.items[0].as.number.value = (float)i;
+    glms_env_call_handle(record, args, &result);
+  }
+  GLMS_ASSERT(glms_ast_number(result) == 3);
+
+  GLMSAST *history = glms_eval_lookup(&env.eval, &env.stack, "history");
+  GLMS_ASSERT(history != 0);
+  history = glms_ast_get_ptr(*history) ? glms_ast_get_ptr(*history) : history;
+  GLMS_ASSERT(history->children->length == 3);
+  GLMSAST *first = history->children->items[0];
+  GLMS_ASSERT(first->children->length == 2);
+  GLMS_ASSERT(GLMSAST_VALUE(first->children->items[1]) == 1);
+
+  glms_GLMSAST_buffer_clear(&sum_args);
+  glms_GLMSAST_buffer_clear(&array_args);
+  glms_GLMSAST_buffer_clear(&args);
+  GLMS_TEST_END();
+}
+
+typedef struct {
+  Vector3 position;
+  float health;
+  float score;
+  bool alive;
+} TestPlayer;
+
+static void test_sample_layout() {
+  GLMS_TEST_BEGIN();
+  GLMSEnv env = {0};
+  char *source = glms_get_file_contents("test/samples/layout.gs");
+  GLMS_ASSERT(source != 0);
+  glms_env_init(&env, source, "test/samples/layout.gs", (GLMSConfig){});
+
+  TestPlayer player = {.position = (Vector3){1, 1, 1}, .health = 100, .alive = true};
+
+  GLMSAST *t = glms_env_register_struct_layout(
+      &env, "Player",
+      (GLMSStructField[]){
+          {"position", GLMS_AST_TYPE_VEC3, offsetof(TestPlayer, position)},
+          {"health", GLMS_AST_TYPE_NUMBER, offsetof(TestPlayer, health)},
+          {"score", GLMS_AST_TYPE_NUMBER, offsetof(TestPlayer, score)},
+          {"alive", GLMS_AST_TYPE_BOOL, offsetof(TestPlayer, alive)}},
+      4);
+  GLMS_ASSERT(t != 0);
+
+  GLMSAST *instance = glms_env_new_ast_bound(&env, "Player", &player);
+  GLMS_ASSERT(instance != 0);
+  glms_env_register_any(&env, "player", instance);
+
+  GLMSAST *ast = glms_env_exec(&env);
+  GLMS_ASSERT(ast != 0);
+
+  GLMS_ASSERT(player.health == 90);
+  GLMS_ASSERT(player.score == 100);
+  GLMS_ASSERT(player.alive == false);
+  GLMS_ASSERT(player.position.x == 2 && player.position.y == 3 &&
+              player.position.z == 4);
+
+  GLMSAST *health = glms_eval_lookup(&env.eval, &env.stack, "health");
+  GLMS_ASSERT(health != 0);
+  GLMS_ASSERT(GLMSAST_VALUE(health) == 90);
+
+  GLMSAST *position = glms_eval_lookup(&env.eval, &env.stack, "position");
+  GLMS_ASSERT(position != 0);
+  GLMS_ASSERT(position->as.v3.z == 4);
+
+  // sites of a frozen env are shared between threads and never written.
+  GLMSStructLayout *layout = glms_struct_layout_new(
+      (GLMSStructField[]){
+          {"health", GLMS_AST_TYPE_NUMBER, offsetof(TestPlayer, health)},
+          {"score", GLMS_AST_TYPE_NUMBER, offsetof(TestPlayer, score)}},
+      2);
+  GLMSAST site = {.env_ref = &env};
+
+  glms_env_freeze(&env);
+  GLMS_ASSERT(glms_struct_layout_lookup(layout, &site, "score") == 1);
+  GLMS_ASSERT(site.cached_shape == 0);
+  glms_struct_layout_free(layout);
+
+  GLMS_TEST_END();
+  free(source);
+}
+
+static void test_sample_typed_array() {
+  GLMS_TEST_BEGIN();
+  GLMSEnv env = {0};
+  char *source = glms_get_file_contents("test/samples/typed_array.gs");
+  GLMS_ASSERT(source != 0);
+  glms_env_init(&env, source, "test/samples/typed_array.gs", (GLMSConfig){});
+
+  Vector3 positions[3] = {{0, 0, 0}, {1, 1, 1}, {2, 2, 2}};
+  float weights[3] = {1, 2, 3};
+  float constants[2] = {7, 8};
+
+  glms_env_register_any(
+      &env, "positions",
+      glms_env_new_ast_typed_array(&env, GLMS_AST_TYPE_VEC3, positions, 3, 0,
+                                   true));
+  glms_env_register_any(
+      &env, "weights",
+      glms_env_new_ast_typed_array(&env, GLMS_AST_TYPE_NUMBER, weights, 3, 0,
+                                   true));
+  glms_env_register_any(
+      &env, "constants",
+      glms_env_new_ast_typed_array(&env, GLMS_AST_TYPE_NUMBER, constants, 2, 0,
+                                   false));
+
+  GLMSAST *ast = glms_env_exec(&env);
+  GLMS_ASSERT(ast != 0);
+
+  GLMS_ASSERT(positions[0].y == 1 && positions[1].y == 2 &&
+              positions[2].y == 3);
+  GLMS_ASSERT(weights[0] == 5 && weights[1] == 4 && weights[2] == 3);
+  GLMS_ASSERT(constants[0] == 7);
+
+  GLMSAST *total = glms_eval_lookup(&env.eval, &env.stack, "total");
+  GLMS_ASSERT(total != 0);
+  GLMS_ASSERT(GLMSAST_VALUE(total) == 12);
+
+  GLMSAST *last = glms_eval_lookup(&env.eval, &env.stack, "last");
+  GLMS_ASSERT(last != 0);
+  GLMS_ASSERT(GLMSAST_VALUE(last) == 6);
+
+  GLMSAST *after = glms_eval_lookup(&env.eval, &env.stack, "after");
+  GLMS_ASSERT(after != 0);
+  GLMS_ASSERT(GLMSAST_VALUE(after) == 7);
+
+  GLMS_TEST_END();
+  free(source);
+}
+
+static GLMSNativeValue test_native_madd(const GLMSNativeValue *args) {
+  return (GLMSNativeValue){.number = args[0].number * args[1].number +
+                                     args[2].number};
+}
+
+static GLMSNativeValue test_native_scale3(const GLMSNativeValue *args) {
+  return (GLMSNativeValue){.v3 = vector3_scale(args[0].v3, args[1].number)};
+}
+
+static void test_sample_native() {
+  GLMS_TEST_BEGIN();
+  GLMSEnv env = {0};
+  char *source = glms_get_file_contents("test/samples/native.gs");
+  GLMS_ASSERT(source != 0);
+  glms_env_init(&env, source, "test/samples/native.gs", (GLMSConfig){});
+
+  glms_env_register_native(
+      &env, "madd",
+      (GLMSFunctionSignature){
+          .return_type = (GLMSType){GLMS_AST_TYPE_NUMBER},
+          .args = (GLMSType[]){(GLMSType){GLMS_AST_TYPE_NUMBER},
+                               (GLMSType){GLMS_AST_TYPE_NUMBER},
+                               (GLMSType){GLMS_AST_TYPE_NUMBER}},
+          .args_length = 3},
+      test_native_madd);
+  glms_env_register_native(
+      &env, "scale3",
+      (GLMSFunctionSignature){
+          .return_type = (GLMSType){GLMS_AST_TYPE_VEC3},
+          .args = (GLMSType[]){(GLMSType){GLMS_AST_TYPE_VEC3},
+                               (GLMSType){GLMS_AST_TYPE_NUMBER}},
+          .args_length = 2},
+      test_native_scale3);
+
+  GLMSAST *ast = glms_env_exec(&env);
+  GLMS_ASSERT(ast != 0);
+
+  GLMSAST *a = glms_eval_lookup(&env.eval, &env.stack, "a");
+  GLMS_ASSERT(a != 0);
+  GLMS_ASSERT(GLMSAST_VALUE(a) == 10);
+
+  GLMSAST *v = glms_eval_lookup(&env.eval, &env.stack, "v");
+  GLMS_ASSERT(v != 0);
+  GLMS_ASSERT(v->as.v3.x == 2 && v->as.v3.y == 4 && v->as.v3.z == 6);
+
+  GLMSAST *c = glms_eval_lookup(&env.eval, &env.stack, "c");
+  GLMS_ASSERT(c != 0);
+  GLMS_ASSERT(GLMSAST_VALUE(c) == 1);
+
+  GLMSAST *m = glms_eval_lookup(&env.eval, &env.stack, "m");
+  GLMS_ASSERT(m != 0);
+  GLMS_ASSERT(m->as.m4.raw[0][0] == 1 && m->as.m4.raw[1][1] == 1);
+
+  GLMSAST *e = glms_eval_lookup(&env.eval, &env.stack, "e");
+  GLMS_ASSERT(e == 0 || GLMSAST_VALUE(e) == 0);
+
+  // vector builtins pick the signature matching the argument width.
+  GLMSAST *d2 = glms_eval_lookup(&env.eval, &env.stack, "d2");
+  GLMS_ASSERT(d2 != 0 && GLMSAST_VALUE(d2) == 11);
+
+  GLMSAST *d4 = glms_eval_lookup(&env.eval, &env.stack, "d4");
+  GLMS_ASSERT(d4 != 0 && GLMSAST_VALUE(d4) == 10);
+
+  GLMSAST *n4 = glms_eval_lookup(&env.eval, &env.stack, "n4");
+  GLMS_ASSERT(n4 != 0 && n4->type == GLMS_AST_TYPE_VEC4);
+  GLMS_ASSERT(n4->as.v4.w == 1 && n4->as.v4.x == 0);
+
+  GLMS_TEST_END();
+  free(source);
+}
+
+static void test_sample_snapshot() {
+  GLMS_TEST_BEGIN();
+  GLMSEnv env = {0};
+  GLMSAST *ast = glms_exec_file(&env, "test/samples/snapshot.gs");
+  GLMS_ASSERT(ast != 0);
+
+  GLMSEnvSnapshot *snapshot = glms_env_snapshot(&env);
+  GLMS_ASSERT(snapshot != 0);
+
+  GLMSEnv a = {0};
+  GLMSEnv b = {0};
+  int forked_a = glms_env_fork(
+      snapshot, &a, "counter = counter + add(2, 3); names.push(\"c\");", 0);
+  int forked_b =
+      glms_env_fork(snapshot, &b, "counter = counter + 100; bump();", 0);
+  GLMS_ASSERT(forked_a != 0);
+  GLMS_ASSERT(forked_b != 0);
+
+  GLMSAST *root_a = glms_env_exec(&a);
+  GLMSAST *root_b = glms_env_exec(&b);
+  GLMS_ASSERT(root_a != 0);
+  GLMS_ASSERT(root_b != 0);
+
+  GLMSAST *counter_a = glms_eval_lookup(&a.eval, &a.stack, "counter");
+  GLMS_ASSERT(counter_a != 0);
+  GLMS_ASSERT(GLMSAST_VALUE(counter_a) == 6);
+
+  GLMSAST *counter_b = glms_eval_lookup(&b.eval, &b.stack, "counter");
+  GLMS_ASSERT(counter_b != 0);
+  GLMS_ASSERT(GLMSAST_VALUE(counter_b) == 102);
+
+  GLMSAST *counter = glms_eval_lookup(&env.eval, &env.stack, "counter");
+  GLMS_ASSERT(counter != 0);
+  GLMS_ASSERT(GLMSAST_VALUE(counter) == 1);
+
+  GLMSAST *names = glms_eval_lookup(&env.eval, &env.stack, "names");
+  GLMSAST *names_ptr = names ? glms_ast_get_ptr(*names) : 0;
+  names = names_ptr ? names_ptr : names;
+  GLMS_ASSERT(names != 0);
+  GLMS_ASSERT(glms_ast_array_get_length(names) == 2);
+
+  GLMSAST result = {0};
+  int called = glms_env_call_function(
+      &b, "add",
+      (GLMSASTBuffer){
+          .initialized = true,
+          .items =
+              (GLMSAST[]){
+                  (GLMSAST){.type = GLMS_AST_TYPE_NUMBER, .as.number.value = 1},
+                  (GLMSAST){.type = GLMS_AST_TYPE_NUMBER,
+                            .as.number.value = 2}},
+          .length = 2},
+      &result);
+  GLMS_ASSERT(called != 0);
+  GLMS_ASSERT(result.as.number.value == 3);
+
+  glms_env_clear(&a);
+  glms_env_clear(&b);
+  glms_env_snapshot_free(snapshot);
+  GLMS_TEST_END();
+}
+
+static void test_builtin_prototype() {
+  GLMS_TEST_BEGIN();
+  GLMSEnv env = {0};
+  GLMSEnv b = {0};
+  glms_env_init(&env, "number x = cos(0.0);", 0, (GLMSConfig){0});
+  glms_env_init(&b, "vec3 v = vec3(1, 2, 3);", 0, (GLMSConfig){0});
+
+  GLMSAST *cos_a = glms_env_lookup_function(&env, "cos");
+  GLMSAST *cos_b = glms_env_lookup_function(&b, "cos");
+  GLMS_ASSERT(cos_a != 0);
+  GLMS_ASSERT(cos_a == cos_b);
+  GLMS_ASSERT(hashy_map_get(&env.globals, "cos") == 0);
+
+  GLMSAST *root_a = glms_env_exec(&env);
+  GLMSAST *root_b = glms_env_exec(&b);
+  GLMS_ASSERT(root_a != 0);
+  GLMS_ASSERT(root_b != 0);
+
+  GLMSAST *x = glms_eval_lookup(&env.eval, &env.stack, "x");
+  GLMS_ASSERT(x != 0);
+  GLMS_ASSERT(GLMSAST_VALUE(x) == 1);
+
+  GLMSAST *v = glms_eval_lookup(&b.eval, &b.stack, "v");
+  GLMS_ASSERT(v != 0);
+  GLMS_ASSERT(v->as.v3.z == 3);
+
+  glms_env_clear(&b);
+  GLMS_TEST_END();
+}
+
+#define GLMS_TEST_LAZY_THREADS 4
+
+static void *test_builtin_lazy_worker(void *ptr) {
+  bool *found = (bool *)ptr;
+
+  GLMSEnv env = {0};
+  glms_env_init(&env, 0, 0, (GLMSConfig){0});
+
+  // every thread may be the one registering a module, or reading the
+  // prototype while another one does.
+  *found = glms_env_lookup_type(&env, "json") != 0 &&
+           glms_env_lookup_function(&env, "fetch") != 0 &&
+           glms_env_lookup_type(&env, "response") != 0 &&
+           glms_env_lookup_type(&env, "file") != 0;
+
+  glms_env_clear(&env);
+
+  return 0;
+}
+
+static void test_builtin_lazy_modules() {
+  GLMS_TEST_BEGIN();
+  GLMSEnv env = {0};
+  glms_env_init(&env, 0, 0, (GLMSConfig){0});
+
+  GLMSEnv *prototype = glms_builtin_get_prototype();
+  GLMS_ASSERT(hashy_map_get(&prototype->types, "json") == 0);
+  GLMS_ASSERT(hashy_map_get(&prototype->globals, "fetch") == 0);
+
+  pthread_t threads[GLMS_TEST_LAZY_THREADS];
+  bool found[GLMS_TEST_LAZY_THREADS] = {0};
+
+  for (int64_t i = 0; i < GLMS_TEST_LAZY_THREADS; i++) {
+    pthread_create(&threads[i], 0, test_builtin_lazy_worker, &found[i]);
+  }
+
+  for (int64_t i = 0; i < GLMS_TEST_LAZY_THREADS; i++) {
+    pthread_join(threads[i], 0);
+    GLMS_ASSERT(found[i]);
+  }
+
+  GLMSAST *json = glms_env_lookup_type(&env, "json");
+  GLMS_ASSERT(json != 0);
+  GLMS_ASSERT(hashy_map_get(&prototype->types, "json") == json);
+
+  GLMSAST *fetch = glms_env_lookup_function(&env, "fetch");
+  GLMS_ASSERT(fetch != 0);
+  GLMS_ASSERT(glms_env_lookup_type(&env, "response") != 0);
+
+  GLMS_ASSERT(glms_builtin_load_module("json") == 0);
+  GLMS_TEST_END();
+}
+
+#define GLMS_TEST_SHARED_THREADS 4
+
+typedef struct {
+  GLMSEnvSnapshot *snapshot;
+  int64_t index;
+  float result;
+  float work;
+  bool labeled;
+} GLMSTestSharedWorker;
+
+static void *test_shared_worker(void *ptr) {
+  GLMSTestSharedWorker *worker = (GLMSTestSharedWorker *)ptr;
+
+  GLMSEnv env = {0};
+  glms_env_fork(worker->snapshot, &env, 0, 0);
+  glms_env_exec_root(&env, worker->snapshot->env->root);
+
+  GLMSAST *result = glms_eval_lookup(&env.eval, &env.stack, "result");
+  worker->result = result ? GLMSAST_VALUE(result) : -1;
+
+  GLMSAST out = {0};
+  glms_env_call_function(
+      &env, "work",
+      (GLMSASTBuffer){.initialized = true,
+                      .items = (GLMSAST[]){(GLMSAST){
+                          .type = GLMS_AST_TYPE_NUMBER,
+                          .as.number.value = (float)worker->index}},
+                      .length = 1},
+      &out);
+  worker->work = glms_ast_number(out);
+
+  glms_env_call_function(
+      &env, "label",
+      (GLMSASTBuffer){.initialized = true,
+                      .items = (GLMSAST[]){(GLMSAST){
+                          .type = GLMS_AST_TYPE_STRING,
+                          .as.string.heap = "y"}},
+                      .length = 1},
+      &out);
+  const char *label = glms_ast_get_string_value(&out);
+  worker->labeled = label != 0 && strcmp(label, "item y") == 0;
+
+  glms_env_clear(&env);
+
+  return 0;
+}
+
+static void test_shared_threads() {
+  GLMS_TEST_BEGIN();
+  GLMSEnv env = {0};
+  GLMSAST *ast = glms_exec_file(&env, "test/samples/shared.gs");
+  GLMS_ASSERT(ast != 0);
+
+  GLMSEnvSnapshot *snapshot = glms_env_snapshot(&env);
+  GLMS_ASSERT(snapshot != 0);
+
+  pthread_t threads[GLMS_TEST_SHARED_THREADS];
+  GLMSTestSharedWorker workers[GLMS_TEST_SHARED_THREADS] = {0};
+
+  for (int64_t i = 0; i < GLMS_TEST_SHARED_THREADS; i++) {
+    workers[i] = (GLMSTestSharedWorker){.snapshot = snapshot, .index = i + 1};
+    pthread_create(&threads[i], 0, test_shared_worker, &workers[i]);
+  }
+
+  for (int64_t i = 0; i < GLMS_TEST_SHARED_THREADS; i++) {
+    pthread_join(threads[i], 0);
+  }
+
+  for (int64_t i = 0; i < GLMS_TEST_SHARED_THREADS; i++) {
+    GLMS_ASSERT(workers[i].result == 60);
+    GLMS_ASSERT(workers[i].work == (i + 1) * 6);
+    GLMS_ASSERT(workers[i].labeled);
+  }
+
+  glms_env_snapshot_free(snapshot);
+  GLMS_TEST_END();
+}
+
+static void test_sample_shade() {
+  GLMS_TEST_BEGIN();
+  GLMSEnv env = {0};
+  GLMSAST *ast = glms_exec_file(&env, "test/samples/shade.gs");
+  GLMS_ASSERT(ast != 0);
+
+  GLMSAST *serial_ok = glms_eval_lookup(&env.eval, &env.stack, "serial_ok");
+  GLMS_ASSERT(serial_ok != 0);
+  GLMS_ASSERT(serial_ok->as.boolean == true);
+
+  GLMSAST *mismatches = glms_eval_lookup(&env.eval, &env.stack, "mismatches");
+  GLMS_ASSERT(mismatches != 0);
+  GLMS_ASSERT(GLMSAST_VALUE(mismatches) == 0);
+
+  // shading on one thread leaves nothing behind in the caller's env.
+  GLMSASTBuffer args = {0};
+  GLMSAST result = {0};
+  GLMS_ASSERT(glms_env_call_function(&env, "reshade", args, &result));
+  int64_t pages = env.arena_ast.pages;
+  bool shaded = true;
+  for (int i = 0; i < 8; i++) {
+    shaded = shaded && glms_env_call_function(&env, "reshade", args, &result) &&
+             result.as.boolean;
+  }
+  GLMS_ASSERT(shaded);
+  GLMS_ASSERT(env.arena_ast.pages == pages);
+
+  GLMS_TEST_END();
+}
+
+static void test_sample_parallel() {
+  GLMS_TEST_BEGIN();
+  GLMSEnv env = {0};
+  GLMSAST *ast = glms_exec_file(&env, "test/samples/parallel.gs");
+  GLMS_ASSERT(ast != 0);
+
+  GLMSAST *mismatches = glms_eval_lookup(&env.eval, &env.stack, "mismatches");
+  GLMS_ASSERT(mismatches != 0);
+  GLMS_ASSERT(GLMSAST_VALUE(mismatches) == 0);
+
+  GLMSAST *total = glms_eval_lookup(&env.eval, &env.stack, "total");
+  GLMSAST *total_serial = glms_eval_lookup(&env.eval, &env.stack, "total_serial");
+  GLMS_ASSERT(total != 0 && total_serial != 0);
+  GLMS_ASSERT(GLMSAST_VALUE(total) == GLMSAST_VALUE(total_serial));
+
+  GLMSAST *unsorted = glms_eval_lookup(&env.eval, &env.stack, "unsorted");
+  GLMS_ASSERT(unsorted != 0);
+  GLMS_ASSERT(GLMSAST_VALUE(unsorted) == 0);
+
+  GLMSAST *label = glms_eval_lookup(&env.eval, &env.stack, "first_label");
+  GLMS_ASSERT(label != 0);
+  const char *label_value = glms_ast_get_string_value(label);
+  GLMS_ASSERT(label_value != 0 && strcmp(label_value, "label c") == 0);
+
+  // 4 * (0 + 1 + ... + 63)
+  GLMSAST *grid_total = glms_eval_lookup(&env.eval, &env.stack, "grid_total");
+  GLMS_ASSERT(grid_total != 0);
+  GLMS_ASSERT(GLMSAST_VALUE(grid_total) == 8064);
+
+  GLMSAST *grid_after = glms_eval_lookup(&env.eval, &env.stack, "grid_after");
+  GLMS_ASSERT(grid_after != 0);
+  GLMS_ASSERT(GLMSAST_VALUE(grid_after) == 15);
+
+  GLMS_TEST_END();
+}
+
+#define GLMS_TEST_PARALLEL_FOR_LENGTH 1000
+
+static void test_sample_parallel_for() {
+  GLMS_TEST_BEGIN();
+  GLMSEnv env = {0};
+  char *source = glms_get_file_contents("test/samples/parallel_for.gs");
+  GLMS_ASSERT(source != 0);
+  glms_env_init(&env, source, "test/samples/parallel_for.gs", (GLMSConfig){});
+
+  float out[GLMS_TEST_PARALLEL_FOR_LENGTH] = {0};
+  glms_env_register_any(
+      &env, "out",
+      glms_env_new_ast_typed_array(&env, GLMS_AST_TYPE_NUMBER, out,
+                                   GLMS_TEST_PARALLEL_FOR_LENGTH, 0, true));
+
+  glms_parallel_reset_stats();
+
+  GLMSAST *ast = glms_env_exec(&env);
+  GLMS_ASSERT(ast != 0);
+
+  GLMSAST *ok = glms_eval_lookup(&env.eval, &env.stack, "ok");
+  GLMS_ASSERT(ok != 0);
+  GLMS_ASSERT(ok->as.boolean == true);
+
+  bool written = true;
+  for (int64_t i = 0; i < GLMS_TEST_PARALLEL_FOR_LENGTH; i++) {
+    written = written && out[i] == i * 2 + 1;
+  }
+  GLMS_ASSERT(written);
+
+  GLMSAST *counter = glms_eval_lookup(&env.eval, &env.stack, "counter");
+  GLMS_ASSERT(counter != 0);
+  GLMS_ASSERT(GLMSAST_VALUE(counter) == 0);
+
+  GLMSParallelStats stats = {0};
+  glms_parallel_get_stats(&stats);
+  GLMS_ASSERT(stats.runs == 2);
+  GLMS_ASSERT(stats.tasks == 63 + 8);
+
+  GLMSAST *tasks = glms_eval_lookup(&env.eval, &env.stack, "tasks");
+  GLMS_ASSERT(tasks != 0);
+  GLMS_ASSERT(GLMSAST_VALUE(tasks) == stats.tasks);
+
+  GLMS_TEST_END();
+}
+
+#define GLMS_TEST_POOL_JOBS 32
+
+static void test_pool_callback(GLMSEnv *env, GLMSAST *result,
+                               void *user_ptr) {
+  __atomic_add_fetch((int64_t *)user_ptr, (int64_t)glms_ast_number(*result),
+                     __ATOMIC_RELAXED);
+}
+
+typedef struct {
+  int64_t jobs;
+  int64_t first_pages;
+  int64_t last_pages;
+} TestPoolMemory;
+
+static void test_pool_memory_callback(GLMSEnv *env, GLMSAST *result,
+                                      void *user_ptr) {
+  TestPoolMemory *memory = (TestPoolMemory *)user_ptr;
+  GLMSFunctionHandle *sum = glms_env_get_function(env, "sum");
+  int64_t pages = env->arena_ast.pages + sum->scope.arena_ast.pages;
+
+  if (memory->jobs++ == 0) memory->first_pages = pages;
+  memory->last_pages = pages;
+}
+
+static GLMSASTBuffer test_pool_args(GLMSAST *arg) {
+  return (GLMSASTBuffer){.initialized = true, .items = arg, .length = 1};
+}
+
+static void test_pool() {
+  GLMS_TEST_BEGIN();
+  char *source = glms_get_file_contents("test/samples/pool.gs");
+  GLMS_ASSERT(source != 0);
+
+  GLMSPool *pool = glms_pool_new(source, "test/samples/pool.gs", 4,
+                                 (GLMSConfig){0});
+  GLMS_ASSERT(pool != 0);
+  GLMS_ASSERT(glms_pool_get_threads(pool) == 4);
+
+  GLMSPoolFuture *futures[GLMS_TEST_POOL_JOBS];
+
+  for (int64_t i = 0; i < GLMS_TEST_POOL_JOBS; i++) {
+    GLMSAST arg = {.type = GLMS_AST_TYPE_NUMBER, .as.number.value = i};
+    futures[i] = glms_pool_submit_future(pool, "sum", test_pool_args(&arg));
+  }
+
+  int64_t total = 0;
+  for (int64_t i = 0; i < GLMS_TEST_POOL_JOBS; i++) {
+    GLMSAST arg = {.type = GLMS_AST_TYPE_NUMBER, .as.number.value = i};
+    glms_pool_submit(pool, "sum", test_pool_args(&arg), test_pool_callback,
+                     &total);
+  }
+
+  GLMSAST name = {.type = GLMS_AST_TYPE_STRING, .as.string.heap = "pool"};
+  GLMSPoolFuture *greeting =
+      glms_pool_submit_future(pool, "greet", test_pool_args(&name));
+
+  bool sums_ok = true;
+  for (int64_t i = 0; i < GLMS_TEST_POOL_JOBS; i++) {
+    GLMSAST result = {0};
+    int ok = glms_pool_future_wait(futures[i], &result);
+    sums_ok = sums_ok && ok && glms_ast_number(result) == i * (i + 1) / 2;
+    glms_pool_future_free(futures[i]);
+  }
+  GLMS_ASSERT(sums_ok);
+
+  GLMSAST result = {0};
+  GLMS_ASSERT(glms_pool_future_wait(greeting, &result));
+  GLMS_ASSERT(strcmp(glms_ast_get_string_value(&result), "hi pool") == 0);
+  glms_pool_future_free(greeting);
+
+  glms_pool_wait(pool);
+  int64_t expected = 0;
+  for (int64_t i = 0; i < GLMS_TEST_POOL_JOBS; i++) expected += i * (i + 1) / 2;
+  GLMS_ASSERT(total == expected);
+
+  glms_pool_free(pool);
+
+  // one worker running many jobs does not grow its env.
+  pool = glms_pool_new(source, "test/samples/pool.gs", 1, (GLMSConfig){0});
+  GLMS_ASSERT(pool != 0);
+
+  TestPoolMemory memory = {0};
+  GLMSAST arg = {.type = GLMS_AST_TYPE_NUMBER, .as.number.value = 20};
+  for (int64_t i = 0; i < 2000; i++) {
+    glms_pool_submit(pool, "sum", test_pool_args(&arg),
+                     test_pool_memory_callback, &memory);
+  }
+  glms_pool_wait(pool);
+
+  GLMS_ASSERT(memory.jobs == 2000);
+  GLMS_ASSERT(memory.last_pages == memory.first_pages);
+
+  glms_pool_free(pool);
+  free(source);
+}
+
+static void test_sample_budget() {
+  GLMS_TEST_BEGIN();
+  GLMSEnv env = {0};
+  char *source = glms_get_file_contents("test/samples/budget.gs");
+  GLMS_ASSERT(source != 0);
+  glms_env_init(&env, source, "test/samples/budget.gs", (GLMSConfig){0});
+
+  int64_t slices = 1;
+  GLMSExecStatus status =
+      glms_env_exec_budget(&env, (GLMSBudget){.nodes = 500});
+
+  while (status == GLMS_EXEC_SUSPENDED) {
+    status = glms_env_resume(&env, (GLMSBudget){.nodes = 500}, 0);
+    slices++;
+  }
+
+  GLMS_ASSERT(status == GLMS_EXEC_DONE);
+  GLMS_ASSERT(slices > 1);
+  GLMS_ASSERT(glms_env_is_suspended(&env) == false);
+
+  GLMSAST *total = glms_eval_lookup(&env.eval, &env.stack, "total");
+  GLMS_ASSERT(total != 0);
+  GLMS_ASSERT(GLMSAST_VALUE(total) == 200);
+
+  GLMSFunctionHandle *handle = glms_env_get_function(&env, "count");
+  GLMS_ASSERT(handle != 0);
+
+  GLMSAST result = {0};
+  GLMSASTBuffer args = (GLMSASTBuffer){
+      .initialized = true,
+      .items = (GLMSAST[]){(GLMSAST){.type = GLMS_AST_TYPE_NUMBER,
+                                     .as.number.value = 300}},
+      .length = 1};
+  status = glms_env_call_function_budget(&env, "count", args,
+                                         (GLMSBudget){.nodes = 500}, &result);
+  GLMS_ASSERT(status == GLMS_EXEC_SUSPENDED);
+
+  // other calls are refused until the suspended one is done.
+  GLMSAST refused = {0};
+  int called = glms_env_call_function(&env, "count", args, &refused);
+  GLMS_ASSERT(called == 0);
+  called = glms_env_call_handle(handle, args, &refused);
+  GLMS_ASSERT(called == 0);
+  called = glms_env_call_batch(&env, handle, &args, 1, &refused);
+  GLMS_ASSERT(called == 0);
+
+  while (status == GLMS_EXEC_SUSPENDED) {
+    status = glms_env_resume(&env, (GLMSBudget){.usec = 1000}, &result);
+  }
+
+  GLMS_ASSERT(status == GLMS_EXEC_DONE);
+  GLMS_ASSERT(glms_ast_number(result) == 300);
+
+  // calls made every frame run on stacks freed by earlier ones.
+  bool counted = true;
+  for (int i = 0; i < 8; i++) {
+    status = glms_env_call_function_budget(
+        &env, "count",
+        (GLMSASTBuffer){.initialized = true,
+                        .items = (GLMSAST[]){(GLMSAST){
+                            .type = GLMS_AST_TYPE_NUMBER,
+                            .as.number.value = (float)i}},
+                        .length = 1},
+        (GLMSBudget){0}, &result);
+    counted = counted && status == GLMS_EXEC_DONE &&
+              glms_ast_number(result) == (float)i;
+  }
+  GLMS_ASSERT(counted == true);
+
+  GLMS_TEST_END();
+  free(source);
+}
+
+static void test_sample_reload() {
+  GLMS_TEST_BEGIN();
+  GLMSEnv env = {0};
+  char *source = glms_get_file_contents("test/samples/reload.gs");
+  GLMS_ASSERT(source != 0);
+  glms_env_init(&env, source, "test/samples/reload.gs", (GLMSConfig){0});
+  glms_env_exec(&env);
+
+  char **chunks = 0;
+  int64_t chunks_length = 0;
+  GLMS_ASSERT(glms_reload_split(source, &chunks, &chunks_length));
+  GLMS_ASSERT(chunks_length == 3);
+  for (int64_t i = 0; i < chunks_length; i++) free(chunks[i]);
+  free(chunks);
+
+  GLMSASTBuffer args = (GLMSASTBuffer){
+      .initialized = true,
+      .items = (GLMSAST[]){(GLMSAST){.type = GLMS_AST_TYPE_NUMBER,
+                                     .as.number.value = 3}},
+      .length = 1};
+
+  GLMSFunctionHandle *score = glms_env_get_function(&env, "score");
+  GLMS_ASSERT(score != 0);
+
+  GLMSAST result = {0};
+  glms_env_call_handle(score, args, &result);
+  GLMS_ASSERT(glms_ast_number(result) == 6);
+
+  char *next = glms_get_file_contents("test/samples/reload_next.gs");
+  GLMS_ASSERT(next != 0);
+  int reloaded = glms_env_reload(&env, next);
+  free(next);
+  GLMS_ASSERT(reloaded);
+
+  // only the function and the new statement ran again.
+  GLMSAST *hits = glms_eval_lookup(&env.eval, &env.stack, "hits");
+  GLMS_ASSERT(hits != 0);
+  GLMS_ASSERT(GLMSAST_VALUE(hits) == 1);
+
+  GLMSAST *bonus = glms_eval_lookup(&env.eval, &env.stack, "bonus");
+  GLMS_ASSERT(bonus != 0);
+  GLMS_ASSERT(GLMSAST_VALUE(bonus) == 11);
+
+  glms_env_call_handle(score, args, &result);
+  GLMS_ASSERT(glms_ast_number(result) == 9);
+
+  glms_env_call_function(&env, "score", args, &result);
+  GLMS_ASSERT(glms_ast_number(result) == 9);
+
+  GLMS_TEST_END();
+  free(source);
+}
+
+static void test_call_batch() {
+  GLMS_TEST_BEGIN();
+  GLMSEnv env = {0};
+  GLMSAST *ast = glms_exec_file(&env, "test/samples/handle.gs");
+  GLMS_ASSERT(ast != 0);
+
+  GLMSFunctionHandle *add = glms_env_get_function(&env, "add");
+  GLMS_ASSERT(add != 0);
+
+  const int64_t n = 1000;
+  GLMSASTBuffer *rows = (GLMSASTBuffer *)calloc(n, sizeof(GLMSASTBuffer));
+  GLMSAST *results = (GLMSAST *)calloc(n, sizeof(GLMSAST));
+
+  for (int64_t i = 0; i < n; i++) {
+    glms_GLMSAST_buffer_init(&rows[i]);
+    glms_GLMSAST_buffer_push(&rows[i], (GLMSAST){.type = GLMS_AST_TYPE_NUMBER, .as.number.value = (float)i});
+    glms_GLMSAST_buffer_push(&rows[i], (GLMSAST){.type = GLMS_AST_TYPE_NUMBER, .as.number.value = 1.0f});
+  }
+
+  GLMS_ASSERT(glms_env_call_batch(&env, add, rows, n, results) == 1);
+
+  bool ok = true;
+  for (int64_t i = 0; i < n; i++) {
+    ok = ok && glms_ast_number(results[i]) == (float)(i + 1);
+    glms_GLMSAST_buffer_clear(&rows[i]);
+  }
+  GLMS_ASSERT(ok == true);
+
+  free(rows);
+  free(results);
+  GLMS_TEST_END();
+}
+
+static void test_call_batch_pure() {
+  GLMS_TEST_BEGIN();
+  GLMSEnv env = {0};
+  GLMSAST *ast = glms_exec_file(&env, "test/samples/handle.gs");
+  GLMS_ASSERT(ast != 0);
+
+  GLMSFunctionHandle *add = glms_env_get_function(&env, "add");
+  GLMSFunctionHandle *label = glms_env_get_function(&env, "label");
+  GLMSFunctionHandle *scaled = glms_env_get_function(&env, "scaled");
+  GLMSFunctionHandle *same = glms_env_get_function(&env, "same");
+  GLMS_ASSERT(add != 0 && label != 0 && scaled != 0 && same != 0);
+  add->pure = true;
+  label->pure = true;
+  scaled->pure = true;
+  same->pure = true;
+
+  const int64_t n = 1000;
+  GLMSASTBuffer *rows = (GLMSASTBuffer *)calloc(n, sizeof(GLMSASTBuffer));
+  GLMSAST *results = (GLMSAST *)calloc(n, sizeof(GLMSAST));
+  GLMSAST *labels = (GLMSAST *)calloc(n, sizeof(GLMSAST));
+
+  for (int64_t i = 0; i < n; i++) {
+    glms_GLMSAST_buffer_init(&rows[i]);
+    glms_GLMSAST_buffer_push(&rows[i], (GLMSAST){.type = GLMS_AST_TYPE_NUMBER, .as.number.value = (float)i});
+    glms_GLMSAST_buffer_push(&rows[i], (GLMSAST){.type = GLMS_AST_TYPE_NUMBER, .as.number.value = 1.0f});
+  }
+
+  // rows are split across threads.
+  GLMS_ASSERT(glms_env_call_batch(&env, add, rows, n, results) == 1);
+  GLMS_ASSERT(glms_env_call_batch(&env, label, rows, n, labels) == 1);
+
+  bool ok = true;
+  for (int64_t i = 0; i < n; i++) {
+    ok = ok && glms_ast_number(results[i]) == (float)(i + 1);
+    const char *str = glms_ast_get_string_value(&labels[i]);
+    ok = ok && str != 0 && strcmp(str, "entity") == 0;
+  }
+  GLMS_ASSERT(ok == true);
+
+  // workers share the env's access sites, which stay frozen until the
+  // rows are done.
+  GLMS_ASSERT(glms_env_call_batch(&env, scaled, rows, n, results) == 1);
+  GLMS_ASSERT(env.frozen == false);
+
+  for (int64_t i = 0; i < n; i++) {
+    ok = ok && glms_ast_number(results[i]) == (float)(i * 3);
+  }
+  GLMS_ASSERT(ok == true);
+
+  // each worker rebinds its parameters per row, results returning one
+  // keep the row's value.
+  GLMS_ASSERT(glms_env_call_batch(&env, same, rows, n, results) == 1);
+
+  for (int64_t i = 0; i < n; i++) {
+    ok = ok && glms_ast_number(results[i]) == (float)i;
+    glms_GLMSAST_buffer_clear(&rows[i]);
+  }
+  GLMS_ASSERT(ok == true);
+
+  free(rows);
+  free(results);
+  free(labels);
+  GLMS_TEST_END();
+}
+
 static void test_sample_if() {
   GLMS_TEST_BEGIN();
   GLMSEnv env = {0};
@@ -340,6 +2055,37 @@ int main(int argc, char *argv[]) {
   test_sample_func();
   test_sample_arrow_func();
   test_sample_array();
+  test_sample_array_copy();
+  test_sample_shape();
+  test_shape_dictionary();
+  test_sample_type_methods();
+  test_sample_import();
+  test_sample_module_state();
+  test_module_acquire_threads();
+  test_sample_prefetch();
+  test_sample_async();
+  test_async_release();
+  test_sample_handle();
+  test_call_batch();
+  test_sample_layout();
+  test_sample_typed_array();
+  test_sample_native();
+  // before anything snapshots, which registers every lazy module.
+  test_builtin_lazy_modules();
+  test_sample_snapshot();
+  test_builtin_prototype();
+  test_shared_threads();
+  test_pool();
+  test_call_batch_pure();
+  test_sample_shade();
+  test_sample_parallel();
+  test_sample_parallel_for();
+  test_sample_fetch_all();
+  test_sample_channel();
+  test_channel_pipeline();
+  test_batch_run();
+  test_sample_budget();
+  test_sample_reload();
   test_sample_if();
   test_sample_object();
   test_sample_varfunc();